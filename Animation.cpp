@@ -0,0 +1,97 @@
+#include "Animation.h"
+
+#include <algorithm>
+
+void Animator::add(Kind kind, bool wave, uint8_t rows, int value, long duration) {
+    // When full, the oldest effect makes room.
+    if (count == MAX_EFFECTS) {
+        std::copy(effects + 1, effects + count, effects);
+        --count;
+    }
+    effects[count++] = Effect{kind, wave, rows, value, duration, -1};
+}
+
+void Animator::lineClear(int top, uint8_t rows) {
+    if (rows != 0) add(Kind::LineClear, false, rows, top, LINE_FLASH_US);
+}
+
+void Animator::levelUp(int level) {
+    add(Kind::LevelUp, false, 0, level, LEVEL_BANNER_US);
+}
+
+void Animator::gameOver(bool wave) {
+    long duration = GAME_OVER_HOLD_US;
+    if (wave) duration += GAME_OVER_WAVE_US + GAME_OVER_AFTER_US;
+    add(Kind::GameOver, wave, 0, 0, duration);
+}
+
+bool Animator::isEnding(long long now) const {
+    for (int i = 0; i < count; ++i) {
+        const Effect& effect = effects[i];
+        if (effect.kind == Kind::GameOver &&
+            (effect.start < 0 || now - effect.start < effect.duration)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Animator::apply(Board& board, std::vector<std::string>& panelLines,
+                     long long now) {
+    int kept = 0;
+    for (int i = 0; i < count; ++i) {
+        Effect& effect = effects[i];
+        if (effect.start < 0) effect.start = now;
+        long long elapsed = now - effect.start;
+        if (elapsed >= effect.duration) continue;
+
+        switch (effect.kind) {
+        case Kind::LineClear: {
+            // Full rows of '#' and empty rows in turn.
+            char cell = (elapsed / LINE_BLINK_US) % 2 == 0 ? '#' : ' ';
+            for (int row = 0; row < 8; ++row) {
+                int y = effect.value + row;
+                if (!((effect.rows >> row) & 1) || y < 0 || y >= BOARD_HEIGHT) continue;
+                std::fill(board.grid[y], board.grid[y] + BOARD_WIDTH, cell);
+            }
+            break;
+        }
+        case Kind::LevelUp: {
+            // The first two panel rows, ahead of the lines already there
+            // (a HUD can fill the panel), which move down intact. Text and
+            // blanks in turn, so the panel keeps its height.
+            size_t before = panelLines.size();
+            panelLines.resize(before + 2);
+            std::rotate(panelLines.begin(), panelLines.begin() + before, panelLines.end());
+            bool on = (elapsed / BANNER_BLINK_US) % 2 == 0;
+            panelLines[0] = on ? " LEVEL UP!" : "";
+            panelLines[1].clear();
+            if (on) appendInt(panelLines[1].append("  LEVEL "), effect.value);
+            break;
+        }
+        case Kind::GameOver: {
+            long long wave = elapsed - GAME_OVER_HOLD_US;
+            if (!effect.wave || wave <= 0) break;
+
+            // Cells in the order the wave reaches them: bottom row first,
+            // left to right.
+            long long cells = BOARD_WIDTH * BOARD_HEIGHT;
+            long long reached = std::min(cells, wave * cells / GAME_OVER_WAVE_US);
+            for (long long i = 0; i < reached; ++i) {
+                char& cell = board.grid[BOARD_HEIGHT - 1 - i / BOARD_WIDTH][i % BOARD_WIDTH];
+                if (cell != ' ') cell = '#';
+            }
+            break;
+        }
+        }
+        effects[kept++] = effect;
+    }
+    count = kept;
+}
+
+void renderFrame(Board& board, GameState& state, Animator& animator,
+                 const std::string preview[4], long long now,
+                 std::string& out) {
+    animator.apply(board, state.panelLines, now);
+    board.render(state, preview, out);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+
+// Animation timelines (microseconds).
+constexpr long LINE_FLASH_US      = 240000;   // Cleared rows blink...
+constexpr long LINE_BLINK_US      = 80000;    // ...on and off this often.
+constexpr long LEVEL_BANNER_US    = 2000000;  // "LEVEL UP" atop the panel.
+constexpr long BANNER_BLINK_US    = 250000;
+constexpr long GAME_OVER_HOLD_US  = 800000;   // Last frame as it ended.
+constexpr long GAME_OVER_WAVE_US  = 1000000;  // Cells turn white bottom-up.
+constexpr long GAME_OVER_AFTER_US = 500000;   // Finished wave on screen.
+constexpr long ANIM_FRAME_US      = 33333;    // Frame interval of the ending.
+
+// Timed effects drawn over the game frame: the line-clear flash, the
+// level-up banner and the game-over wave.
+//
+// Events only queue an effect; it starts on the first frame that draws it
+// and apply() draws every effect at the point of its timeline that frame
+// falls on. An effect therefore costs one overlay per frame drawn however
+// long it runs, frames dropped by a slow terminal shorten nothing, and
+// the game loop never waits for an animation.
+class Animator {
+public:
+    static constexpr int MAX_EFFECTS = 8;
+
+    // Flash the rows a lock removed (LockResult::clearedTop/clearedRows),
+    // where they were before the rows above collapsed onto them.
+    void lineClear(int top, uint8_t rows);
+
+    void levelUp(int level);
+
+    // The closing sequence: hold the last frame, then with `wave` turn
+    // the locked cells white row by row from the bottom.
+    void gameOver(bool wave);
+
+    void clear() { count = 0; }
+
+    // Draw the effects at `nowUs` into the display board and the panel
+    // lines, and retire the ones that have ended.
+    void apply(Board& board, std::vector<std::string>& panelLines, long long nowUs);
+
+    // The game-over sequence has not reached its end at `nowUs`.
+    bool isEnding(long long nowUs) const;
+
+private:
+    enum class Kind : uint8_t { LineClear, LevelUp, GameOver };
+
+    struct Effect {
+        Kind      kind;
+        bool      wave;               // GameOver: with the wave.
+        uint8_t   rows;               // LineClear: bit i = row top + i.
+        int       value;              // LineClear: top row; LevelUp: level.
+        long      duration;
+        long long start;              // -1 until first drawn.
+    };
+
+    Effect effects[MAX_EFFECTS];
+    int    count{0};
+
+    void add(Kind kind, bool wave, uint8_t rows, int value, long duration);
+};
+
+// The frame TetrisGame::presentFrame() sends, from a composed display
+// board and the panel lines set so far: the effects at `nowUs` drawn over
+// them, then Board::render() into `out`. Recordings and bench use it too.
+void renderFrame(Board& board, GameState& state, Animator& animator,
+                 const std::string preview[4], long long nowUs,
+                 std::string& out);
@@ -0,0 +1,136 @@
+#include "Asciicast.h"
+
+#include <cstdio>
+
+#include "Animation.h"
+#include "GameState.h"
+
+bool CastWriter::open(const std::string& path, int width, int height,
+                      const std::string& title) {
+    file.open(path);
+    if (!file.is_open()) return false;
+
+    line = "{\"version\": 2, \"width\": ";
+    appendInt(line, width);
+    line += ", \"height\": ";
+    appendInt(line, height);
+    line += ", \"title\": ";
+    appendJson(title);
+    line += ", \"env\": {\"TERM\": \"xterm-256color\"}}\n";
+    file << line;
+    bytes = line.size();
+    return true;
+}
+
+void CastWriter::appendJson(const std::string& text) {
+    static const char HEX[] = "0123456789abcdef";
+    line += '"';
+    for (char c : text) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            line += '\\';
+            line += c;
+        } else if (c == '\n') {
+            line += "\\n";
+        } else if (byte < 0x20) {
+            // ESC and the other control characters; UTF-8 passes as is.
+            line += "\\u00";
+            line += HEX[byte >> 4];
+            line += HEX[byte & 15];
+        } else {
+            line += c;
+        }
+    }
+    line += '"';
+}
+
+void CastWriter::output(double seconds, const std::string& text) {
+    if (text.empty()) return;
+
+    char time[32];
+    std::snprintf(time, sizeof(time), "[%.6f, \"o\", ", seconds);
+    line = time;
+    appendJson(text);
+    line += "]\n";
+    file << line;
+    bytes += line.size();
+}
+
+bool CastWriter::close() {
+    file.close();
+    return !file.fail();
+}
+
+bool exportCast(const Replay& replay, const std::string& path,
+                const std::string& title, CastSummary& summary) {
+    CastWriter cast;
+    if (!cast.open(path, CAST_WIDTH, CAST_HEIGHT, title)) return false;
+
+    GameCore    core;
+    Board       board;
+    GameState   state;
+    Animator    animator;
+    std::string preview[4];
+    int         previewType = -1;
+    std::string frame;
+    std::string out;
+    uint64_t    lineHash[FRAME_LINES]{};
+    long long   now = 0;              // Microseconds since the first frame.
+
+    summary = CastSummary();
+
+    // One frame as presentFrame() draws it, sent as the changed lines. The
+    // board is composed first, like composeFrame() or the ending does.
+    auto draw = [&]() {
+        state.score        = core.getScore();
+        state.level        = core.getLevel();
+        state.linesCleared = core.getLinesCleared();
+        state.panelLines.clear();
+        if (previewType != core.getNextPieceType()) {
+            previewType = core.getNextPieceType();
+            renderPiecePreview(previewType, preview);
+        }
+        renderFrame(board, state, animator, preview, now, frame);
+        appendChangedLines(frame, lineHash, false, out);
+        cast.output(now / 1e6, out);
+        out.clear();
+        ++summary.frames;
+    };
+
+    // The start screen leaves the terminal cleared.
+    out = "\033[2J";
+
+    ReplayPlayer player(replay);
+    player.start(core);
+    LockResult lock;
+    while (player.nextFrame(core, &lock)) {
+        if (lock.locked) {
+            animator.lineClear(lock.clearedTop, lock.clearedRows);
+            if (lock.leveledUp) animator.levelUp(core.getLevel());
+        }
+        composeBoard(core, board, true);
+        draw();
+
+        // The game loop sleeps a tick of the current level after drawing.
+        now += GameCore::computeDropSpeedUs(core.getLevel()) / DROP_INTERVAL_TICKS;
+    }
+
+    if (core.isGameOver()) {
+        animator.gameOver(true);
+        while (animator.isEnding(now)) {
+            composeEndingBoard(core, board);
+            draw();
+            now += ANIM_FRAME_US;
+        }
+    }
+
+    // Leave the viewer's cursor under the frame.
+    out = "\033[0m\033[";
+    appendInt(out, CAST_HEIGHT);
+    out += ";1H";
+    cast.output(now / 1e6, out);
+
+    summary.seconds = now / 1e6;
+    summary.bytes   = cast.bytesWritten();
+    return cast.close();
+}
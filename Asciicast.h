@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+#include "FramePacer.h"
+#include "Replay.h"
+
+// Terminal size of an exported game: the frame and a line for the cursor.
+constexpr int CAST_WIDTH  = 108;
+constexpr int CAST_HEIGHT = FRAME_LINES + 1;
+
+// Writes an asciinema v2 recording (.cast): a JSON header line, then one
+// [seconds, "o", text] line per chunk of terminal output.
+class CastWriter {
+public:
+    // False if the file cannot be created.
+    bool open(const std::string& path, int width, int height,
+              const std::string& title);
+
+    // Output printed `seconds` after the start; nothing is written for
+    // empty text.
+    void output(double seconds, const std::string& text);
+
+    // False if any write failed.
+    bool close();
+
+    size_t bytesWritten() const { return bytes; }
+
+private:
+    std::ofstream file;
+    std::string   line;               // Event being encoded, reused.
+    size_t        bytes{0};
+
+    void appendJson(const std::string& text);
+};
+
+// What an export produced.
+struct CastSummary {
+    long   frames{0};                 // Game frames drawn.
+    double seconds{0.0};              // Length of the recording.
+    size_t bytes{0};
+};
+
+// Play `replay` back on a headless core and write it as a recording, with
+// the times the game loop would have drawn each frame at (gravity speed
+// of the level, the game-over sequence at its frame rate). Frames are the
+// game's own Board::render output sent as changed lines, as FramePacer
+// sends them, with the line-clear, level-up and game-over effects. Nothing
+// sleeps: a long game exports in well under a second. False if the file
+// cannot be written.
+bool exportCast(const Replay& replay, const std::string& path,
+                const std::string& title, CastSummary& summary);
@@ -0,0 +1,131 @@
+#include "AutoPlayer.h"
+
+#include <algorithm>
+
+template <int W, int H>
+BasicAutoPlayer<W, H>::BasicAutoPlayer(const HeuristicWeights& weights)
+    : weights(weights) {
+    candidates.reserve(4 * W);
+}
+
+template <int W, int H>
+void BasicAutoPlayer<W, H>::enumeratePlacements(const BoardType& board, int type,
+                                                int startY,
+                                                std::vector<Placement>& out) {
+    out.clear();
+
+    for (int rot = 0; rot < 4; ++rot) {
+        const PieceShape& s = pieceShape(type, rot);
+
+        for (int x = -s.minCol; x + s.maxCol < W; ++x) {
+            // Columns the piece cannot even enter at its current height.
+            if (board.collides(type, rot, x, startY)) continue;
+
+            Placement p;
+            p.rotation = rot;
+            p.x        = x;
+            p.y        = board.dropY(type, rot, x, startY);
+            out.push_back(p);
+        }
+    }
+}
+
+template <int W, int H>
+Placement BasicAutoPlayer<W, H>::choosePlacement(const Core& core) {
+    const Piece& piece = core.getCurrentPiece();
+    BoardType    board = BoardType::fromBoard(core.getBoard());
+
+    generateMoves(core);
+
+    Placement best;
+    best.rotation = piece.rotation;
+    best.x        = piece.pos.x;
+    best.y        = piece.pos.y;
+    bool found    = false;
+
+    // Tucks and spins can add more placements than one batch holds.
+    double scores[BATCH_CAPACITY];
+    for (size_t first = 0; first < candidates.size(); first += BATCH_CAPACITY) {
+        size_t last = std::min(candidates.size(), first + BATCH_CAPACITY);
+
+        batch.clear();
+        for (size_t i = first; i < last; ++i) {
+            Placement& p = candidates[i];
+            BoardType after = board;
+            p.lines = after.place(piece.type, p.rotation, p.x, p.y);
+            batch.add(after, p.lines);
+        }
+        batch.evaluate(weights, scores);
+
+        for (size_t i = first; i < last; ++i) {
+            Placement& p = candidates[i];
+            p.score = scores[i - first];
+
+            // Locking above the top edge ends the game.
+            if (p.y < 0) p.score -= 1e9;
+
+            if (!found || p.score > best.score) {
+                best  = p;
+                found = true;
+            }
+        }
+    }
+    return best;
+}
+
+template <int W, int H>
+void BasicAutoPlayer<W, H>::generateMoves(const Core& core) {
+    const Piece& piece = core.getCurrentPiece();
+    if (searchedBoard == core.getBoard().hash &&
+        searchedPiece.type == piece.type &&
+        searchedPiece.rotation == piece.rotation &&
+        searchedPiece.pos.x == piece.pos.x &&
+        searchedPiece.pos.y == piece.pos.y && !candidates.empty()) {
+        return;
+    }
+
+    generator.generate(BoardType::fromBoard(core.getBoard()), piece, candidates);
+    searchedBoard = core.getBoard().hash;
+    searchedPiece = piece;
+}
+
+template <int W, int H>
+bool BasicAutoPlayer<W, H>::planPath(const Core& core) {
+    generateMoves(core);
+
+    int index = generator.find(target.rotation, target.x, target.y);
+    if (index < 0) return false;
+
+    generator.path(index, plan, planStates);
+    planStep = 0;
+    return true;
+}
+
+template <int W, int H>
+GameAction BasicAutoPlayer<W, H>::nextAction(const Core& core) {
+    const Piece& piece = core.getCurrentPiece();
+
+    if (plannedPiece != core.getPiecesPlaced()) {
+        // A new piece spawned: choose its placement once.
+        target       = choosePlacement(core);
+        plannedPiece = core.getPiecesPlaced();
+        plan.clear();
+        planStep = 0;
+    }
+
+    // Gravity may have moved the piece since the last input; find a new
+    // path from where it is now, or a new target if that one is gone.
+    bool onPlan = planStep < plan.size() &&
+                  planStates[planStep].rotation == piece.rotation &&
+                  planStates[planStep].pos.x == piece.pos.x &&
+                  planStates[planStep].pos.y == piece.pos.y;
+    if (!onPlan && !planPath(core)) {
+        target = choosePlacement(core);
+        if (!planPath(core)) return GameAction::HardDrop;
+    }
+    return plan[planStep++];
+}
+
+template class BasicAutoPlayer<10, 20>;
+template class BasicAutoPlayer<10, 40>;
+template class BasicAutoPlayer<15, 20>;
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+
+#include "BatchEvaluator.h"
+#include "BitBoard.h"
+#include "Heuristic.h"
+#include "MoveGenerator.h"
+#include "Policy.h"
+
+// Greedy bot: for every spawn it finds each lock position the active
+// piece can reach (MoveGenerator), scores the resulting boards and then
+// plays the shortest input sequence there, one input per step. Sized like
+// BasicGameCore; AutoPlayer plays the game's board.
+template <int W, int H>
+class BasicAutoPlayer : public BasicPolicy<W, H> {
+public:
+    using Core      = BasicGameCore<W, H>;
+    using BoardType = BasicBitBoard<W, H>;
+
+    explicit BasicAutoPlayer(const HeuristicWeights& weights = HeuristicWeights());
+
+    GameAction nextAction(const Core& core) override;
+
+    // Every distinct straight drop of `type` starting from row startY.
+    // Cheaper than MoveGenerator; used for pieces that have not spawned.
+    static void enumeratePlacements(const BoardType& board, int type,
+                                    int startY,
+                                    std::vector<Placement>& out);
+
+    // Best placement for the active piece of core.
+    virtual Placement choosePlacement(const Core& core);
+
+    const HeuristicWeights& getWeights() const { return weights; }
+
+protected:
+    HeuristicWeights         weights;
+
+private:
+    std::vector<Placement>   candidates;   // Reused between spawns.
+    BasicBoardBatch<W, H>    batch;        // Boards after each candidate.
+    BasicMoveGenerator<W, H> generator;
+    uint64_t                 searchedBoard{0}; // Input of the last generate().
+    Piece                    searchedPiece;
+
+    long      plannedPiece{-1};            // Piece index the plan belongs to.
+    Placement target;
+
+    // Inputs towards target and the piece expected before each of them.
+    std::vector<GameAction> plan;
+    std::vector<Piece>      planStates;
+    size_t                  planStep{0};
+
+    // Run the move generator from the current piece unless its last
+    // search already started there.
+    void generateMoves(const Core& core);
+
+    // Find the inputs from the current piece to target; false if unreachable.
+    bool planPath(const Core& core);
+};
+
+using AutoPlayer = BasicAutoPlayer<BOARD_WIDTH, BOARD_HEIGHT>;
+
+// Compiled once in AutoPlayer.cpp, for the BasicBitBoard sizes.
+extern template class BasicAutoPlayer<10, 20>;
+extern template class BasicAutoPlayer<10, 40>;
+extern template class BasicAutoPlayer<15, 20>;
@@ -0,0 +1,138 @@
+#include "BatchEvaluator.h"
+
+#include <cstring>
+
+// -DBATCH_SCALAR forces the portable path, e.g. to compare the two.
+#if defined(__GNUC__) && !defined(BATCH_SCALAR)
+#define BATCH_VECTOR_KERNEL 1
+#endif
+
+namespace {
+
+#ifdef BATCH_VECTOR_KERNEL
+
+// BATCH_LANES 16-bit lanes; GCC/Clang lower these to SSE2, AVX or NEON.
+typedef uint16_t Bits  __attribute__((vector_size(2 * BATCH_LANES)));
+typedef int16_t  Count __attribute__((vector_size(2 * BATCH_LANES)));
+
+// Set bits per lane (SWAR, no popcount instruction needed).
+inline Bits popcount16(Bits x) {
+    x = x - ((x >> 1) & 0x5555);
+    x = (x & 0x3333) + ((x >> 2) & 0x3333);
+    x = (x + (x >> 4)) & 0x0F0F;
+    return (x + (x >> 8)) & 0x001F;
+}
+
+// Features of boards [base, base + BATCH_LANES) of a W x H batch.
+template <int W, int H>
+void kernel(const uint16_t (*rows)[BATCH_CAPACITY], int base,
+            Count& aggregate, Count& holes, Count& bumpiness,
+            Count& wells, Count& transitions, Count& maxHeight) {
+    const Bits innerPairs = Bits{} + static_cast<uint16_t>((1u << (W - 1)) - 1);
+
+    Bits  covered = {};
+    Count heights[W] = {};
+    holes       = Count{};
+    transitions = Count{};
+
+    for (int y = 0; y < H; ++y) {
+        Bits row;
+        std::memcpy(&row, &rows[y][base], sizeof(row));
+        covered |= row;
+
+        holes += (Count)popcount16(covered & ~row);
+
+        // Changes between neighbours plus empty edge cells (walls filled).
+        Bits empty = ~row;
+        transitions += (Count)(popcount16((row ^ (row >> 1)) & innerPairs) +
+                               (empty & 1) +
+                               ((empty >> (W - 1)) & 1));
+
+        // A column's height is the number of rows at or below its top.
+        for (int x = 0; x < W; ++x) {
+            heights[x] += (Count)((covered >> x) & 1);
+        }
+    }
+
+    aggregate = Count{};
+    bumpiness = Count{};
+    wells     = Count{};
+    maxHeight = Count{};
+    const Count wall = Count{} + static_cast<int16_t>(H);
+
+    for (int x = 0; x < W; ++x) {
+        Count h = heights[x];
+        aggregate += h;
+        maxHeight  = h > maxHeight ? h : maxHeight;
+
+        if (x + 1 < W) {
+            Count d    = h - heights[x + 1];
+            Count sign = d >> 15;
+            bumpiness += (d ^ sign) - sign;
+        }
+
+        Count left  = x > 0               ? heights[x - 1] : wall;
+        Count right = x + 1 < W ? heights[x + 1] : wall;
+        Count depth = (left < right ? left : right) - h;
+        wells += depth > 0 ? depth : Count{};
+    }
+}
+
+#endif
+
+} // namespace
+
+template <int W, int H>
+int BasicBoardBatch<W, H>::add(const BasicBitBoard<W, H>& board, int cleared) {
+    int lane = count++;
+    for (int y = 0; y < H; ++y) {
+        rows[y][lane] = board.rows[y];
+    }
+    lines[lane] = cleared;
+    return lane;
+}
+
+template <int W, int H>
+void BasicBoardBatch<W, H>::computeFeatures(BoardFeatures* out) const {
+#ifdef BATCH_VECTOR_KERNEL
+    for (int base = 0; base < count; base += BATCH_LANES) {
+        // Lanes past count hold stale rows; their results are dropped.
+        Count aggregate, holes, bumpiness, wells, transitions, maxHeight;
+        kernel<W, H>(rows, base, aggregate, holes, bumpiness, wells,
+                     transitions, maxHeight);
+
+        int lanes = count - base < BATCH_LANES ? count - base : BATCH_LANES;
+        for (int i = 0; i < lanes; ++i) {
+            BoardFeatures& f  = out[base + i];
+            f.aggregateHeight = aggregate[i];
+            f.completeLines   = lines[base + i];
+            f.holes           = holes[i];
+            f.bumpiness       = bumpiness[i];
+            f.wellDepth       = wells[i];
+            f.rowTransitions  = transitions[i];
+            f.maxHeight       = maxHeight[i];
+        }
+    }
+#else
+    // Portable fallback: one board at a time.
+    for (int i = 0; i < count; ++i) {
+        BasicBitBoard<W, H> board;
+        for (int y = 0; y < H; ++y) board.rows[y] = rows[y][i];
+        out[i] = ::computeFeatures(board, lines[i]);
+    }
+#endif
+}
+
+template <int W, int H>
+void BasicBoardBatch<W, H>::evaluate(const HeuristicWeights& weights,
+                          double* scores) const {
+    BoardFeatures features[BATCH_CAPACITY];
+    computeFeatures(features);
+    for (int i = 0; i < count; ++i) {
+        scores[i] = evaluateFeatures(features[i], weights);
+    }
+}
+
+template class BasicBoardBatch<10, 20>;
+template class BasicBoardBatch<10, 40>;
+template class BasicBoardBatch<15, 20>;
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "BitBoard.h"
+#include "Heuristic.h"
+
+// Boards scored together; one piece's placements always fit in a batch.
+constexpr int BATCH_CAPACITY = 64;
+
+// Boards processed side by side by the feature kernel.
+constexpr int BATCH_LANES = 8;
+
+static_assert(BATCH_CAPACITY % BATCH_LANES == 0,
+              "batch capacity must be a whole number of lane groups");
+
+// A batch of candidate boards stored as structure-of-arrays row masks:
+// rows[y][lane] holds row y of every board next to each other, so the
+// feature kernel loads one row of BATCH_LANES boards with a single vector
+// load and every lane runs the same branch-free arithmetic. Results are
+// identical to computeFeatures() on each board.
+template <int W, int H>
+class BasicBoardBatch {
+public:
+    static_assert(4 * W <= BATCH_CAPACITY,
+                  "every placement of one piece must fit in a batch");
+    static_assert(W <= 16, "the kernel holds a row in a 16-bit lane");
+
+    int  size() const  { return count; }
+    bool full() const  { return count == BATCH_CAPACITY; }
+    void clear()       { count = 0; }
+
+    // Append a board that cleared `lines` rows; returns its lane index.
+    int add(const BasicBitBoard<W, H>& board, int lines);
+
+    // Features of every board in the batch, out[0..size()).
+    void computeFeatures(BoardFeatures* out) const;
+
+    // Weighted score of every board, same as evaluateFeatures().
+    void evaluate(const HeuristicWeights& weights, double* scores) const;
+
+private:
+    alignas(16) uint16_t rows[H][BATCH_CAPACITY]{};
+    int lines[BATCH_CAPACITY];
+    int count{0};
+};
+
+using BoardBatch = BasicBoardBatch<BOARD_WIDTH, BOARD_HEIGHT>;
+
+// Compiled once in BatchEvaluator.cpp, for the BasicBitBoard sizes.
+extern template class BasicBoardBatch<10, 20>;
+extern template class BasicBoardBatch<10, 40>;
+extern template class BasicBoardBatch<15, 20>;
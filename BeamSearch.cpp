@@ -0,0 +1,371 @@
+#include "BeamSearch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace {
+
+long long nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Score added to boards that lock a piece above the top edge.
+const double TOP_OUT_PENALTY = -1e9;
+
+// Cached last-ply value of a board the last piece cannot be placed on.
+const float NO_PLACEMENT = -4e9f;
+
+// Depth of a last-ply entry. Root entries are keyed with the active piece,
+// so the two kinds never share a key.
+const int LEAF_DEPTH = 1;
+
+} // namespace
+
+template <int W, int H>
+BasicBeamSearch<W, H>::BasicBeamSearch(const HeuristicWeights& weights,
+                                       const SearchConfig& config)
+    : weights(weights), config(config) {
+    int workers = std::max(1, config.threads);
+    if (workers > 1) {
+        pool.reset(new ThreadPool(workers));
+    }
+    scratch.resize(workers);
+
+    if (config.ttBits > 0) {
+        table = std::make_shared<TranspositionTable>(config.ttBits);
+    }
+}
+
+template <int W, int H>
+bool BasicBeamSearch<W, H>::outOfTime() const {
+    return config.timeBudgetUs > 0 && nowNs() > deadlineNs;
+}
+
+template <int W, int H>
+long BasicBeamSearch<W, H>::leafProbes() const {
+    long total = 0;
+    for (const Scratch& local : scratch) total += local.leafProbes;
+    return total;
+}
+
+template <int W, int H>
+long BasicBeamSearch<W, H>::leafHits() const {
+    long total = 0;
+    for (const Scratch& local : scratch) total += local.leafHits;
+    return total;
+}
+
+template <int W, int H>
+void BasicBeamSearch<W, H>::selectBeam(Scratch& local) const {
+    std::vector<Node>& next = local.next;
+    auto better = [](const Node& a, const Node& b) { return a.score > b.score; };
+
+    // Different placements often build the same board (symmetric pieces,
+    // different move orders); keep one copy of each so the beam stays
+    // diverse. Only a few times the beam width need to be ordered.
+    size_t pool = std::min(next.size(),
+                           static_cast<size_t>(config.beamWidth) * 4);
+    std::partial_sort(next.begin(), next.begin() + pool, next.end(), better);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < pool && kept < static_cast<size_t>(config.beamWidth); ++i) {
+        bool seen = false;
+        for (size_t j = 0; j < kept; ++j) {
+            if (next[j].board.hash == next[i].board.hash) {
+                seen = true;
+                break;
+            }
+        }
+        if (!seen) next[kept++] = next[i];
+    }
+    next.resize(kept);
+}
+
+template <int W, int H>
+bool BasicBeamSearch<W, H>::searchBranch(const Node& root, const int* pieces,
+                                         int plies, Scratch& local,
+                                         double& value) const {
+    local.beam.clear();
+    local.beam.push_back(root);
+
+    for (int ply = 0; ply < plies; ++ply) {
+        if (outOfTime()) return false;
+
+        bool   lastPly = (ply == plies - 1);
+        double best    = TOP_OUT_PENALTY * 2.0;
+        local.next.clear();
+
+        for (const Node& node : local.beam) {
+            // The best placement of the last piece depends only on the
+            // board and the piece, so a transposed board (reached from
+            // another root, or by same-type pieces in another order) can
+            // reuse it. The value is rounded to the table's float on both
+            // paths, so a hit picks the same move as a fresh search.
+            uint64_t leafKey = 0;
+            bool     cached  = lastPly && table && config.cacheLeaves;
+            if (cached) {
+                leafKey = node.board.hash ^ Zobrist::nextPiece(pieces[ply]);
+                ++local.leafProbes;
+
+                TTEntry entry;
+                if (table->probe(leafKey, entry) && entry.depth == LEAF_DEPTH) {
+                    ++local.leafHits;
+                    if (entry.score > NO_PLACEMENT) {
+                        best = std::max(best, node.bonus + entry.score);
+                    }
+                    continue;
+                }
+            }
+
+            BasicAutoPlayer<W, H>::enumeratePlacements(node.board, pieces[ply],
+                                                       SPAWN_Y, local.placements);
+
+            // Build every child first, then score them as one batch.
+            size_t first = local.next.size();
+            local.batch.clear();
+            for (const Placement& p : local.placements) {
+                BoardType after = node.board;
+                int lines = after.place(pieces[ply], p.rotation, p.x, p.y);
+                local.batch.add(after, lines);
+
+                // Leaves only need the best score, not a new beam.
+                if (!lastPly) {
+                    Node child;
+                    child.board = after;
+                    child.bonus = node.bonus + weights.completeLines * lines;
+                    if (p.y < 0) child.bonus += TOP_OUT_PENALTY;
+                    local.next.push_back(child);
+                }
+            }
+            local.batch.evaluate(weights, local.scores);
+
+            double leafBest = NO_PLACEMENT;
+            for (size_t i = 0; i < local.placements.size(); ++i) {
+                double score = local.scores[i];
+                if (local.placements[i].y < 0) score += TOP_OUT_PENALTY;
+
+                if (lastPly) {
+                    leafBest = std::max(leafBest, score);
+                } else {
+                    local.next[first + i].score = node.bonus + score;
+                }
+            }
+
+            if (lastPly && cached) {
+                TTEntry entry;
+                entry.score = static_cast<float>(leafBest);
+                entry.depth = LEAF_DEPTH;
+                table->store(leafKey, entry);
+                leafBest = entry.score;
+            }
+            if (lastPly && !local.placements.empty()) {
+                best = std::max(best, node.bonus + leafBest);
+            }
+        }
+
+        if (lastPly) {
+            value = best;
+            return true;
+        }
+        if (local.next.empty()) {
+            // No piece fits anywhere: this line of play tops out.
+            value = TOP_OUT_PENALTY * 2.0;
+            return true;
+        }
+
+        selectBeam(local);
+        local.beam.swap(local.next);
+    }
+    return true;
+}
+
+template <int W, int H>
+bool BasicBeamSearch<W, H>::search(const BoardType& board, const int* pieces,
+                                   int pieceCount, const Piece& start,
+                                   Placement& out) {
+    deadlineNs = nowNs() + config.timeBudgetUs * 1000LL;
+    completedRoots = 0;
+
+    std::vector<Placement> roots;
+    rootMoves.generate(board, start, roots);
+    if (roots.empty()) return false;
+
+    // Root children, scored greedily a batch at a time.
+    size_t count = roots.size();
+    std::vector<Node> rootNodes(count);
+    BasicBoardBatch<W, H>& batch  = scratch[0].batch;
+    double*                scores = scratch[0].scores;
+    for (size_t first = 0; first < count; first += BATCH_CAPACITY) {
+        size_t last = std::min(count, first + BATCH_CAPACITY);
+
+        batch.clear();
+        for (size_t i = first; i < last; ++i) {
+            Placement& p = roots[i];
+            Node&      n = rootNodes[i];
+            n.board = board;
+            p.lines = n.board.place(pieces[0], p.rotation, p.x, p.y);
+            n.bonus = weights.completeLines * p.lines;
+            batch.add(n.board, p.lines);
+        }
+        batch.evaluate(weights, scores);
+
+        for (size_t i = first; i < last; ++i) {
+            Placement& p = roots[i];
+            Node&      n = rootNodes[i];
+            n.score = scores[i - first];
+            if (p.y < 0) {
+                n.bonus += TOP_OUT_PENALTY;
+                n.score += TOP_OUT_PENALTY;
+            }
+            p.score = n.score;
+        }
+    }
+
+    // Most promising roots first, so a timeout keeps the good ones.
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&rootNodes](size_t a, size_t b) {
+                         return rootNodes[a].score > rootNodes[b].score;
+                     });
+
+    int plies = std::max(1, std::min(config.depth, pieceCount)) - 1;
+
+    // The same position searched to at least this depth before: reuse it.
+    uint64_t rootKey = board.hash ^
+                       Zobrist::activePiece(start.type, start.rotation,
+                                            start.pos.x, start.pos.y);
+    for (int i = 1; i <= plies; ++i) {
+        // Rotate per ply so the same pieces in another order differ.
+        uint64_t key = Zobrist::nextPiece(pieces[i]);
+        rootKey ^= (key << i) | (key >> (64 - i));
+    }
+    TTEntry cached;
+    if (table && table->probe(rootKey, cached) && cached.depth >= plies + 1) {
+        for (size_t i = 0; i < count; ++i) {
+            if (roots[i].rotation == cached.rotation &&
+                roots[i].x == cached.x && roots[i].y == cached.y) {
+                out       = roots[i];
+                out.score = cached.score;
+                completedRoots = static_cast<int>(count);
+                return true;
+            }
+        }
+    }
+
+    std::vector<double> values(count, 0.0);
+    std::vector<char>   done(count, 0);
+
+    // Roots that produce an already listed board add nothing new.
+    std::vector<char> duplicate(count, 0);
+    for (size_t i = 1; i < count; ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (rootNodes[i].board.hash == rootNodes[j].board.hash) {
+                duplicate[i] = 1;
+                break;
+            }
+        }
+    }
+
+    if (plies == 0) {
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = rootNodes[i].score;
+            done[i]   = 1;
+        }
+    } else {
+        std::atomic<size_t> nextRoot(0);
+        std::function<void(int)> worker =
+            [&](int index) {
+                Scratch& local = scratch[index];
+                for (;;) {
+                    size_t k = nextRoot.fetch_add(1);
+                    if (k >= count) return;
+
+                    size_t root = order[k];
+                    if (duplicate[root]) continue;
+
+                    double value = 0.0;
+                    if (searchBranch(rootNodes[root], pieces + 1, plies,
+                                     local, value)) {
+                        values[root] = value;
+                        done[root]   = 1;
+                    }
+                }
+            };
+
+        if (pool) {
+            for (int i = 0; i < pool->size(); ++i) {
+                pool->submit(worker);
+            }
+            pool->wait();
+        } else {
+            worker(0);
+        }
+    }
+
+    // Best completed root; fall back to the greedy order if none finished.
+    size_t best  = order[0];
+    bool   found = false;
+    for (size_t i = 0; i < count; ++i) {
+        if (!done[i]) continue;
+        ++completedRoots;
+        if (!found || values[i] > values[best]) {
+            best  = i;
+            found = true;
+        }
+    }
+
+    out       = roots[best];
+    out.score = found ? values[best] : roots[best].score;
+
+    // Only a search that saw every root is worth reusing.
+    bool complete = true;
+    for (size_t i = 0; i < count; ++i) {
+        if (!done[i] && !duplicate[i]) complete = false;
+    }
+    if (table && complete) {
+        TTEntry entry;
+        entry.score    = static_cast<float>(out.score);
+        entry.depth    = plies + 1;
+        entry.rotation = out.rotation;
+        entry.x        = out.x;
+        entry.y        = out.y;
+        table->store(rootKey, entry);
+    }
+    return true;
+}
+
+template <int W, int H>
+BasicBeamSearchPlayer<W, H>::BasicBeamSearchPlayer(const SearchConfig& config,
+                                                   const HeuristicWeights& weights)
+    : BasicAutoPlayer<W, H>(weights), searcher(weights, config),
+      lookahead(std::max(1, std::min(config.depth,
+                                     1 + Randomizer::PREVIEW_COUNT))) {
+}
+
+template <int W, int H>
+Placement BasicBeamSearchPlayer<W, H>::choosePlacement(const BasicGameCore<W, H>& core) {
+    using BoardType = BasicBitBoard<W, H>;
+
+    const Piece& piece  = core.getCurrentPiece();
+    BoardType    board  = BoardType::fromBoard(core.getBoard());
+    int          pieces[1 + Randomizer::PREVIEW_COUNT] = {piece.type};
+    for (int i = 1; i < lookahead; ++i) {
+        pieces[i] = core.getPreviewPiece(i - 1);
+    }
+
+    Placement best;
+    if (!searcher.search(board, pieces, lookahead, piece, best)) {
+        return BasicAutoPlayer<W, H>::choosePlacement(core);
+    }
+    return best;
+}
+
+template class BasicBeamSearch<10, 20>;
+template class BasicBeamSearch<10, 40>;
+template class BasicBeamSearch<15, 20>;
+template class BasicBeamSearchPlayer<10, 20>;
+template class BasicBeamSearchPlayer<10, 40>;
+template class BasicBeamSearchPlayer<15, 20>;
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "AutoPlayer.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+
+// Tuning knobs of the lookahead search.
+struct SearchConfig {
+    int  depth{2};              // Pieces searched: 1 = active piece only,
+                                // 2 = plus the next piece, and so on up
+                                // to 1 + Randomizer::PREVIEW_COUNT.
+    int  beamWidth{16};         // Boards kept per ply inside a root branch.
+    int  threads{1};            // Root branches are split over this many.
+    long timeBudgetUs{5000};    // Hard limit per move; 0 = unlimited.
+                                // A limit makes moves depend on load.
+    int  ttBits{18};            // log2 transposition table slots; 0 = off.
+    bool cacheLeaves{false};    // Also cache the best last-ply score per
+                                // (board, piece); rarely hits, see
+                                // ./bench --search-tt.
+};
+
+// Beam search over placements of the active piece and the known upcoming
+// pieces. Every root placement is searched independently, best greedy
+// roots first; when the time budget runs out the best fully searched
+// root so far is returned (anytime behaviour). Sized like BasicBitBoard.
+template <int W, int H>
+class BasicBeamSearch {
+public:
+    using BoardType = BasicBitBoard<W, H>;
+
+    BasicBeamSearch(const HeuristicWeights& weights, const SearchConfig& config);
+
+    // pieces[0] is the type of `start`, the active piece; pieces[1..] are
+    // the known next pieces. The active piece may go anywhere it can
+    // reach from `start`; later pieces are dropped straight from spawn.
+    // Returns false when the active piece has no placement at all.
+    bool search(const BoardType& board, const int* pieces, int pieceCount,
+                const Piece& start, Placement& out);
+
+    // Root branches fully searched by the last call.
+    int lastCompletedRoots() const { return completedRoots; }
+
+    // Last-ply table lookups since construction and how many of them hit
+    // (both 0 unless config.cacheLeaves).
+    long leafProbes() const;
+    long leafHits() const;
+
+    // Share one table between several searchers (e.g. all games of a run).
+    void setTable(const std::shared_ptr<TranspositionTable>& shared) {
+        table = shared;
+    }
+
+private:
+    struct Node {
+        BoardType board;
+        double    bonus;         // Line-clear reward collected so far.
+        double    score;         // bonus + evaluation of `board`.
+    };
+
+    // Scratch buffers owned by one worker.
+    struct Scratch {
+        std::vector<Placement> placements;
+        std::vector<Node>      beam;
+        std::vector<Node>      next;
+        BasicBoardBatch<W, H>  batch;     // Children of one node.
+        double                 scores[BATCH_CAPACITY];
+        long                   leafProbes{0};
+        long                   leafHits{0};
+    };
+
+    HeuristicWeights weights;
+    SearchConfig     config;
+
+    std::unique_ptr<ThreadPool> pool;    // Only when config.threads > 1.
+    std::vector<Scratch>        scratch; // One per worker.
+    BasicMoveGenerator<W, H>    rootMoves;
+    int                         completedRoots{0};
+
+    // Root best moves, shared by all workers.
+    std::shared_ptr<TranspositionTable> table;
+
+    // Value of the best leaf below one root node, or false on timeout.
+    bool searchBranch(const Node& root, const int* pieces, int plies,
+                      Scratch& local, double& value) const;
+
+    // Keep the best beamWidth distinct boards of local.next.
+    void selectBeam(Scratch& local) const;
+
+    bool outOfTime() const;
+
+    long long deadlineNs{0};
+};
+
+using BeamSearch = BasicBeamSearch<BOARD_WIDTH, BOARD_HEIGHT>;
+
+// AutoPlayer that plans with BeamSearch using the preview queue.
+template <int W, int H>
+class BasicBeamSearchPlayer : public BasicAutoPlayer<W, H> {
+public:
+    explicit BasicBeamSearchPlayer(
+        const SearchConfig& config = SearchConfig(),
+        const HeuristicWeights& weights = HeuristicWeights());
+
+    Placement choosePlacement(const BasicGameCore<W, H>& core) override;
+
+    const BasicBeamSearch<W, H>& getSearcher() const { return searcher; }
+
+private:
+    BasicBeamSearch<W, H> searcher;
+    int                   lookahead;   // Pieces handed to the search.
+};
+
+using BeamSearchPlayer = BasicBeamSearchPlayer<BOARD_WIDTH, BOARD_HEIGHT>;
+
+// Compiled once in BeamSearch.cpp, for the BasicBitBoard sizes.
+extern template class BasicBeamSearch<10, 20>;
+extern template class BasicBeamSearch<10, 40>;
+extern template class BasicBeamSearch<15, 20>;
+extern template class BasicBeamSearchPlayer<10, 20>;
+extern template class BasicBeamSearchPlayer<10, 40>;
+extern template class BasicBeamSearchPlayer<15, 20>;
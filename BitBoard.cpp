@@ -0,0 +1,130 @@
+#include "BitBoard.h"
+
+#include <cstdio>
+
+namespace {
+
+struct ShapeTable {
+    PieceShape shapes[BlockTemplate::NUM_BLOCK_TYPES][4];
+
+    ShapeTable() {
+        BlockTemplate::initializeTemplates();
+
+        for (int type = 0; type < BlockTemplate::NUM_BLOCK_TYPES; ++type) {
+            for (int rot = 0; rot < 4; ++rot) {
+                PieceShape& s = shapes[type][rot];
+                s.minCol = s.minRow = BlockTemplate::BLOCK_SIZE;
+                s.maxCol = s.maxRow = -1;
+
+                for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
+                    s.rows[row] = 0;
+                    for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
+                        if (BlockTemplate::getCell(type, rot, row, col) == ' ') {
+                            continue;
+                        }
+                        s.rows[row] |= static_cast<uint8_t>(1u << col);
+                        if (col < s.minCol) s.minCol = col;
+                        if (col > s.maxCol) s.maxCol = col;
+                        if (row < s.minRow) s.minRow = row;
+                        if (row > s.maxRow) s.maxRow = row;
+                    }
+                }
+            }
+        }
+    }
+};
+
+} // namespace
+
+const PieceShape& pieceShape(int type, int rotation) {
+    static const ShapeTable table;
+    return table.shapes[type][rotation];
+}
+
+template <int W, int H>
+BasicBitBoard<W, H> BasicBitBoard<W, H>::fromBoard(const BasicBoard<W, H>& board) {
+    // Board keeps the same row masks and hash; copy them as they are.
+    BasicBitBoard bits;
+    for (int y = 0; y < H; ++y) {
+        bits.rows[y] = board.rowBits[y];
+    }
+    bits.hash = board.hash;
+    return bits;
+}
+
+template <int W, int H>
+bool BasicBitBoard<W, H>::collides(int type, int rotation, int x, int y) const {
+    const PieceShape& s = shape(type, rotation);
+
+    if (x + s.minCol < 0 || x + s.maxCol >= W) return true;
+    if (y + s.maxRow >= H)                    return true;
+
+    for (int row = s.minRow; row <= s.maxRow; ++row) {
+        int yt = y + row;
+        if (yt < 0) continue;
+        if (rows[yt] & shifted(s.rows[row], x)) return true;
+    }
+    return false;
+}
+
+template <int W, int H>
+int BasicBitBoard<W, H>::dropY(int type, int rotation, int x, int y) const {
+    while (!collides(type, rotation, x, y + 1)) {
+        ++y;
+    }
+    return y;
+}
+
+template <int W, int H>
+int BasicBitBoard<W, H>::place(int type, int rotation, int x, int y) {
+    const PieceShape& s = shape(type, rotation);
+    for (int row = s.minRow; row <= s.maxRow; ++row) {
+        int yt = y + row;
+        if (yt < 0) continue;
+        setRow(yt, static_cast<RowMask>(rows[yt] | shifted(s.rows[row], x)));
+    }
+    return clearLines();
+}
+
+template <int W, int H>
+int BasicBitBoard<W, H>::clearLines() {
+    int writeRow = H - 1;
+    int cleared  = 0;
+
+    // Same bottom-up compaction as Board::clearLines(), one mask per row.
+    for (int readRow = H - 1; readRow >= 0; --readRow) {
+        if (rows[readRow] == FULL_ROW) {
+            ++cleared;
+            continue;
+        }
+        if (writeRow != readRow) setRow(writeRow, rows[readRow]);
+        --writeRow;
+    }
+    while (writeRow >= 0) {
+        setRow(writeRow--, 0);
+    }
+    return cleared;
+}
+
+template <int W, int H>
+bool BasicBitBoard<W, H>::operator==(const BasicBitBoard& other) const {
+    for (int y = 0; y < H; ++y) {
+        if (rows[y] != other.rows[y]) return false;
+    }
+    return true;
+}
+
+template class BasicBitBoard<10, 20>;
+template class BasicBitBoard<10, 40>;
+template class BasicBitBoard<15, 20>;
+
+bool parseBoardSize(const char* text, int& width, int& height) {
+    int  w = 0, h = 0;
+    char end;
+    if (std::sscanf(text, "%dx%d%c", &w, &h, &end) != 2) return false;
+    if (!(w == 10 && (h == 20 || h == 40)) && !(w == 15 && h == 20)) return false;
+
+    width  = w;
+    height = h;
+    return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Board.h"
+#include "BlockTemplate.h"
+#include "Zobrist.h"
+
+// Bit masks of one tetromino rotation, taken from BlockTemplate.
+struct PieceShape {
+    uint8_t rows[BlockTemplate::BLOCK_SIZE]; // Bit c = template column c.
+    int     minCol;                          // Occupied column range.
+    int     maxCol;
+    int     minRow;                          // Occupied row range.
+    int     maxRow;
+};
+
+// Precomputed masks for a piece type and rotation.
+const PieceShape& pieceShape(int type, int rotation);
+
+// Compact occupancy-only copy of a W x H board for fast search and
+// evaluation. Sized like BasicBoard; the bot sizes are listed at the end.
+template <int W, int H>
+class BasicBitBoard {
+public:
+    static_assert(BasicBoard<W, H>::HASHED,
+                  "search boards are hashed: at most ZOBRIST_MAX_WIDTH x "
+                  "ZOBRIST_MAX_HEIGHT");
+
+    // One board row as a bit mask: bit x set = column x occupied. The
+    // same type BasicBoard picks for its width.
+    using RowMask = typename BasicBoard<W, H>::RowMask;
+    static constexpr RowMask FULL_ROW = BasicBoard<W, H>::FULL_ROW;
+
+    RowMask  rows[H]{};
+
+    // Zobrist hash of the occupied cells, equal to Board::hash for the
+    // same contents. Maintained by fromBoard(), place() and clearLines().
+    uint64_t hash{0};
+
+    // Occupied cells of a board (its row masks and hash).
+    static BasicBitBoard fromBoard(const BasicBoard<W, H>& board);
+
+    static const PieceShape& shape(int type, int rotation) {
+        return pieceShape(type, rotation);
+    }
+
+    // True when the piece overlaps a filled cell, a wall or the floor.
+    // Rows above the top edge are open, like GameCore::canPlace().
+    bool collides(int type, int rotation, int x, int y) const;
+
+    // Lowest y reachable by dropping straight down from y.
+    int dropY(int type, int rotation, int x, int y) const;
+
+    // Set a row mask and update the hash.
+    void setRow(int y, RowMask mask) {
+        hash ^= Zobrist::row(y, rows[y]) ^ Zobrist::row(y, mask);
+        rows[y] = mask;
+    }
+
+    // Lock a piece and clear full rows; returns the number of rows cleared.
+    int place(int type, int rotation, int x, int y);
+
+    // Remove full rows, shifting the rest down.
+    int clearLines();
+
+    bool operator==(const BasicBitBoard& other) const;
+
+private:
+    // Row mask of a piece row moved to board column x.
+    static RowMask shifted(RowMask mask, int x) {
+        return x >= 0 ? static_cast<RowMask>(mask << x)
+                      : static_cast<RowMask>(mask >> -x);
+    }
+};
+
+template <int W, int H>
+constexpr typename BasicBitBoard<W, H>::RowMask BasicBitBoard<W, H>::FULL_ROW;
+
+// The game's size.
+using BitBoard = BasicBitBoard<BOARD_WIDTH, BOARD_HEIGHT>;
+
+// Compiled once in BitBoard.cpp, for the sizes bots play on: the game's
+// and the guideline fields (the stress board is too large to hash).
+extern template class BasicBitBoard<10, 20>;
+extern template class BasicBitBoard<10, 40>;
+extern template class BasicBitBoard<15, 20>;
+
+// Parse "WxH" naming one of the sizes above; false for any other text.
+bool parseBoardSize(const char* text, int& width, int& height);
@@ -15,6 +15,13 @@ void BlockTemplate::setBlockTemplate(
 }
 
 void BlockTemplate::initializeTemplates() {
+    // Function-local statics are initialized exactly once, even when
+    // several simulation threads construct games at the same time.
+    static const bool filled = fillTemplates();
+    (void)filled;
+}
+
+bool BlockTemplate::fillTemplates() {
     // 7 tetromino base shapes in 4x4 matrices.
     // 1 = filled cell, 0 = empty.
     static const int TETROMINOES[NUM_BLOCK_TYPES][BLOCK_SIZE][BLOCK_SIZE] = {
@@ -39,6 +46,7 @@ void BlockTemplate::initializeTemplates() {
     for (int i = 0; i < NUM_BLOCK_TYPES; ++i) {
         setBlockTemplate(i, NAMES[i], TETROMINOES[i]);
     }
+    return true;
 }
 
 char BlockTemplate::getCell(int type, int rotation, int row, int col) {
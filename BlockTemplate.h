@@ -5,7 +5,7 @@ public:
     static constexpr int BLOCK_SIZE      = 4;
     static constexpr int NUM_BLOCK_TYPES = 7;
 
-    // Initialize all tetromino templates
+    // Initialize all tetromino templates (once; safe from any thread).
     static void initializeTemplates();
 
     // Return the character for a given piece cell after rotation.
@@ -13,6 +13,9 @@ public:
 private:
     static char templates[NUM_BLOCK_TYPES][BLOCK_SIZE][BLOCK_SIZE];
 
+    // Fill every template entry; always returns true.
+    static bool fillTemplates();
+
     // Hàm hỗ trợ để điền một template entry
     static void setBlockTemplate(
         int type,
@@ -2,6 +2,7 @@
 #include "BlockTemplate.h"
 #include <iostream>
 #include <algorithm>
+#include <cstring>
 
 // Define color escape constants once here.
 const char* COLOR_RESET  = "\033[0m";
@@ -13,6 +14,7 @@ const char* COLOR_RED    = "\033[31m";
 const char* COLOR_BLUE   = "\033[34m";
 const char* COLOR_ORANGE = "\033[38;5;208m";
 const char* COLOR_WHITE  = "\033[37m";
+const char* COLOR_GRAY   = "\033[90m";
 
 const char* PIECE_COLORS[BlockTemplate::NUM_BLOCK_TYPES] = {
     COLOR_CYAN,   // I
@@ -35,38 +37,89 @@ const char* getColorForPiece(char cell) {
         case 'L': return PIECE_COLORS[6];
         case '.': return COLOR_WHITE; // ghost
         case '#': return COLOR_WHITE; // game over animation
+        case GARBAGE_CELL: return COLOR_GRAY;
         default:  return COLOR_RESET;
     }
 }
 
-void Board::init() {
+namespace {
+
+const char* const STAT_LABELS[3] = {" SCORE:", " LEVEL:", " LINES:"};
+
+// Pad the panel text written since `start` (plain ASCII) to PANEL_WIDTH
+// and close the row with the right border.
+void closePanelRow(std::string& frame, size_t start) {
+    int padding = PANEL_WIDTH - static_cast<int>(frame.size() - start);
+    if (padding > 0) frame.append(padding, ' ');
+    frame += "║";
+}
+
+} // namespace
+
+template <int W, int H>
+void BasicBoard<W, H>::init() {
     // Fill all cells with spaces (empty).
-    for (int y = 0; y < BOARD_HEIGHT; ++y) {
-        for (int x = 0; x < BOARD_WIDTH; ++x) {
-            grid[y][x] = ' ';
+    std::memset(grid, ' ', sizeof(grid));
+    std::memset(rowBits, 0, sizeof(rowBits));
+    hash = 0;
+}
+
+template <int W, int H>
+void BasicBoard<W, H>::setCell(int x, int y, char cell) {
+    // Only occupancy changes affect the row mask and the hash.
+    if ((grid[y][x] != ' ') != (cell != ' ')) {
+        rowBits[y] ^= static_cast<RowMask>(RowMask(1) << x);
+        if (HASHED) hash ^= Zobrist::cell(x, y);
+    }
+    grid[y][x] = cell;
+}
+
+template <int W, int H>
+void BasicBoard<W, H>::recomputeHash() {
+    hash = 0;
+    for (int y = 0; y < H; ++y) {
+        RowMask bits = 0;
+        for (int x = 0; x < W; ++x) {
+            if (grid[y][x] != ' ') bits |= static_cast<RowMask>(RowMask(1) << x);
         }
+        rowBits[y] = bits;
+        if (HASHED) hash ^= Zobrist::row(y, bits);
     }
 }
 
-void Board::draw(
+template <int W, int H>
+void BasicBoard<W, H>::draw(
     const GameState& state,
-    const std::string nextPieceLines[4]
+    const std::string nextPieceLines[4],
+    std::string& frame
+) const {
+    render(state, nextPieceLines, frame);
+
+    std::cout << frame;
+    std::cout.flush();
+}
+
+template <int W, int H>
+void BasicBoard<W, H>::render(
+    const GameState& state,
+    const std::string nextPieceLines[4],
+    std::string& frame
 ) const {
     using std::string;
-    string frame;
+    frame.clear();
     frame.reserve(12000); // Enough capacity for ANSI colors and full frame.
 
     // Clear screen and move cursor to top\-left (ANSI escapes).
     frame += "\033[1;1H";
 
     const string title = "TETRIS GAME";
-    int boardVisualWidth = BOARD_WIDTH * 2; // Each cell is drawn 2 chars wide.
+    int boardVisualWidth = W * 2; // Each cell is drawn 2 chars wide.
 
     // Top border with box\-drawing characters.
     frame += "╔";
     for (int i = 0; i < boardVisualWidth; ++i) frame += "═";
     frame += "╦";
-    for (int i = 0; i < 13; ++i) frame += "═";
+    for (int i = 0; i < PANEL_WIDTH; ++i) frame += "═";
     frame += "╗\n";
 
     // Title row.
@@ -78,21 +131,27 @@ void Board::draw(
     frame.append(leftPad, ' ');
     frame += title;
     frame.append(rightPad, ' ');
-    frame += "║  NEXT PIECE ║\n";
+    frame += "║";
+    const char* panelTitle = "NEXT PIECE";
+    size_t titleStart = frame.size();
+    frame.append((PANEL_WIDTH - std::strlen(panelTitle) + 1) / 2, ' ');
+    frame += panelTitle;
+    closePanelRow(frame, titleStart);
+    frame += '\n';
 
     // Divider row.
     frame += "╠";
     for (int i = 0; i < boardVisualWidth; ++i) frame += "═";
     frame += "╬";
-    for (int i = 0; i < 13; ++i) frame += "═";
+    for (int i = 0; i < PANEL_WIDTH; ++i) frame += "═";
     frame += "╣\n";
 
     // Main playfield rows.
-    for (int y = 0; y < BOARD_HEIGHT; ++y) {
+    for (int y = 0; y < H; ++y) {
         frame += "║";
 
         // Left side: playfield cells.
-        for (int x = 0; x < BOARD_WIDTH; ++x) {
+        for (int x = 0; x < W; ++x) {
             char cell = grid[y][x];
 
             if (cell == '.') {
@@ -112,48 +171,35 @@ void Board::draw(
         frame += "║";
 
         // Right side: next piece + stats panel.
-        if (y == 0) {
-            frame.append(13, ' ');
+        if (y >= 1 && y <= 4) {
+            // One row of the preview, two cells wide per template column.
+            frame += "  ";
+            frame += nextPieceLines[y - 1];
+            frame.append(PANEL_WIDTH - 2 - BlockTemplate::BLOCK_SIZE * 2, ' ');
             frame += "║";
-        } else if (y >= 1 && y <= 4) {
-            frame += "  ";                      // Left padding (2 spaces)
-            frame += nextPieceLines[y - 1];     // One row of preview
-            frame += "   ║";                    // Right padding + border
-        } else if (y == 5) {
-            frame.append(13, ' ');
+        } else if (y == PANEL_STATS_ROW - 1) {
+            for (int k = 0; k < PANEL_WIDTH; ++k) frame += "─";
             frame += "║";
-        } else if (y == 6) {
-            for (int k = 0; k < 13; ++k) frame += "─";
-            frame += "║";
-        } else if (y == 7) {
-            frame += " SCORE:      ║";
-        } else if (y == 8) {
-            string scoreStr = std::to_string(state.score);
-            frame += " ";
-            frame += scoreStr;
-            int padding = 12 - static_cast<int>(scoreStr.length());
-            if (padding > 0) frame.append(padding, ' ');
-            frame += "║";
-        } else if (y == 9) {
-            frame += " LEVEL:      ║";
-        } else if (y == 10) {
-            string lvlStr = std::to_string(state.level);
-            frame += " ";
-            frame += lvlStr;
-            int padding = 12 - static_cast<int>(lvlStr.length());
-            if (padding > 0) frame.append(padding, ' ');
-            frame += "║";
-        } else if (y == 11) {
-            frame += " LINES:      ║";
-        } else if (y == 12) {
-            string linesStr = std::to_string(state.linesCleared);
-            frame += " ";
-            frame += linesStr;
-            int padding = 12 - static_cast<int>(linesStr.length());
-            if (padding > 0) frame.append(padding, ' ');
+        } else if (y >= PANEL_STATS_ROW && y < PANEL_FIRST_FREE_ROW) {
+            int stat = (y - PANEL_STATS_ROW) / 2;
+            size_t start = frame.size();
+            if ((y - PANEL_STATS_ROW) % 2 == 0) {
+                frame += STAT_LABELS[stat];
+            } else {
+                frame += " ";
+                appendInt(frame, stat == 0 ? state.score
+                               : stat == 1 ? state.level
+                                           : state.linesCleared);
+            }
+            closePanelRow(frame, start);
+        } else if (y >= PANEL_FIRST_FREE_ROW &&
+                   y - PANEL_FIRST_FREE_ROW < static_cast<int>(state.panelLines.size())) {
+            const string& line = state.panelLines[y - PANEL_FIRST_FREE_ROW];
+            frame.append(line, 0, PANEL_WIDTH);
+            if (line.size() < PANEL_WIDTH) frame.append(PANEL_WIDTH - line.size(), ' ');
             frame += "║";
         } else {
-            frame.append(13, ' ');
+            frame.append(PANEL_WIDTH, ' ');
             frame += "║";
         }
 
@@ -164,52 +210,104 @@ void Board::draw(
     frame += "╚";
     for (int i = 0; i < boardVisualWidth; ++i) frame += "═";
     frame += "╩";
-    for (int i = 0; i < 13; ++i) frame += "═";
+    for (int i = 0; i < PANEL_WIDTH; ++i) frame += "═";
     frame += "╝\n";
 
     frame +=
         "Controls: A/D (Move)  W (Rotate)  S (Soft Drop)  SPACE (Hard Drop)"
-        "  G (Ghost)  P (Pause)  Q (Quit)\n";
+        "  G (Ghost)  B (Bot)  P (Pause)  Q (Quit)\n";
+}
 
-    std::cout << frame;
-    std::cout.flush();
+void appendInt(std::string& out, long value) {
+    // Digits are produced backwards into a stack buffer.
+    char digits[24];
+    int  count = 0;
+    unsigned long magnitude = value < 0 ? 0UL - static_cast<unsigned long>(value)
+                                        : static_cast<unsigned long>(value);
+    do {
+        digits[count++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) out += '-';
+    while (count > 0) out += digits[--count];
 }
 
-int Board::clearLines() {
-    int writeRow    = BOARD_HEIGHT - 1;
-    int linesCleared = 0;
+void renderPiecePreview(int type, std::string lines[4]) {
+    // Each template cell becomes "██" in the piece color or two spaces.
+    for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
+        lines[row].clear();
+        lines[row].reserve(64);
 
-    // Start from bottom row and scan upwards.
-    for (int readRow = BOARD_HEIGHT - 1; readRow >= 0; --readRow) {
-        bool full = true;
-        for (int x = 0; x < BOARD_WIDTH; ++x) {
-            if (grid[readRow][x] == ' ') {
-                full = false;
-                break;
+        for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
+            char cell = BlockTemplate::getCell(type, 0, row, col);
+            if (cell != ' ') {
+                lines[row] += PIECE_COLORS[type];
+                lines[row].append("██");
+                lines[row] += COLOR_RESET;
+            } else {
+                lines[row].append("  ");
             }
         }
+    }
+}
 
-        if (!full) {
-            // If the row is NOT full, copy it down to writeRow.
-            if (writeRow != readRow) {
-                for (int x = 0; x < BOARD_WIDTH; ++x) {
-                    grid[writeRow][x] = grid[readRow][x];
-                }
-            }
-            --writeRow;
-        } else {
+template <int W, int H>
+int BasicBoard<W, H>::clearLines() {
+    int writeRow     = H - 1;
+    int linesCleared = 0;
+
+    // Start from bottom row and scan upwards; a row is full when its mask is.
+    for (int readRow = H - 1; readRow >= 0; --readRow) {
+        if (rowBits[readRow] == FULL_ROW) {
             // Row is full: we simply skip it and count a cleared line.
             ++linesCleared;
+            continue;
         }
-    }
 
-    // Any rows above writeRow are cleared to empty.
-    while (writeRow >= 0) {
-        for (int x = 0; x < BOARD_WIDTH; ++x) {
-            grid[writeRow][x] = ' ';
+        // If the row is NOT full, copy it down to writeRow.
+        if (writeRow != readRow) {
+            if (HASHED) {
+                hash ^= Zobrist::row(writeRow, rowBits[writeRow]) ^
+                        Zobrist::row(writeRow, rowBits[readRow]);
+            }
+            std::memcpy(grid[writeRow], grid[readRow], W);
+            rowBits[writeRow] = rowBits[readRow];
         }
         --writeRow;
     }
 
+    // Any rows above writeRow are cleared to empty.
+    for (; writeRow >= 0; --writeRow) {
+        if (HASHED) hash ^= Zobrist::row(writeRow, rowBits[writeRow]);
+        std::memset(grid[writeRow], ' ', W);
+        rowBits[writeRow] = 0;
+    }
+
     return linesCleared;
 }
+
+template <int W, int H>
+bool BasicBoard<W, H>::addGarbage(int rows, int hole) {
+    if (rows <= 0) return true;
+    if (rows > H) rows = H;
+
+    // Anything in the top `rows` rows is lost.
+    bool overflow = false;
+    for (int y = 0; y < rows; ++y) {
+        if (rowBits[y] != 0) overflow = true;
+    }
+
+    std::memmove(grid[0], grid[rows], static_cast<size_t>(H - rows) * W);
+    for (int y = H - rows; y < H; ++y) {
+        std::memset(grid[y], GARBAGE_CELL, W);
+        if (hole >= 0 && hole < W) grid[y][hole] = ' ';
+    }
+
+    recomputeHash();
+    return !overflow;
+}
+
+template class BasicBoard<10, 20>;
+template class BasicBoard<10, 40>;
+template class BasicBoard<15, 20>;
+template class BasicBoard<64, 128>;
@@ -1,7 +1,10 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <type_traits>
 #include "GameState.h"
 #include "BlockTemplate.h"
+#include "Zobrist.h"
 
 // Terminal color escape sequences (ANSI).
 extern const char* COLOR_RESET;
@@ -13,6 +16,7 @@ extern const char* COLOR_RED;
 extern const char* COLOR_BLUE;
 extern const char* COLOR_ORANGE;
 extern const char* COLOR_WHITE;
+extern const char* COLOR_GRAY;
 
 // Piece color mapping array
 extern const char* PIECE_COLORS[BlockTemplate::NUM_BLOCK_TYPES];
@@ -20,23 +24,128 @@ extern const char* PIECE_COLORS[BlockTemplate::NUM_BLOCK_TYPES];
 constexpr int BOARD_HEIGHT    = 20;
 constexpr int BOARD_WIDTH     = 15;
 
-class Board {
+// Columns of the right-side panel (next piece and stats).
+constexpr int PANEL_WIDTH     = 13;
+
+// Panel rows: the next piece above PANEL_STATS_ROW, then a label row and a
+// value row each for score, level and lines. GameState::panelLines fill
+// the rows from PANEL_FIRST_FREE_ROW down.
+constexpr int PANEL_STATS_ROW      = 7;
+constexpr int PANEL_FIRST_FREE_ROW = PANEL_STATS_ROW + 6;
+
+static_assert(PANEL_WIDTH >= 12, "The panel needs room for the NEXT PIECE title");
+
+// Cell of a garbage row sent by an opponent in versus play.
+constexpr char GARBAGE_CELL   = 'G';
+
+// Narrowest unsigned type that holds one board row, bit x = column x.
+template <int W>
+struct RowMaskFor {
+    static_assert(W >= 1 && W <= 64, "Board rows are at most 64 cells wide");
+    using type = typename std::conditional<W <= 8,  uint8_t,
+                 typename std::conditional<W <= 16, uint16_t,
+                 typename std::conditional<W <= 32, uint32_t,
+                                                    uint64_t>::type>::type>::type;
+};
+
+// Playfield of W x H cells. Each size is its own type, so loop bounds and
+// the row mask type are compile-time constants; the sizes built into every
+// binary are listed at the end of this header.
+template <int W, int H>
+class BasicBoard {
 public:
+    static constexpr int WIDTH  = W;
+    static constexpr int HEIGHT = H;
+
+    using RowMask = typename RowMaskFor<W>::type;
+    static constexpr RowMask FULL_ROW =
+        static_cast<RowMask>(~static_cast<uint64_t>(0) >> (64 - W));
+
+    // Zobrist keys cover boards up to ZOBRIST_MAX_WIDTH x ZOBRIST_MAX_HEIGHT;
+    // larger (stress) boards are not hashed and keep hash at 0.
+    static constexpr bool HASHED = W <= ZOBRIST_MAX_WIDTH &&
+                                   H <= ZOBRIST_MAX_HEIGHT;
+
+    static_assert(W >= 6 && H >= PANEL_FIRST_FREE_ROW,
+                  "The frame needs room for the title and the side panel");
+
     // 2D char grid representing the playfield
-    char grid[BOARD_HEIGHT][BOARD_WIDTH]{};
+    char grid[H][W]{};
+
+    // Occupied cells of each row. Kept in step with the grid by init(),
+    // setCell(), recomputeHash() and clearLines().
+    RowMask rowBits[H]{};
+
+    // Zobrist hash of the occupied cells. Kept up to date by init(),
+    // setCell() and clearLines(); direct grid writes (ghost dots, display
+    // copies) are not tracked.
+    uint64_t hash{0};
 
     // Reset the board to all empty spaces
     void init();
 
-    // Render the board and right-side panel to the terminal
+    // Write one cell and update the row mask and the hash.
+    void setCell(int x, int y, char cell);
+
+    bool isOccupied(int x, int y) const { return (rowBits[y] >> x) & 1u; }
+
+    // Rebuild the row masks and the hash from the grid.
+    void recomputeHash();
+
+    // Render the board and right-side panel to the terminal, composing
+    // into `frame`; a buffer kept from frame to frame makes drawing
+    // allocation-free once it has grown to a full frame.
     void draw(
         const GameState& state,
-        const std::string nextPieceLines[4]
+        const std::string nextPieceLines[4],
+        std::string& frame
+    ) const;
+
+    // Compose the same frame into a string (cleared first) without any I/O.
+    void render(
+        const GameState& state,
+        const std::string nextPieceLines[4],
+        std::string& frame
     ) const;
 
     // Number of lines cleared.
     int clearLines();
+
+    // Push every row up by `rows` and fill the bottom with garbage rows
+    // open at column `hole`. False when occupied cells went off the top.
+    bool addGarbage(int rows, int hole);
 };
 
+template <int W, int H> constexpr int BasicBoard<W, H>::WIDTH;
+template <int W, int H> constexpr int BasicBoard<W, H>::HEIGHT;
+template <int W, int H>
+constexpr typename BasicBoard<W, H>::RowMask BasicBoard<W, H>::FULL_ROW;
+template <int W, int H> constexpr bool BasicBoard<W, H>::HASHED;
+
+// The game's board.
+using Board = BasicBoard<BOARD_WIDTH, BOARD_HEIGHT>;
+
+// Other sizes: the guideline 10x20 and 10x40 fields and a stress board
+// far beyond any real game.
+using Board10x20  = BasicBoard<10, 20>;
+using Board10x40  = BasicBoard<10, 40>;
+using StressBoard = BasicBoard<64, 128>;
+
+// Compiled once in Board.cpp.
+extern template class BasicBoard<10, 20>;
+extern template class BasicBoard<10, 40>;
+extern template class BasicBoard<15, 20>;
+extern template class BasicBoard<64, 128>;
+
+static_assert((BOARD_WIDTH == 10 && (BOARD_HEIGHT == 20 || BOARD_HEIGHT == 40)) ||
+              (BOARD_WIDTH == 15 && BOARD_HEIGHT == 20),
+              "BOARD_WIDTH x BOARD_HEIGHT must be one of the instantiated sizes");
+
 // Helper that maps a block character to a color code.
-const char* getColorForPiece(char cell);
\ No newline at end of file
+const char* getColorForPiece(char cell);
+
+// Append the decimal digits of `value` without a temporary string.
+void appendInt(std::string& out, long value);
+
+// Colored rows of a piece's 4x4 template (rotation 0) for the preview box.
+void renderPiecePreview(int type, std::string lines[4]);
\ No newline at end of file
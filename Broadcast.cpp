@@ -0,0 +1,475 @@
+#include "Broadcast.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+
+// Bytes of the fields every message starts with, type byte included.
+constexpr size_t HEADER_BYTES = 1 + 4 + 4 + 4 + 4 + 1 + 1 + 1 + 1 + 1 + 1;
+
+void putU8(std::string& out, int value) {
+    out += static_cast<char>(value & 0xFF);
+}
+
+void putU16(std::string& out, int value) {
+    putU8(out, value);
+    putU8(out, value >> 8);
+}
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) putU8(out, static_cast<int>(value >> (8 * i)));
+}
+
+// Bounds-checked little-endian reads of a message body.
+struct Reader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos{0};
+    bool   ok{true};
+
+    Reader(const uint8_t* body, size_t bodySize) : data(body), size(bodySize) {}
+
+    uint32_t get(int bytes) {
+        if (pos + bytes > size) {
+            ok = false;
+            return 0;
+        }
+        uint32_t value = 0;
+        for (int i = 0; i < bytes; ++i) value |= static_cast<uint32_t>(data[pos++]) << (8 * i);
+        return value;
+    }
+};
+
+// "unix:PATH" or a path, or "tcp:PORT" on the loopback interface.
+bool parseAddress(const std::string& address, sockaddr_storage& addr,
+                  socklen_t& length, std::string& path, std::string& error) {
+    std::memset(&addr, 0, sizeof(addr));
+    path.clear();
+
+    if (address.compare(0, 4, "tcp:") == 0) {
+        char* end  = nullptr;
+        long  port = std::strtol(address.c_str() + 4, &end, 10);
+        if (end == address.c_str() + 4 || *end != '\0' || port < 1 || port > 65535) {
+            error = "Bad TCP port in " + address;
+            return false;
+        }
+        sockaddr_in& in = reinterpret_cast<sockaddr_in&>(addr);
+        in.sin_family      = AF_INET;
+        in.sin_port        = htons(static_cast<uint16_t>(port));
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        length = sizeof(in);
+        return true;
+    }
+
+    path = address.compare(0, 5, "unix:") == 0 ? address.substr(5) : address;
+    sockaddr_un& un = reinterpret_cast<sockaddr_un&>(addr);
+    if (path.empty() || path.size() >= sizeof(un.sun_path)) {
+        error = "Bad Unix socket path: " + address;
+        return false;
+    }
+    un.sun_family = AF_UNIX;
+    std::memcpy(un.sun_path, path.c_str(), path.size() + 1);
+    length = sizeof(un);
+    return true;
+}
+
+std::string systemError(const std::string& what, const std::string& address) {
+    return what + " " + address + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+// \=== Frames and the wire format ===
+
+SpectatorFrame::SpectatorFrame() {
+    std::memset(cells, ' ', sizeof(cells));
+}
+
+void SpectatorFrame::capture(const GameCore& core, const GameState& state) {
+    std::memcpy(cells, core.getBoard().grid, sizeof(cells));
+    score    = core.getScore();
+    level    = core.getLevel();
+    lines    = core.getLinesCleared();
+    nextType = core.getNextPieceType();
+    piece    = core.getCurrentPiece();
+    gameOver = core.isGameOver();
+    paused   = state.paused;
+}
+
+void encodeFrame(const SpectatorFrame& frame, const SpectatorFrame* previous,
+                 std::string& out) {
+    out.clear();
+    putU32(out, 0);   // Body length, filled in below.
+    putU8(out, previous ? 'D' : 'K');
+    putU32(out, frame.seq);
+    putU32(out, static_cast<uint32_t>(frame.score));
+    putU32(out, static_cast<uint32_t>(frame.level));
+    putU32(out, static_cast<uint32_t>(frame.lines));
+    putU8(out, frame.nextType);
+    putU8(out, frame.piece.type);
+    putU8(out, frame.piece.rotation);
+    putU8(out, frame.piece.pos.x);
+    putU8(out, frame.piece.pos.y);
+    putU8(out, (frame.gameOver ? 1 : 0) | (frame.paused ? 2 : 0));
+
+    if (!previous) {
+        putU8(out, BOARD_WIDTH);
+        putU8(out, BOARD_HEIGHT);
+        out.append(&frame.cells[0][0], sizeof(frame.cells));
+    } else {
+        size_t countAt = out.size();
+        putU16(out, 0);
+        int count = 0;
+        const char* now    = &frame.cells[0][0];
+        const char* before = &previous->cells[0][0];
+        for (int i = 0; i < BOARD_WIDTH * BOARD_HEIGHT; ++i) {
+            if (now[i] == before[i]) continue;
+            putU16(out, i);
+            putU8(out, now[i]);
+            ++count;
+        }
+        out[countAt]     = static_cast<char>(count & 0xFF);
+        out[countAt + 1] = static_cast<char>(count >> 8);
+    }
+
+    uint32_t body = static_cast<uint32_t>(out.size() - 4);
+    for (int i = 0; i < 4; ++i) out[i] = static_cast<char>(body >> (8 * i));
+}
+
+bool decodeFrame(const uint8_t* body, size_t size, SpectatorFrame& frame,
+                 bool& synced) {
+    if (size < HEADER_BYTES) return false;
+    Reader in(body, size);
+    int type = static_cast<int>(in.get(1));
+    if (type != 'K' && (type != 'D' || !synced)) return false;
+
+    frame.seq            = in.get(4);
+    frame.score          = static_cast<int32_t>(in.get(4));
+    frame.level          = static_cast<int32_t>(in.get(4));
+    frame.lines          = static_cast<int32_t>(in.get(4));
+    frame.nextType       = static_cast<int>(in.get(1)) % 7;
+    frame.piece.type     = static_cast<int>(in.get(1)) % 7;
+    frame.piece.rotation = static_cast<int>(in.get(1)) & 3;
+    frame.piece.pos.x    = static_cast<int8_t>(in.get(1));
+    frame.piece.pos.y    = static_cast<int8_t>(in.get(1));
+    int flags            = static_cast<int>(in.get(1));
+    frame.gameOver       = flags & 1;
+    frame.paused         = flags & 2;
+
+    if (type == 'K') {
+        int width  = static_cast<int>(in.get(1));
+        int height = static_cast<int>(in.get(1));
+        if (width != BOARD_WIDTH || height != BOARD_HEIGHT ||
+            size - in.pos != sizeof(frame.cells)) {
+            return false;
+        }
+        std::memcpy(frame.cells, body + in.pos, sizeof(frame.cells));
+        synced = true;
+        return true;
+    }
+
+    int   count = static_cast<int>(in.get(2));
+    char* cells = &frame.cells[0][0];
+    for (int i = 0; i < count && in.ok; ++i) {
+        uint32_t index = in.get(2);
+        char     cell  = static_cast<char>(in.get(1));
+        if (index >= static_cast<uint32_t>(BOARD_WIDTH * BOARD_HEIGHT)) return false;
+        cells[index] = cell;
+    }
+    return in.ok && in.pos == size;
+}
+
+// \=== Sockets ===
+
+int listenOn(const std::string& address, std::string& error) {
+    sockaddr_storage addr;
+    socklen_t length;
+    std::string path;
+    if (!parseAddress(address, addr, length, path, error)) return -1;
+
+    int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = systemError("Cannot create a socket for", address);
+        return -1;
+    }
+    if (path.empty()) {
+        int yes = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    } else {
+        // A socket file left behind by an earlier session.
+        unlink(path.c_str());
+    }
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), length) < 0 || listen(fd, 16) < 0) {
+        error = systemError("Cannot listen on", address);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int connectTo(const std::string& address, std::string& error) {
+    sockaddr_storage addr;
+    socklen_t length;
+    std::string path;
+    if (!parseAddress(address, addr, length, path, error)) return -1;
+
+    int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = systemError("Cannot create a socket for", address);
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), length) < 0) {
+        error = systemError("Cannot connect to", address);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// \=== BroadcastServer ===
+
+BroadcastServer::~BroadcastServer() {
+    stop();
+}
+
+bool BroadcastServer::start(const std::string& address, std::string& error) {
+    stop();
+
+    listenFd = listenOn(address, error);
+    if (listenFd < 0) return false;
+    if (address.compare(0, 4, "tcp:") != 0) {
+        socketPath = address.compare(0, 5, "unix:") == 0 ? address.substr(5) : address;
+    }
+
+    wakeFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (wakeFd < 0 || epollFd < 0) {
+        error = systemError("Cannot set up epoll for", address);
+        stop();
+        return false;
+    }
+    epoll_event event{};
+    event.events  = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    // Sized up front: the broadcaster never allocates while frames flow.
+    connected.clear();
+    connected.reserve(MAX_CLIENTS);
+    keyframe.reserve(64 + sizeof(SpectatorFrame::cells));
+    delta.reserve(64 + 3 * sizeof(SpectatorFrame::cells));
+    haveLast = false;
+    keyframeReady = false;
+
+    stopping.store(false, std::memory_order_relaxed);
+    thread = std::thread(&BroadcastServer::run, this);
+    return true;
+}
+
+void BroadcastServer::stop() {
+    if (thread.joinable()) {
+        stopping.store(true, std::memory_order_release);
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) {
+            // The counter cannot overflow here; nothing to do.
+        }
+        thread.join();
+    }
+    while (!connected.empty()) closeClient(connected.size() - 1);
+    if (epollFd >= 0) close(epollFd);
+    if (wakeFd >= 0) close(wakeFd);
+    if (listenFd >= 0) close(listenFd);
+    epollFd = wakeFd = listenFd = -1;
+    if (!socketPath.empty()) unlink(socketPath.c_str());
+    socketPath.clear();
+}
+
+void BroadcastServer::publish(const GameCore& core, const GameState& state) {
+    if (wakeFd < 0) return;
+    SpectatorFrame& frame = frames.back();
+    frame.capture(core, state);
+    frame.seq = ++nextSeq;
+    frames.publish();
+
+    // Only bumps a counter: never blocks, whatever the spectators do.
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0) {
+        // Counter saturated: the broadcaster is awake anyway.
+    }
+}
+
+void BroadcastServer::run() {
+    epoll_event events[16];
+    while (!stopping.load(std::memory_order_acquire)) {
+        int count = epoll_wait(epollFd, events, 16, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+            if (fd == wakeFd) {
+                uint64_t wakes;
+                if (read(wakeFd, &wakes, sizeof(wakes)) < 0) {
+                    // Spurious wakeup.
+                }
+                // Frames published since the last wakeup are skipped:
+                // only the newest one is encoded.
+                if (frames.update()) broadcast(frames.front());
+                continue;
+            }
+
+            size_t index = 0;
+            while (index < connected.size() && connected[index].fd != fd) ++index;
+            if (index == connected.size()) continue;
+
+            bool alive = !(events[i].events & (EPOLLERR | EPOLLHUP));
+            if (alive && (events[i].events & EPOLLIN)) {
+                // Spectators are read-only; whatever they send is dropped.
+                char scratch[256];
+                ssize_t n = recv(fd, scratch, sizeof(scratch), 0);
+                alive = n > 0 || (n < 0 && (errno == EAGAIN || errno == EINTR));
+            }
+            if (alive && (events[i].events & EPOLLOUT)) {
+                alive = flush(connected[index]);
+            }
+            if (!alive) closeClient(index);
+        }
+    }
+}
+
+void BroadcastServer::acceptClients() {
+    for (;;) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        if (static_cast<int>(connected.size()) >= MAX_CLIENTS) {
+            close(fd);
+            continue;
+        }
+
+        epoll_event event{};
+        event.events  = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            continue;
+        }
+        connected.emplace_back();
+        Client& client = connected.back();
+        client.fd = fd;
+        client.pending.reserve(CLIENT_BACKLOG + keyframe.capacity() + delta.capacity());
+        clients.store(static_cast<int>(connected.size()), std::memory_order_relaxed);
+
+        // The latest frame as a keyframe, if a game is already running.
+        if (!flush(client)) closeClient(connected.size() - 1);
+    }
+}
+
+void BroadcastServer::broadcast(const SpectatorFrame& frame) {
+    // Encoded once for every client: the changes since the last frame,
+    // and the keyframe only when a client asks for one.
+    encodeFrame(frame, haveLast ? &last : nullptr, delta);
+    last          = frame;
+    haveLast      = true;
+    keyframeReady = false;
+
+    size_t i = 0;
+    while (i < connected.size()) {
+        Client& client = connected[i];
+        // A client waiting for a keyframe gets it once its backlog drained.
+        if (!client.needKeyframe) queue(client, delta);
+        if (flush(client)) {
+            ++i;
+        } else {
+            closeClient(i);
+        }
+    }
+}
+
+void BroadcastServer::queue(Client& client, const std::string& message) {
+    client.pending += message;
+    if (client.pending.size() - client.sent > CLIENT_BACKLOG) dropBacklog(client);
+}
+
+const std::string& BroadcastServer::currentKeyframe() {
+    if (!keyframeReady) {
+        encodeFrame(last, nullptr, keyframe);
+        keyframeReady = true;
+    }
+    return keyframe;
+}
+
+bool BroadcastServer::flush(Client& client) {
+    for (;;) {
+        while (client.sent < client.pending.size()) {
+            ssize_t n = send(client.fd, client.pending.data() + client.sent,
+                             client.pending.size() - client.sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                client.sent += static_cast<size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                watch(client, true);
+                return true;
+            } else {
+                return false;
+            }
+        }
+        client.pending.clear();
+        client.sent = 0;
+
+        if (!client.needKeyframe || !haveLast) break;
+        client.pending += currentKeyframe();
+        client.needKeyframe = false;
+    }
+    watch(client, false);
+    return true;
+}
+
+void BroadcastServer::dropBacklog(Client& client) {
+    // Keep the message being written (the stream must stay whole), drop
+    // every queued one after it and resync from a keyframe.
+    size_t at = 0;
+    while (at < client.sent) {
+        const unsigned char* p =
+            reinterpret_cast<const unsigned char*>(client.pending.data() + at);
+        at += 4 + (p[0] | p[1] << 8 | p[2] << 16 | static_cast<size_t>(p[3]) << 24);
+    }
+    client.pending.resize(at);
+    client.needKeyframe = true;
+}
+
+void BroadcastServer::watch(Client& client, bool writing) {
+    if (client.writing == writing) return;
+    epoll_event event{};
+    event.events  = writing ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.fd = client.fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
+    client.writing = writing;
+}
+
+void BroadcastServer::closeClient(size_t index) {
+    Client& client = connected[index];
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, client.fd, nullptr);
+    close(client.fd);
+    if (index + 1 != connected.size()) std::swap(client, connected.back());
+    connected.pop_back();
+    clients.store(static_cast<int>(connected.size()), std::memory_order_relaxed);
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameCore.h"
+#include "GameState.h"
+#include "Mailbox.h"
+
+// What a spectator sees of one frame: the locked cells, the active piece
+// and the stats panel. The ghost is derived from these on the client.
+struct SpectatorFrame {
+    uint32_t seq{0};              // Frames published so far.
+    int      score{0};
+    int      level{1};
+    int      lines{0};
+    int      nextType{0};
+    Piece    piece;
+    bool     gameOver{false};
+    bool     paused{false};
+    char     cells[BOARD_HEIGHT][BOARD_WIDTH];
+
+    SpectatorFrame();
+    void capture(const GameCore& core, const GameState& state);
+};
+
+// Wire format. Every message is a little-endian u32 body length and the
+// body: a type byte, then seq u32, score i32, level i32, lines i32,
+// next u8, piece type u8, rotation u8, x i8, y i8, flags u8
+// (1 game over, 2 paused), then
+//   'K' keyframe: width u8, height u8 and every cell, row by row;
+//   'D' delta:    count u16 and (cell index u16, cell) per changed cell
+//                 since the previous message.
+// A client needs a keyframe first; after that every message applies to
+// the frame the previous one produced.
+void encodeFrame(const SpectatorFrame& frame, const SpectatorFrame* previous,
+                 std::string& out);
+
+// Apply one message body to `frame`. False on a malformed body or a delta
+// without a keyframe before it (`synced` tracks that).
+bool decodeFrame(const uint8_t* body, size_t size, SpectatorFrame& frame,
+                 bool& synced);
+
+// Listening and connecting sockets. Addresses are a Unix socket path
+// ("/tmp/tetris.sock", or "unix:" followed by one) or "tcp:PORT", which
+// binds and connects on 127.0.0.1 only. -1 with `error` set on failure.
+int listenOn(const std::string& address, std::string& error);
+int connectTo(const std::string& address, std::string& error);
+
+// Publishes the frames of a game to any number of read-only spectators.
+//
+// publish() is all the game thread does: copy the frame into a triple
+// buffer and bump an eventfd, neither of which can block or allocate. A
+// broadcaster thread waits on epoll for the eventfd, the listening socket
+// and the clients; it encodes each new frame once, as a delta and (only
+// when some client needs one) a keyframe, and appends the bytes to every
+// client's buffer, writing without blocking. A client whose backlog
+// exceeds CLIENT_BACKLOG loses its queued frames and resumes from the next
+// keyframe, so a slow spectator only ever falls behind itself.
+class BroadcastServer {
+public:
+    static constexpr size_t CLIENT_BACKLOG = 16 * 1024;  // Bytes per client.
+    static constexpr int    MAX_CLIENTS    = 64;
+
+    BroadcastServer() = default;
+    ~BroadcastServer();
+
+    BroadcastServer(const BroadcastServer&) = delete;
+    BroadcastServer& operator=(const BroadcastServer&) = delete;
+
+    // Listen on `address` and start the broadcaster thread.
+    bool start(const std::string& address, std::string& error);
+    void stop();
+
+    // Game thread: hand over this frame.
+    void publish(const GameCore& core, const GameState& state);
+
+    int clientCount() const { return clients.load(std::memory_order_relaxed); }
+
+private:
+    struct Client {
+        int         fd{-1};
+        std::string pending;          // Whole messages; `sent` bytes written.
+        size_t      sent{0};
+        bool        needKeyframe{true};
+        bool        writing{false};   // Waiting for EPOLLOUT.
+    };
+
+    TripleBuffer<SpectatorFrame> frames;
+    uint32_t          nextSeq{0};     // Game thread only.
+
+    std::thread       thread;
+    std::atomic<bool> stopping{false};
+    std::atomic<int>  clients{0};
+    int               listenFd{-1};
+    int               wakeFd{-1};     // eventfd: a frame or stop().
+    int               epollFd{-1};
+    std::string       socketPath;     // Unix socket to unlink on stop().
+
+    // Broadcaster thread only.
+    std::vector<Client> connected;
+    SpectatorFrame    last;           // Latest frame encoded.
+    bool              haveLast{false};
+    std::string       delta;          // Encoded once per frame.
+    std::string       keyframe;
+    bool              keyframeReady{false};
+
+    void run();
+    void acceptClients();
+    void broadcast(const SpectatorFrame& frame);
+    void queue(Client& client, const std::string& message);
+    const std::string& currentKeyframe();
+    bool flush(Client& client);
+    void dropBacklog(Client& client);
+    void watch(Client& client, bool writing);
+    void closeClient(size_t index);
+};
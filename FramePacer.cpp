@@ -0,0 +1,231 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+// Budget growth beyond which the link is treated as unlimited again.
+constexpr double UNLIMITED_RATE = 4.0 * 1024 * 1024;
+
+long long nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// FNV-1a of one frame line, salted by the color mode; never 0.
+uint64_t hashLine(const char* begin, const char* end, bool mono) {
+    uint64_t hash = mono ? 0x6A09E667F3BCC909ULL : 1469598103934665603ULL;
+    for (const char* p = begin; p != end; ++p) {
+        hash = (hash ^ static_cast<unsigned char>(*p)) * 1099511628211ULL;
+    }
+    return hash | 1;
+}
+
+// Length of the SGR escape ("\033[...m") at `p`, or 0.
+size_t sgrLength(const char* p, const char* end) {
+    if (end - p < 3 || p[0] != '\033' || p[1] != '[') return 0;
+    const char* q = p + 2;
+    while (q < end && ((*q >= '0' && *q <= '9') || *q == ';')) ++q;
+    return q < end && *q == 'm' ? static_cast<size_t>(q + 1 - p) : 0;
+}
+
+// Copy one line with its colors re-encoded. Board::render wraps every
+// cell in its color and a reset; only foreground colors are used, so a
+// reset can wait until the next visible character that is not a space,
+// and is dropped when the same color follows.
+void encodeLine(const char* p, const char* end, bool mono, std::string& out) {
+    const char* active       = nullptr;   // Color in effect, if any.
+    size_t      activeLength = 0;
+    bool        resetPending = false;
+    while (p < end) {
+        size_t length = sgrLength(p, end);
+        if (length > 0) {
+            bool reset = length == 3 || (length == 4 && p[2] == '0');
+            if (mono) {
+                // No colors at all.
+            } else if (reset) {
+                resetPending = active != nullptr;
+            } else if (active && length == activeLength &&
+                       std::memcmp(p, active, length) == 0) {
+                resetPending = false;
+            } else {
+                out.append(p, length);
+                active       = p;
+                activeLength = length;
+                resetPending = false;
+            }
+            p += length;
+            continue;
+        }
+        if (resetPending && *p != ' ') {
+            out += "\033[0m";
+            active       = nullptr;
+            resetPending = false;
+        }
+        out += *p++;
+    }
+    if (active) out += "\033[0m";
+}
+
+} // namespace
+
+void appendChangedLines(const std::string& frame, uint64_t hashes[FRAME_LINES],
+                        bool mono, std::string& out) {
+    const char* p   = frame.data();
+    const char* end = p + frame.size();
+    if (end - p >= 6 && std::memcmp(p, "\033[1;1H", 6) == 0) p += 6;
+
+    for (int line = 0; p < end; ++line) {
+        const char* eol = std::find(p, end, '\n');
+        uint64_t hash = hashLine(p, eol, mono);
+        if (line >= FRAME_LINES || hash != hashes[line]) {
+            if (line < FRAME_LINES) hashes[line] = hash;
+            out += "\033[";
+            appendInt(out, line + 1);
+            out += ";1H";
+            encodeLine(p, eol, mono, out);
+        }
+        p = eol == end ? end : eol + 1;
+    }
+}
+
+// \=== FramePacer ===
+
+FramePacer::~FramePacer() {
+    close();
+}
+
+void FramePacer::open(int fd) {
+    close();
+
+    // A description of our own: O_NONBLOCK on the shared one would also
+    // make the keyboard (the same terminal) non-blocking.
+    char path[32];
+    std::snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+    outFd  = ::open(path, O_WRONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+    ownsFd = outFd >= 0;
+    if (!ownsFd) outFd = fd;
+
+    out.clear();
+    out.reserve(16384);
+    sent         = 0;
+    mono         = false;
+    budgetRate   = 0.0;
+    credit       = 0.0;
+    lastRefill   = 0;
+    backlogged   = false;
+    invalidate();
+}
+
+void FramePacer::close() {
+    if (ownsFd) ::close(outFd);
+    outFd  = -1;
+    ownsFd = false;
+}
+
+void FramePacer::invalidate() {
+    std::fill(lineHash, lineHash + FRAME_LINES, 0);
+}
+
+void FramePacer::refill(long long now) {
+    if (lastRefill == 0) lastRefill = now;
+    double seconds = (now - lastRefill) / 1e6;
+    lastRefill = now;
+    if (budgetRate <= 0.0) return;
+
+    // Probe for a faster link while writes go through.
+    if (!backlogged) {
+        budgetRate *= 1.0 + 0.1 * seconds;
+        if (budgetRate > UNLIMITED_RATE) {
+            budgetRate = 0.0;
+            credit     = 0.0;
+            mono       = false;
+            return;
+        }
+    }
+    credit = std::min(credit + budgetRate * seconds, budgetRate * 0.25);
+
+    if (budgetRate < MONO_BELOW) {
+        mono = true;
+    } else if (budgetRate > 2 * MONO_BELOW) {
+        mono = false;
+    }
+}
+
+bool FramePacer::ready(long long now) {
+    refill(now);
+    return outFd >= 0 && sent == out.size() && (budgetRate <= 0.0 || credit >= 0.0);
+}
+
+void FramePacer::submit(const std::string& frame, long long now, const std::string* raw) {
+    out.clear();
+    sent = 0;
+    appendChangedLines(frame, lineHash, mono, out);
+    if (raw) out += *raw;
+    if (budgetRate > 0.0) credit -= static_cast<double>(out.size());
+    writeOut(now);
+}
+
+void FramePacer::writeOut(long long now) {
+    while (sent < out.size()) {
+        ssize_t n = ::write(outFd, out.data() + sent, out.size() - sent);
+        if (n > 0) {
+            sent += static_cast<size_t>(n);
+            if (backlogged) backlogSent += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && errno == EAGAIN) {
+            if (!backlogged) {
+                backlogged   = true;
+                backlogStart = now;
+                backlogSent  = 0;
+            }
+            return;
+        } else {
+            sent = out.size();   // The terminal is gone; drop the frame.
+        }
+    }
+
+    // What drained while the terminal was full is what the link carries.
+    if (backlogged) {
+        backlogged = false;
+        long long elapsed = now - backlogStart;
+        if (elapsed > 0 && backlogSent > 0) {
+            budgetRate = 0.8 * backlogSent * 1e6 / elapsed;
+            credit     = std::min(credit, 0.0);
+        }
+    }
+}
+
+void FramePacer::pump(long long now, long waitUs) {
+    long long deadline = now + waitUs;
+    while (sent < out.size()) {
+        long long left = deadline - now;
+        if (left > 0) {
+            pollfd ready{outFd, POLLOUT, 0};
+            timespec timeout{static_cast<time_t>(left / 1000000),
+                             static_cast<long>(left % 1000000) * 1000};
+            ppoll(&ready, 1, &timeout, nullptr);
+        }
+        now = nowUs();
+        writeOut(now);
+        if (now >= deadline) return;
+    }
+    if (deadline > now) usleep(static_cast<useconds_t>(deadline - now));
+}
+
+void FramePacer::drain() {
+    while (outFd >= 0 && sent < out.size()) {
+        pollfd ready{outFd, POLLOUT, 0};
+        poll(&ready, 1, -1);
+        writeOut(nowUs());
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Board.h"
+
+// Lines of the game frame (Board::render): borders, title, the playfield
+// rows and the controls line.
+constexpr int FRAME_LINES = BOARD_HEIGHT + 5;
+
+// Append the lines of `frame` (a Board::render frame) whose hash differs
+// from `hashes`, each behind a cursor move to its row, and update the
+// hashes. A hash of 0 means the line is not on screen. Color escapes are
+// coalesced (one per run of same-colored cells) or, with `mono`, dropped;
+// a line drawn in the other mode counts as changed.
+void appendChangedLines(const std::string& frame, uint64_t hashes[FRAME_LINES],
+                        bool mono, std::string& out);
+
+// Writes game frames to the terminal without ever blocking the game loop,
+// adapting to how fast the terminal (or the SSH link behind it) drains.
+//
+// Output goes through a non-blocking descriptor of its own, and only the
+// lines that changed since the last frame are sent. While a frame is still
+// being written, ready() is false and the game skips drawing, so the next
+// frame drawn is always the newest state. A write that backs up measures
+// the link: the byte budget drops to 80% of the rate achieved and then
+// creeps back up 10% a second, so frames get rarer on a slow link instead
+// of queueing up in buffers the game cannot see. Below MONO_BELOW bytes a
+// second frames are sent without colors.
+class FramePacer {
+public:
+    static constexpr double MONO_BELOW = 12500.0;   // Bytes/s, 100 kbit/s.
+
+    FramePacer() = default;
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // Write to a non-blocking reopening of `fd` (blocking `fd` itself when
+    // it cannot be reopened, e.g. a socket).
+    void open(int fd);
+    void close();
+
+    // A frame may be submitted: the last one is written and the budget
+    // allows another.
+    bool ready(long long nowUs);
+
+    // Send `frame` (a Board::render frame), followed by `raw` escapes
+    // written as they are (e.g. TileCompositor output).
+    void submit(const std::string& frame, long long nowUs,
+                const std::string* raw = nullptr);
+
+    // Keep writing the frame in flight, for up to `waitUs` (0 = what can
+    // be written right now). The rest of `waitUs` is slept.
+    void pump(long long nowUs, long waitUs = 0);
+
+    // Block until the frame in flight is written, before other output.
+    void drain();
+
+    // The screen was cleared: the next frame is sent whole.
+    void invalidate();
+
+    double budget() const { return budgetRate; }   // Bytes/s, 0 = unlimited.
+    bool   isMono() const { return mono; }
+
+private:
+    int         outFd{-1};
+    bool        ownsFd{false};
+    std::string out;                  // Bytes of the frame in flight.
+    size_t      sent{0};
+    uint64_t    lineHash[FRAME_LINES]{};
+
+    bool        mono{false};
+    double      budgetRate{0.0};      // 0 until a write first backs up.
+    double      credit{0.0};          // Bytes the budget allows now.
+    long long   lastRefill{0};
+
+    bool        backlogged{false};    // The frame in flight hit EAGAIN.
+    long long   backlogStart{0};
+    size_t      backlogSent{0};
+
+    void refill(long long nowUs);
+    void writeOut(long long nowUs);
+};
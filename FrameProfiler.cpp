@@ -0,0 +1,315 @@
+#include "FrameProfiler.h"
+
+#include "Board.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+const char* framePhaseName(FramePhase phase) {
+    static const char* const NAMES[] = {
+        "INP", "BOT", "GRV", "CMP", "DRW", "SLP"
+    };
+    int index = static_cast<int>(phase);
+    return index >= 0 && index < static_cast<int>(FramePhase::Count)
+               ? NAMES[index] : "?";
+}
+
+const char* framePhaseTraceName(FramePhase phase) {
+    static const char* const NAMES[] = {
+        "handleInput", "handleAutoPlay", "handleGravity", "composeFrame",
+        "draw", "sleep"
+    };
+    int index = static_cast<int>(phase);
+    return index >= 0 && index < static_cast<int>(FramePhase::Count)
+               ? NAMES[index] : "?";
+}
+
+// \=== HeapStats ===
+
+namespace {
+
+// Constant-initialized, so usable by operator new before main().
+std::atomic<uint64_t> heapAllocations[HEAP_SLOTS];
+std::atomic<uint64_t> heapFrees[HEAP_SLOTS];
+std::atomic<uint64_t> heapBytes[HEAP_SLOTS];
+std::atomic<int64_t>  heapLive{0};
+std::atomic<int64_t>  heapPeak{0};
+thread_local int      heapSlot = HEAP_OUTSIDE;
+
+int64_t blockSize(void* block) {
+#ifdef __APPLE__
+    return static_cast<int64_t>(malloc_size(block));
+#else
+    return static_cast<int64_t>(malloc_usable_size(block));
+#endif
+}
+
+} // namespace
+
+void HeapStats::recordAlloc(void* block) {
+    int64_t size = blockSize(block);
+    heapAllocations[heapSlot].fetch_add(1, std::memory_order_relaxed);
+    heapBytes[heapSlot].fetch_add(static_cast<uint64_t>(size), std::memory_order_relaxed);
+
+    int64_t live = heapLive.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t peak = heapPeak.load(std::memory_order_relaxed);
+    while (live > peak &&
+           !heapPeak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void HeapStats::recordFree(void* block) {
+    if (!block) return;
+    heapFrees[heapSlot].fetch_add(1, std::memory_order_relaxed);
+    heapLive.fetch_sub(blockSize(block), std::memory_order_relaxed);
+}
+
+int HeapStats::enter(int slot) {
+    int previous = heapSlot;
+    heapSlot = slot;
+    return previous;
+}
+
+HeapCounts HeapStats::counts(int slot) {
+    HeapCounts counts;
+    counts.allocations = heapAllocations[slot].load(std::memory_order_relaxed);
+    counts.frees       = heapFrees[slot].load(std::memory_order_relaxed);
+    counts.bytes       = heapBytes[slot].load(std::memory_order_relaxed);
+    return counts;
+}
+
+HeapCounts HeapStats::total() {
+    HeapCounts sum;
+    for (int slot = 0; slot < HEAP_SLOTS; ++slot) {
+        HeapCounts c = counts(slot);
+        sum.allocations += c.allocations;
+        sum.frees       += c.frees;
+        sum.bytes       += c.bytes;
+    }
+    return sum;
+}
+
+int64_t HeapStats::liveBytes() {
+    return heapLive.load(std::memory_order_relaxed);
+}
+
+int64_t HeapStats::peakBytes() {
+    return heapPeak.load(std::memory_order_relaxed);
+}
+
+// \=== LatencyHistogram ===
+
+int LatencyHistogram::bucketOf(uint64_t ns) {
+    const uint64_t limit = (1ULL << MAX_BITS) - 1;
+    if (ns > limit) ns = limit;
+    if (ns < (1ULL << SUB_BITS)) return static_cast<int>(ns);
+
+    // Bucket group by magnitude, then the SUB_BITS bits below the top one.
+    int top   = 63 - __builtin_clzll(ns);
+    int shift = top - SUB_BITS;
+    return ((shift + 1) << SUB_BITS) +
+           static_cast<int>((ns >> shift) - (1ULL << SUB_BITS));
+}
+
+uint64_t LatencyHistogram::bucketLow(int bucket) {
+    int group = bucket >> SUB_BITS;
+    int sub   = bucket & ((1 << SUB_BITS) - 1);
+    if (group == 0) return static_cast<uint64_t>(sub);
+    return static_cast<uint64_t>(sub + (1 << SUB_BITS)) << (group - 1);
+}
+
+uint64_t LatencyHistogram::bucketHigh(int bucket) {
+    int group = bucket >> SUB_BITS;
+    return bucketLow(bucket) + (group == 0 ? 0 : (1ULL << (group - 1)) - 1);
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    ++counts[bucketOf(ns)];
+    ++total;
+    sum += ns;
+    if (ns < minValue) minValue = ns;
+    if (ns > maxValue) maxValue = ns;
+}
+
+void LatencyHistogram::clear() {
+    *this = LatencyHistogram();
+}
+
+uint64_t LatencyHistogram::quantile(double q) const {
+    if (total == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(q * total + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > total) rank = total;
+
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += counts[b];
+        if (seen >= rank) {
+            uint64_t high = bucketHigh(b);
+            return high < maxValue ? high : maxValue;
+        }
+    }
+    return maxValue;
+}
+
+namespace {
+
+// Microseconds in at most four characters: "0.4", "12", "3400", "15k".
+std::string shortMicros(uint64_t ns) {
+    char text[16];
+    double us = ns / 1000.0;
+    if (us < 9.95) {
+        std::snprintf(text, sizeof(text), "%.1f", us);
+    } else if (us < 9999.5) {
+        std::snprintf(text, sizeof(text), "%.0f", us);
+    } else {
+        std::snprintf(text, sizeof(text), "%.0fk", us / 1000.0);
+    }
+    return text;
+}
+
+// Bytes in at most four characters: "96B", "1.2K", "340K", "12M".
+std::string shortBytes(int64_t bytes) {
+    char text[24];
+    if (bytes < 1000) {
+        std::snprintf(text, sizeof(text), "%lldB", static_cast<long long>(bytes));
+    } else if (bytes < 9950) {
+        std::snprintf(text, sizeof(text), "%.1fK", bytes / 1024.0);
+    } else if (bytes < 999500) {
+        std::snprintf(text, sizeof(text), "%.0fK", bytes / 1024.0);
+    } else {
+        std::snprintf(text, sizeof(text), "%.0fM", bytes / (1024.0 * 1024.0));
+    }
+    return text;
+}
+
+} // namespace
+
+void FrameProfiler::endFrame() {
+    ++frames;
+    for (int slot = 0; slot < HEAP_SLOTS; ++slot) {
+        HeapCounts now = HeapStats::counts(slot);
+        HeapCounts& frame = heapFrame[slot];
+        frame.allocations = now.allocations - heapSeen[slot].allocations;
+        frame.frees       = now.frees - heapSeen[slot].frees;
+        frame.bytes       = now.bytes - heapSeen[slot].bytes;
+        heapSeen[slot]    = now;
+
+        if (frame.allocations > 0) ++heapFramesAllocating[slot];
+        if (frame.allocations > heapMostInFrame[slot]) {
+            heapMostInFrame[slot] = frame.allocations;
+        }
+    }
+}
+
+void FrameProfiler::heapHudLines(std::vector<std::string>& out) const {
+    // The phases run() always goes through; the rest are summed as OTH.
+    static const FramePhase SHOWN[] = {
+        FramePhase::Input, FramePhase::Gravity, FramePhase::Compose, FramePhase::Draw
+    };
+    const int shown = 4;
+
+    out.resize(shown + 3);
+    HeapCounts other = heapFrame[HEAP_OUTSIDE];
+    for (int i = 0; i < static_cast<int>(FramePhase::Count); ++i) {
+        const FramePhase* end = SHOWN + shown;
+        if (std::find(SHOWN, end, static_cast<FramePhase>(i)) != end) continue;
+        other.allocations += heapFrame[i].allocations;
+        other.bytes       += heapFrame[i].bytes;
+    }
+
+    for (int i = 0; i <= shown; ++i) {
+        const HeapCounts& c = i < shown ? heapFrame[static_cast<int>(SHOWN[i])] : other;
+        std::string& line = out[i];
+        line  = i < shown ? framePhaseName(SHOWN[i]) : "OTH";
+        line += ' ';
+        appendInt(line, static_cast<long>(c.allocations));
+        line += ' ';
+        line += shortBytes(static_cast<int64_t>(c.bytes));
+        line.resize(13, ' ');
+    }
+    out[shown + 1] = "LIVE " + shortBytes(HeapStats::liveBytes());
+    out[shown + 2] = "PEAK " + shortBytes(HeapStats::peakBytes());
+    out[shown + 1].resize(13, ' ');
+    out[shown + 2].resize(13, ' ');
+}
+
+void FrameProfiler::hudLines(std::vector<std::string>& out) const {
+    out.resize(static_cast<int>(FramePhase::Count));
+    for (int i = 0; i < static_cast<int>(FramePhase::Count); ++i) {
+        const LatencyHistogram& h = phases[i];
+        std::string& line = out[i];
+        line  = framePhaseName(static_cast<FramePhase>(i));
+        line += ' ';
+        line += shortMicros(h.quantile(0.50));
+        line += '/';
+        line += shortMicros(h.quantile(0.99));
+        line.resize(13, ' ');
+    }
+}
+
+bool FrameProfiler::writeReport(const std::string& path) const {
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    std::fprintf(out, "# Frame phase timings in nanoseconds.\n");
+    std::fprintf(out, "# %-5s %10s %10s %10s %10s %10s %10s %10s %12s\n",
+                 "phase", "count", "min", "mean", "p50", "p90", "p99", "p99.9",
+                 "max");
+    for (int i = 0; i < static_cast<int>(FramePhase::Count); ++i) {
+        const LatencyHistogram& h = phases[i];
+        std::fprintf(out, "  %-5s %10llu %10llu %10.0f %10llu %10llu %10llu %10llu %12llu\n",
+                     framePhaseName(static_cast<FramePhase>(i)),
+                     static_cast<unsigned long long>(h.count()),
+                     static_cast<unsigned long long>(h.min()), h.mean(),
+                     static_cast<unsigned long long>(h.quantile(0.50)),
+                     static_cast<unsigned long long>(h.quantile(0.90)),
+                     static_cast<unsigned long long>(h.quantile(0.99)),
+                     static_cast<unsigned long long>(h.quantile(0.999)),
+                     static_cast<unsigned long long>(h.max()));
+    }
+
+    // Full distributions: one "low high count" line per non-empty bucket.
+    for (int i = 0; i < static_cast<int>(FramePhase::Count); ++i) {
+        const LatencyHistogram& h = phases[i];
+        std::fprintf(out, "\nhistogram %s\n", framePhaseName(static_cast<FramePhase>(i)));
+        for (int b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+            if (h.bucketCount(b) == 0) continue;
+            std::fprintf(out, "%llu %llu %llu\n",
+                         static_cast<unsigned long long>(LatencyHistogram::bucketLow(b)),
+                         static_cast<unsigned long long>(LatencyHistogram::bucketHigh(b)),
+                         static_cast<unsigned long long>(h.bucketCount(b)));
+        }
+    }
+
+    // Heap use: totals, per frame, and in how many frames each phase
+    // allocated at all (0 for a phase that must not allocate).
+    std::fprintf(out, "\n# Heap use per phase over %llu frames (bytes as reserved by malloc).\n",
+                 static_cast<unsigned long long>(frames));
+    std::fprintf(out, "# %-5s %12s %12s %14s %10s %10s %10s\n", "phase", "allocs",
+                 "frees", "bytes", "allocs/fr", "max/fr", "frames");
+    for (int slot = 0; slot < HEAP_SLOTS; ++slot) {
+        HeapCounts c = HeapStats::counts(slot);
+        std::fprintf(out, "  %-5s %12llu %12llu %14llu %10.2f %10llu %10llu\n",
+                     slot == HEAP_OUTSIDE ? "OUT" : framePhaseName(static_cast<FramePhase>(slot)),
+                     static_cast<unsigned long long>(c.allocations),
+                     static_cast<unsigned long long>(c.frees),
+                     static_cast<unsigned long long>(c.bytes),
+                     frames ? static_cast<double>(c.allocations) / frames : 0.0,
+                     static_cast<unsigned long long>(heapMostInFrame[slot]),
+                     static_cast<unsigned long long>(heapFramesAllocating[slot]));
+    }
+    std::fprintf(out, "live %lld\npeak %lld\n",
+                 static_cast<long long>(HeapStats::liveBytes()),
+                 static_cast<long long>(HeapStats::peakBytes()));
+
+    bool ok = !std::ferror(out);
+    return std::fclose(out) == 0 && ok;
+}
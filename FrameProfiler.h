@@ -0,0 +1,173 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Trace.h"
+
+// Phases of one frame of TetrisGame::run().
+enum class FramePhase {
+    Input,     // handleInput()
+    Bot,       // handleAutoPlay()
+    Gravity,   // handleGravity()
+    Compose,   // composeFrame(): ghost piece and active piece.
+    Draw,      // Preview, effects and Board::render().
+    Sleep,     // Frame pacing usleep().
+    Count
+};
+
+// Short name of a phase ("INP", "DRW", ...) for the HUD and reports.
+const char* framePhaseName(FramePhase phase);
+
+// Span name of a phase in traces ("handleInput", "draw", ...).
+const char* framePhaseTraceName(FramePhase phase);
+
+// Heap use by phase, counted by a replacement operator new/delete that
+// calls recordAlloc() and recordFree() (the game built with FRAME_PROFILE,
+// and bench). An allocation is charged to the phase its thread is in, or
+// to HEAP_OUTSIDE outside any phase and on threads that never enter one.
+// Bytes are what malloc reserved for the block (malloc_usable_size).
+constexpr int HEAP_OUTSIDE = static_cast<int>(FramePhase::Count);
+constexpr int HEAP_SLOTS   = HEAP_OUTSIDE + 1;
+
+struct HeapCounts {
+    uint64_t allocations{0};
+    uint64_t frees{0};
+    uint64_t bytes{0};                // Allocated, freed blocks included.
+};
+
+class HeapStats {
+public:
+    static void recordAlloc(void* block);
+    static void recordFree(void* block);
+
+    // Charge this thread's allocations to `slot` from now on; returns the
+    // slot it was charged to before.
+    static int enter(int slot);
+
+    static HeapCounts counts(int slot);
+    static HeapCounts total();
+    static int64_t    liveBytes();
+    static int64_t    peakBytes();
+};
+
+// Log-linear histogram of nanosecond durations in the style of
+// HdrHistogram: values below 2^SUB_BITS are exact, above that every power
+// of two is split into 2^SUB_BITS equal buckets, so any recorded value is
+// known to within 1 / 2^SUB_BITS (about 3%). record() is a few
+// instructions and the memory is fixed.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS    = 5;
+    static constexpr int MAX_BITS    = 40;   // Up to ~18 minutes.
+    static constexpr int BUCKETS     = (MAX_BITS - SUB_BITS + 1) << SUB_BITS;
+
+    void record(uint64_t ns);
+    void clear();
+
+    uint64_t count() const { return total; }
+    uint64_t min() const   { return total ? minValue : 0; }
+    uint64_t max() const   { return maxValue; }
+    double   mean() const  { return total ? static_cast<double>(sum) / total : 0.0; }
+
+    // Smallest bucket edge with at least q of the values at or below it.
+    uint64_t quantile(double q) const;
+
+    // Bucket of a value, and the range [low, high] a bucket covers.
+    static int      bucketOf(uint64_t ns);
+    static uint64_t bucketLow(int bucket);
+    static uint64_t bucketHigh(int bucket);
+
+    uint64_t bucketCount(int bucket) const { return counts[bucket]; }
+
+private:
+    uint64_t counts[BUCKETS]{};
+    uint64_t total{0};
+    uint64_t sum{0};
+    uint64_t minValue{~0ULL};
+    uint64_t maxValue{0};
+};
+
+// One histogram per frame phase, and optionally a trace span per phase.
+class FrameProfiler {
+public:
+    void record(FramePhase phase, uint64_t ns) {
+        phases[static_cast<int>(phase)].record(ns);
+    }
+
+    // Also emit every timed phase as a span into `buffer` (nullptr: off).
+    void setTrace(TraceBuffer* buffer) { traceBuffer = buffer; }
+    TraceBuffer* trace() const { return traceBuffer; }
+
+    const LatencyHistogram& histogram(FramePhase phase) const {
+        return phases[static_cast<int>(phase)];
+    }
+
+    // One 13-column row per phase, "DRW 42/180", p50/p99 in microseconds.
+    void hudLines(std::vector<std::string>& out) const;
+
+    // End of a frame: the heap use of each phase since the last call.
+    void endFrame();
+
+    // Allocations and bytes of the last frame in the input, gravity,
+    // ghost and draw phases and everything else ("DRW 2 96B"), then the
+    // live and peak heap; 13 columns each.
+    void heapHudLines(std::vector<std::string>& out) const;
+
+    // Summary and every non-empty bucket of each phase, then the heap use
+    // of each phase; false on I/O error.
+    bool writeReport(const std::string& path) const;
+
+private:
+    LatencyHistogram phases[static_cast<int>(FramePhase::Count)];
+    TraceBuffer*     traceBuffer{nullptr};
+
+    uint64_t   frames{0};
+    HeapCounts heapSeen[HEAP_SLOTS];        // Totals at the last endFrame().
+    HeapCounts heapFrame[HEAP_SLOTS];       // Use during the last frame.
+    uint64_t   heapMostInFrame[HEAP_SLOTS]{};   // Allocations, worst frame.
+    uint64_t   heapFramesAllocating[HEAP_SLOTS]{};
+};
+
+// Times its own lifetime into one phase of a profiler, and charges the
+// heap use of the thread meanwhile to that phase.
+class PhaseTimer {
+public:
+    PhaseTimer(FrameProfiler& profiler, FramePhase phase)
+        : profiler(profiler), phase(phase),
+          heapSlot(HeapStats::enter(static_cast<int>(phase))),
+          start(std::chrono::steady_clock::now()) {}
+
+    ~PhaseTimer() {
+        HeapStats::enter(heapSlot);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        profiler.record(phase, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        if (TraceBuffer* trace = profiler.trace()) {
+            trace->span(framePhaseTraceName(phase), "phase", start, end);
+        }
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    FrameProfiler&                        profiler;
+    FramePhase                            phase;
+    int                                   heapSlot;   // Slot to return to.
+    std::chrono::steady_clock::time_point start;
+};
+
+// PROFILE_PHASE(profiler, Draw) times the rest of the enclosing scope.
+// Frame timing is built with -DFRAME_PROFILE (make PROFILE=1); otherwise
+// the macro expands to nothing and the game carries no timing code.
+#ifdef FRAME_PROFILE
+#define PROFILE_PHASE_JOIN2(a, b) a##b
+#define PROFILE_PHASE_JOIN(a, b)  PROFILE_PHASE_JOIN2(a, b)
+#define PROFILE_PHASE(profiler, phase) \
+    PhaseTimer PROFILE_PHASE_JOIN(phaseTimer, __LINE__)(profiler, FramePhase::phase)
+#else
+#define PROFILE_PHASE(profiler, phase) ((void)0)
+#endif
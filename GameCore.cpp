@@ -0,0 +1,443 @@
+#include "GameCore.h"
+#include "BlockTemplate.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+
+namespace {
+
+// How overlayPiece() writes the cells of a piece.
+enum class Overlay { Over, Empty, Ghost };
+
+// Write the cells of `piece` inside the board: over anything, only into
+// empty cells, or as the ghost dot into empty cells.
+template <int W, int H>
+void overlayPiece(BasicBoard<W, H>& board, const Piece& piece, Overlay mode) {
+    for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
+        for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
+            char cell = BlockTemplate::getCell(piece.type, piece.rotation, row, col);
+            int  x    = piece.pos.x + col;
+            int  y    = piece.pos.y + row;
+            if (cell == ' ' || x < 0 || x >= W || y < 0 || y >= H) continue;
+
+            char& target = board.grid[y][x];
+            if (mode == Overlay::Over) {
+                target = cell;
+            } else if (target == ' ') {
+                target = mode == Overlay::Ghost ? '.' : cell;
+            }
+        }
+    }
+}
+
+} // namespace
+
+template <int W, int H>
+BasicGameCore<W, H>::BasicGameCore(uint32_t seed, RandomizerMode mode) {
+    // Templates are static tables; filling them again is harmless.
+    BlockTemplate::initializeTemplates();
+    reset(seed, mode);
+}
+
+template <int W, int H>
+void BasicGameCore<W, H>::reset(uint32_t seed) {
+    reset(seed, randomizer.getMode());
+}
+
+template <int W, int H>
+void BasicGameCore<W, H>::reset(uint32_t seed, RandomizerMode mode) {
+    randomizer.reset(seed, mode);
+
+    board.init();
+    score        = 0;
+    level        = 1;
+    linesCleared = 0;
+    piecesPlaced = 0;
+    tickCount    = 0;
+    dropCounter  = 0;
+    gameOver     = false;
+    garbageBatches = 0;
+    pendingGarbage = 0;
+
+    spawnNewPiece();
+}
+
+template <int W, int H>
+void BasicGameCore<W, H>::setPosition(const BoardType& newBoard, const Piece& piece) {
+    board = newBoard;
+    board.recomputeHash();
+    currentPiece = piece;
+    dropCounter  = 0;
+    gameOver     = !canPlace(piece);
+}
+
+template <int W, int H>
+void BasicGameCore<W, H>::queueGarbage(int rows, int hole) {
+    rows = std::min(rows, H - pendingGarbage);
+    if (rows <= 0) return;
+
+    pendingGarbage += rows;
+    if (garbageBatches < MAX_GARBAGE_BATCHES) {
+        garbage[garbageBatches].rows = static_cast<int16_t>(rows);
+        garbage[garbageBatches].hole = static_cast<int16_t>(hole);
+        ++garbageBatches;
+    } else {
+        GarbageBatch& last = garbage[MAX_GARBAGE_BATCHES - 1];
+        last.rows = static_cast<int16_t>(last.rows + rows);
+    }
+}
+
+template <int W, int H>
+std::vector<int> BasicGameCore<W, H>::pieceSequence(uint32_t seed, int count,
+                                                   RandomizerMode mode) {
+    // Same draws as reset() followed by one per spawn.
+    Randomizer sequence(seed, mode);
+    std::vector<int> types;
+    for (int i = 0; i < count; ++i) {
+        types.push_back(sequence.next());
+    }
+    return types;
+}
+
+template <int W, int H>
+long BasicGameCore<W, H>::computeDropSpeedUs(int level) {
+    // Drop speed by level.
+    if (level <= 3) {          // Slow early levels
+        return BASE_DROP_SPEED_US; // 0.50s per tick group
+    } else if (level <= 6) {   // Medium
+        return 300000;         // 0.30s
+    } else if (level <= 9) {   // Fast
+        return 150000;         // 0.15s
+    } else {                   // Very fast for 10+
+        return 80000;          // 0.08s
+    }
+}
+
+template <int W, int H>
+uint64_t BasicGameCore<W, H>::hash() const {
+    // Boards beyond the Zobrist tables are not hashed.
+    if (!BoardType::HASHED) return 0;
+
+    return board.hash ^
+           Zobrist::activePiece(currentPiece.type, currentPiece.rotation,
+                                currentPiece.pos.x, currentPiece.pos.y) ^
+           Zobrist::nextPiece(randomizer.peek(0));
+}
+
+template <int W, int H>
+bool BasicGameCore<W, H>::canPlace(const Piece& piece) const {
+    return canPlace(board, piece);
+}
+
+template <int W, int H>
+bool BasicGameCore<W, H>::canPlace(const BoardType& board, const Piece& piece) {
+    for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
+        for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
+            char cell = BlockTemplate::getCell(
+                piece.type, piece.rotation, row, col
+            );
+            if (cell == ' ') continue;
+
+            int xt = piece.pos.x + col;
+            int yt = piece.pos.y + row;
+
+            if (xt < 0 || xt >= W)   return false;
+            if (yt >= H)             return false;
+
+            // Rows above the top edge are open space.
+            if (yt >= 0 && board.grid[yt][xt] != ' ') {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <int W, int H>
+bool BasicGameCore<W, H>::canMove(int dx, int dy, int newRotation) const {
+    Piece moved = currentPiece;
+    moved.pos.x   += dx;
+    moved.pos.y   += dy;
+    moved.rotation = newRotation;
+    return canPlace(moved);
+}
+
+template <int W, int H>
+Piece BasicGameCore<W, H>::calculateGhostPiece() const {
+    // Drop a copy of the active piece until it collides.
+    Piece ghost = currentPiece;
+    Piece below = ghost;
+    ++below.pos.y;
+
+    while (canPlace(below)) {
+        ghost = below;
+        ++below.pos.y;
+    }
+    return ghost;
+}
+
+template <int W, int H>
+void BasicGameCore<W, H>::spawnNewPiece() {
+    Piece spawn;
+    spawn.type      = randomizer.next();
+    spawn.rotation  = 0;
+    int spawnX      = (W / 2) - (BlockTemplate::BLOCK_SIZE / 2);
+    spawn.pos       = Position(spawnX, SPAWN_Y);
+
+    currentPiece = spawn;
+
+    if (!canPlace(spawn)) {
+        // The new piece cannot appear: the game is over.
+        gameOver = true;
+    }
+}
+
+template <int W, int H>
+void BasicGameCore<W, H>::lockPiece(LockResult& result) {
+    // Write the active piece into the board.
+    for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
+        for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
+            char cell = BlockTemplate::getCell(
+                currentPiece.type, currentPiece.rotation, row, col
+            );
+            if (cell == ' ') continue;
+
+            int xt = currentPiece.pos.x + col;
+            int yt = currentPiece.pos.y + row;
+
+            if (yt < 0) continue;
+            board.setCell(xt, yt, cell);
+        }
+    }
+
+    result.locked    = true;
+    result.pieceType = currentPiece.type;
+    ++piecesPlaced;
+
+    // Only the piece's own rows can have been completed by it.
+    result.clearedTop = currentPiece.pos.y;
+    for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
+        int y = currentPiece.pos.y + row;
+        if (y >= 0 && y < H && board.rowBits[y] == BoardType::FULL_ROW) {
+            result.clearedRows |= static_cast<uint8_t>(1u << row);
+        }
+    }
+
+    int lines = board.clearLines();
+    if (lines > 0) {
+        linesCleared += lines;
+
+        // Base points multiplied by the current level.
+        static const int SCORES[] = {0, 100, 300, 500, 800};
+        result.linesCleared = lines;
+        result.scoreDelta   = SCORES[lines] * level;
+        score += result.scoreDelta;
+
+        int oldLevel = level;
+
+        // +1 level per LINES_PER_LEVEL lines
+        level = 1 + (linesCleared / LINES_PER_LEVEL);
+        result.leveledUp = level > oldLevel;
+    }
+
+    // Garbage rows a clear sends in versus play; they first cancel the
+    // oldest rows queued against this board.
+    static const int ATTACK[] = {0, 0, 1, 2, 4};
+    int attack = ATTACK[lines];
+    int batch  = 0;
+    while (attack > 0 && batch < garbageBatches) {
+        int cancel = std::min(attack, static_cast<int>(garbage[batch].rows));
+        garbage[batch].rows = static_cast<int16_t>(garbage[batch].rows - cancel);
+        pendingGarbage -= cancel;
+        attack         -= cancel;
+        if (garbage[batch].rows == 0) ++batch;
+    }
+    result.garbageSent = attack;
+
+    // The rest rises now.
+    for (; batch < garbageBatches; ++batch) {
+        if (!board.addGarbage(garbage[batch].rows, garbage[batch].hole)) {
+            gameOver = true;
+        }
+        result.garbageReceived += garbage[batch].rows;
+    }
+    garbageBatches = 0;
+    pendingGarbage = 0;
+
+    dropCounter = 0;
+    spawnNewPiece();
+    result.gameOver = gameOver;
+}
+
+template <int W, int H>
+void BasicGameCore<W, H>::softDrop(StepResult& result) {
+    if (canMove(0, 1, currentPiece.rotation)) {
+        ++currentPiece.pos.y;
+        result.moved = true;
+        return;
+    }
+
+    // A piece stuck above the top edge ends the game without locking.
+    if (currentPiece.pos.y < 0) {
+        gameOver = true;
+        result.lock.gameOver = true;
+        return;
+    }
+    lockPiece(result.lock);
+}
+
+template <int W, int H>
+void BasicGameCore<W, H>::hardDrop(StepResult& result) {
+    while (canMove(0, 1, currentPiece.rotation)) {
+        ++currentPiece.pos.y;
+        result.moved = true;
+    }
+
+    if (currentPiece.pos.y < 0) {
+        gameOver = true;
+        result.lock.gameOver = true;
+        return;
+    }
+    lockPiece(result.lock);
+}
+
+template <int W, int H>
+bool BasicGameCore<W, H>::rotate() {
+    // Rotate clockwise, trying horizontal kicks in order.
+    int newRot = (currentPiece.rotation + 1) % 4;
+    static const int KICKS[] = {0, -1, 1, -2, 2, -3, 3};
+    for (int dx : KICKS) {
+        if (canMove(dx, 0, newRot)) {
+            currentPiece.pos.x += dx;
+            currentPiece.rotation = newRot;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <int W, int H>
+StepResult BasicGameCore<W, H>::step(GameAction action) {
+    StepResult result;
+    if (gameOver) return result;
+
+    switch (action) {
+        case GameAction::MoveLeft:
+            if (canMove(-1, 0, currentPiece.rotation)) {
+                --currentPiece.pos.x;
+                result.moved = true;
+            }
+            break;
+        case GameAction::MoveRight:
+            if (canMove(1, 0, currentPiece.rotation)) {
+                ++currentPiece.pos.x;
+                result.moved = true;
+            }
+            break;
+        case GameAction::Rotate:
+            result.moved = rotate();
+            break;
+        case GameAction::SoftDrop:
+            softDrop(result);
+            break;
+        case GameAction::HardDrop:
+            hardDrop(result);
+            break;
+        case GameAction::None:
+            break;
+    }
+    return result;
+}
+
+template <int W, int H>
+StepResult BasicGameCore<W, H>::tick() {
+    StepResult result;
+    if (gameOver) return result;
+
+    ++tickCount;
+    ++dropCounter;
+
+    // The piece falls one row every DROP_INTERVAL_TICKS ticks.
+    if (dropCounter < DROP_INTERVAL_TICKS) {
+        return result;
+    }
+    dropCounter = 0;
+
+    if (canMove(0, 1, currentPiece.rotation)) {
+        ++currentPiece.pos.y;
+        result.moved = true;
+        return result;
+    }
+
+    if (currentPiece.pos.y < 0) {
+        gameOver = true;
+        result.lock.gameOver = true;
+        return result;
+    }
+    lockPiece(result.lock);
+    return result;
+}
+
+template <int W, int H>
+StepResult BasicGameCore<W, H>::tick(int ticks) {
+    if (gameOver) return StepResult();
+
+    // The ticks before the last one only advance the counters.
+    tickCount   += ticks - 1;
+    dropCounter += ticks - 1;
+    return tick();
+}
+
+template class BasicGameCore<10, 20>;
+template class BasicGameCore<10, 40>;
+template class BasicGameCore<15, 20>;
+template class BasicGameCore<64, 128>;
+
+template <int W, int H>
+void composeBoard(BasicBoard<W, H>& board, const Piece& piece, bool ghost) {
+    if (ghost) {
+        Piece landing = piece;
+        Piece below   = piece;
+        ++below.pos.y;
+        while (BasicGameCore<W, H>::canPlace(board, below)) {
+            landing = below;
+            ++below.pos.y;
+        }
+        if (landing.pos.y != piece.pos.y) overlayPiece(board, landing, Overlay::Ghost);
+    }
+    overlayPiece(board, piece, Overlay::Over);
+}
+
+template <int W, int H>
+void composeBoard(const BasicGameCore<W, H>& core, BasicBoard<W, H>& out,
+                  bool ghost) {
+    out = core.getBoard();
+    composeBoard(out, core.getCurrentPiece(), ghost);
+}
+
+template <int W, int H>
+void composeEndingBoard(const BasicGameCore<W, H>& core, BasicBoard<W, H>& out) {
+    out = core.getBoard();
+    overlayPiece(out, core.getCurrentPiece(), Overlay::Empty);
+}
+
+template void composeBoard(BasicBoard<10, 20>&, const Piece&, bool);
+template void composeBoard(BasicBoard<10, 40>&, const Piece&, bool);
+template void composeBoard(BasicBoard<15, 20>&, const Piece&, bool);
+template void composeBoard(BasicBoard<64, 128>&, const Piece&, bool);
+template void composeBoard(const BasicGameCore<10, 20>&, BasicBoard<10, 20>&,
+                           bool);
+template void composeBoard(const BasicGameCore<10, 40>&, BasicBoard<10, 40>&,
+                           bool);
+template void composeBoard(const BasicGameCore<15, 20>&, BasicBoard<15, 20>&,
+                           bool);
+template void composeBoard(const BasicGameCore<64, 128>&, BasicBoard<64, 128>&,
+                           bool);
+template void composeEndingBoard(const BasicGameCore<10, 20>&,
+                                 BasicBoard<10, 20>&);
+template void composeEndingBoard(const BasicGameCore<10, 40>&,
+                                 BasicBoard<10, 40>&);
+template void composeEndingBoard(const BasicGameCore<15, 20>&,
+                                 BasicBoard<15, 20>&);
+template void composeEndingBoard(const BasicGameCore<64, 128>&,
+                                 BasicBoard<64, 128>&);
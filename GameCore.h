@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Board.h"
+#include "Piece.h"
+#include "Randomizer.h"
+
+// Base drop speed and gravity constants (microseconds / ticks).
+constexpr long BASE_DROP_SPEED_US  = 500000; // Base tick group duration.
+constexpr int  DROP_INTERVAL_TICKS = 5;      // Logic steps per drop.
+
+// Row of the 4x4 template's top edge when a piece spawns.
+constexpr int  SPAWN_Y             = -1;
+
+// Level progression constant.
+constexpr int  LINES_PER_LEVEL     = 10;     // Lines needed to advance one level.
+
+// Gameplay inputs understood by the simulation core.
+enum class GameAction {
+    None,
+    MoveLeft,
+    MoveRight,
+    Rotate,
+    SoftDrop,
+    HardDrop
+};
+
+// Outcome of locking the active piece into the board.
+struct LockResult {
+    bool locked{false};       // A piece was locked during this step.
+    int  pieceType{-1};       // Type of the locked piece.
+    int  linesCleared{0};     // 0..4 rows removed by this lock.
+    int  clearedTop{0};       // Row of the locked piece's template top.
+    uint8_t clearedRows{0};   // Bit i: row clearedTop + i was removed.
+    int  scoreDelta{0};       // Points awarded for the clear.
+    bool leveledUp{false};    // Level increased as a result of the clear.
+    bool gameOver{false};     // The game ended during this step.
+    int  garbageSent{0};      // Garbage rows left to send after cancelling.
+    int  garbageReceived{0};  // Queued garbage rows that rose at this lock.
+};
+
+// Outcome of a single step() or tick() call.
+struct StepResult {
+    bool       moved{false};  // The active piece changed position/rotation.
+    LockResult lock;
+};
+
+// Pure, deterministic Tetris rules with no terminal, sound or timing I/O.
+// The same seed and the same sequence of step()/tick() calls always
+// produce the same game. Templated on the board size like BasicBoard;
+// GameCore is the game's own size.
+template <int W, int H>
+class BasicGameCore {
+public:
+    using BoardType = BasicBoard<W, H>;
+
+    explicit BasicGameCore(uint32_t seed = 0,
+                           RandomizerMode mode = RandomizerMode::Uniform);
+
+    // Start a fresh game from the given seed, keeping the randomizer mode.
+    void reset(uint32_t seed);
+    void reset(uint32_t seed, RandomizerMode mode);
+
+    // Continue from a given board and active piece (fixtures, tools).
+    // Score, level and the preview queue are left as they are.
+    void setPosition(const BoardType& newBoard, const Piece& piece);
+
+    // Queue `rows` garbage rows open at column `hole` (versus play). They
+    // rise under the board at the next lock, less the rows that lock's
+    // clear cancels.
+    void queueGarbage(int rows, int hole);
+
+    // Apply one player action.
+    StepResult step(GameAction action);
+
+    // Advance gravity by one logic tick (a drop every DROP_INTERVAL_TICKS).
+    StepResult tick();
+
+    // The same as `ticks` calls of tick(), for 1 <= ticks <= ticksUntilDrop():
+    // only the last of them can move or lock the piece.
+    StepResult tick(int ticks);
+
+    // Ticks left until the one that drops the piece, 1..DROP_INTERVAL_TICKS.
+    int ticksUntilDrop() const { return DROP_INTERVAL_TICKS - dropCounter; }
+
+    // Collision test for the active piece moved by (dx, dy) with a rotation.
+    bool canMove(int dx, int dy, int newRotation) const;
+
+    // Collision test for an arbitrary piece against the locked cells.
+    bool canPlace(const Piece& piece) const;
+
+    // The same test against any board; tools use it as the reference
+    // collision check.
+    static bool canPlace(const BoardType& board, const Piece& piece);
+
+    // The first `count` piece types a game started with `seed` deals:
+    // the first spawned piece, then each preview in turn.
+    static std::vector<int> pieceSequence(
+        uint32_t seed, int count,
+        RandomizerMode mode = RandomizerMode::Uniform);
+
+    // Landing position of the active piece after a hard drop.
+    Piece calculateGhostPiece() const;
+
+    // Zobrist key of the locked cells plus the active and preview pieces.
+    // Equal positions give equal keys whatever moves led to them.
+    uint64_t hash() const;
+
+    // Drop speed (one tick group) for a given level.
+    static long computeDropSpeedUs(int level);
+
+    const BoardType& getBoard() const     { return board; }
+    const Piece& getCurrentPiece() const  { return currentPiece; }
+    int  getNextPieceType() const         { return randomizer.peek(0); }
+    // Upcoming piece `index` (0 = next), up to Randomizer::PREVIEW_COUNT.
+    int  getPreviewPiece(int index) const { return randomizer.peek(index); }
+    RandomizerMode getRandomizerMode() const { return randomizer.getMode(); }
+    int  getScore() const                 { return score; }
+    int  getLevel() const                 { return level; }
+    int  getLinesCleared() const          { return linesCleared; }
+    long getPiecesPlaced() const          { return piecesPlaced; }
+    long getTickCount() const             { return tickCount; }
+    bool isGameOver() const               { return gameOver; }
+    int  getPendingGarbage() const        { return pendingGarbage; }
+
+private:
+    BoardType board;                // Locked cells only, never the active piece.
+    Piece   currentPiece;
+
+    int     score{0};
+    int     level{1};
+    int     linesCleared{0};
+    long    piecesPlaced{0};
+    long    tickCount{0};
+    int     dropCounter{0};
+    bool    gameOver{false};
+
+    // Garbage waiting to rise, oldest first; batches beyond the last
+    // slot are merged into it.
+    static constexpr int MAX_GARBAGE_BATCHES = 8;
+    struct GarbageBatch {
+        int16_t rows;
+        int16_t hole;
+    };
+    GarbageBatch garbage[MAX_GARBAGE_BATCHES]{};
+    int     garbageBatches{0};
+    int     pendingGarbage{0};
+
+    Randomizer randomizer;          // Upcoming piece types.
+
+    void spawnNewPiece();
+    void lockPiece(LockResult& result);
+    void softDrop(StepResult& result);
+    void hardDrop(StepResult& result);
+    bool rotate();
+};
+
+using GameCore = BasicGameCore<BOARD_WIDTH, BOARD_HEIGHT>;
+
+// Cores for the other board sizes of Board.h.
+using GameCore10x20  = BasicGameCore<10, 20>;
+using GameCore10x40  = BasicGameCore<10, 40>;
+using StressGameCore = BasicGameCore<64, 128>;
+
+// Compiled once in GameCore.cpp.
+extern template class BasicGameCore<10, 20>;
+extern template class BasicGameCore<10, 40>;
+extern template class BasicGameCore<15, 20>;
+extern template class BasicGameCore<64, 128>;
+
+// Display boards: the locked cells with the pieces drawn in, as every view
+// of a game shows them (the terminal, replays and recordings, the server
+// and its spectators, wall tiles).
+
+// Draw into `board`, which holds the locked cells, the ghost outline where
+// a hard drop would land `piece` (with `ghost`, when that is below it) as
+// '.' in empty cells, then the piece over both.
+template <int W, int H>
+void composeBoard(BasicBoard<W, H>& board, const Piece& piece, bool ghost);
+
+// The same from a core: its locked cells, ghost and active piece.
+template <int W, int H>
+void composeBoard(const BasicGameCore<W, H>& core, BasicBoard<W, H>& out,
+                  bool ghost);
+
+// The closing frames: the last piece drawn only into empty cells, since at
+// game over it may overlap locked ones.
+template <int W, int H>
+void composeEndingBoard(const BasicGameCore<W, H>& core, BasicBoard<W, H>& out);
@@ -0,0 +1,534 @@
+#include "GameServer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <random>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "BlockTemplate.h"
+#include "Broadcast.h"
+
+namespace {
+
+// epoll tags of the two shared descriptors; sessions use (generation, slot).
+constexpr uint64_t LISTEN_TAG = ~static_cast<uint64_t>(0);
+constexpr uint64_t STOP_TAG   = LISTEN_TAG - 1;
+
+// Telnet: IAC WILL ECHO, IAC WILL SUPPRESS-GO-AHEAD puts the client in
+// character mode without local echo.
+const char TELNET_CHARACTER_MODE[] = "\xFF\xFB\x01\xFF\xFB\x03";
+const char SCREEN_START[]          = "\033[?25l\033[0m\033[2J";
+const char SCREEN_END[]            = "\033[0m\033[2J\033[1;1H\033[?25h";
+
+// Input parser states.
+enum : uint8_t { KEY, ESCAPE, CSI, IAC, IAC_OPTION, SUBNEGOTIATION, SUBNEGOTIATION_IAC };
+
+GameServer* signalTarget = nullptr;
+
+void onSignal(int) {
+    if (signalTarget) signalTarget->stop();
+}
+
+long long nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t sessionTag(uint32_t generation, uint32_t slot) {
+    return static_cast<uint64_t>(generation) << 32 | slot;
+}
+
+} // namespace
+
+GameServer::GameServer(const ServerConfig& serverConfig)
+    : config(serverConfig) {
+    if (config.workers <= 0) {
+        config.workers = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    if (config.workers <= 0) config.workers = 1;
+    if (config.maxSessions < 1) config.maxSessions = 1;
+}
+
+GameServer::~GameServer() {
+    if (stopFd >= 0) close(stopFd);
+    if (listenFd >= 0) close(listenFd);
+}
+
+size_t GameServer::sessionBytes() {
+    return sizeof(Session) + sizeof(std::unique_ptr<Session>) + 2 * sizeof(uint32_t);
+}
+
+void GameServer::stop() {
+    uint64_t one = 1;
+    if (stopFd >= 0 && write(stopFd, &one, sizeof(one)) < 0) {
+        // Already signalled.
+    }
+}
+
+bool GameServer::run(std::string& error) {
+    BlockTemplate::initializeTemplates();
+    for (int type = 0; type < 7; ++type) renderPiecePreview(type, previews[type]);
+
+    listenFd = listenOn(config.address, error);
+    if (listenFd < 0) return false;
+    telnet = config.address.compare(0, 4, "tcp:") == 0;
+    stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    std::random_device entropy;
+    uint64_t seed = (static_cast<uint64_t>(entropy()) << 32) | entropy();
+    for (int i = 0; i < config.workers; ++i) {
+        std::unique_ptr<Worker> worker(new Worker());
+        worker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        worker->seeds.reseed(seed + static_cast<uint64_t>(i));
+        worker->frame.reserve(12000);
+        worker->out.reserve(12000);
+        worker->state.panelLines.resize(4);
+
+        // Every worker accepts, one at a time; all of them see stop().
+        epoll_event event{};
+        event.events   = EPOLLIN | EPOLLEXCLUSIVE;
+        event.data.u64 = LISTEN_TAG;
+        epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, listenFd, &event);
+        event.events   = EPOLLIN;
+        event.data.u64 = STOP_TAG;
+        epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, stopFd, &event);
+        workers.push_back(std::move(worker));
+    }
+
+    signalTarget = this;
+    struct sigaction action{};
+    struct sigaction oldInt{};
+    struct sigaction oldTerm{};
+    struct sigaction oldPipe{};
+    action.sa_handler = onSignal;
+    sigaction(SIGINT, &action, &oldInt);
+    sigaction(SIGTERM, &action, &oldTerm);
+    action.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &action, &oldPipe);
+
+    std::fprintf(stderr, "Serving %s on %d workers, %zu bytes per session; "
+                 "Ctrl-C stops\n", config.address.c_str(), config.workers,
+                 sessionBytes());
+    for (auto& worker : workers) {
+        Worker* w = worker.get();
+        w->thread = std::thread([this, w]() { runWorker(*w); });
+    }
+    for (auto& worker : workers) worker->thread.join();
+
+    sigaction(SIGINT, &oldInt, nullptr);
+    sigaction(SIGTERM, &oldTerm, nullptr);
+    sigaction(SIGPIPE, &oldPipe, nullptr);
+    signalTarget = nullptr;
+
+    for (auto& worker : workers) close(worker->epollFd);
+    workers.clear();
+    close(listenFd);
+    listenFd = -1;
+    if (!telnet) {
+        std::string path = config.address.compare(0, 5, "unix:") == 0
+                               ? config.address.substr(5) : config.address;
+        unlink(path.c_str());
+    }
+    std::fprintf(stderr, "%ld sessions served\n", sessionsServed.load());
+    return true;
+}
+
+void GameServer::runWorker(Worker& worker) {
+    epoll_event events[64];
+    bool stopping = false;
+    while (!stopping) {
+        long long now     = nowUs();
+        int       timeout = -1;
+        if (!worker.timers.empty()) {
+            long long wait = worker.timers.top().due - now;
+            timeout = wait <= 0 ? 0 : static_cast<int>((wait + 999) / 1000);
+        }
+
+        int count = epoll_wait(worker.epollFd, events, 64, timeout);
+        if (count < 0 && errno != EINTR) break;
+        now = nowUs();
+
+        for (int i = 0; i < count; ++i) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == STOP_TAG) {
+                stopping = true;
+            } else if (tag == LISTEN_TAG) {
+                acceptSessions(worker);
+            } else {
+                uint32_t slot = static_cast<uint32_t>(tag);
+                if (slot >= worker.slots.size() || !worker.slots[slot] ||
+                    worker.generations[slot] != static_cast<uint32_t>(tag >> 32)) {
+                    continue;   // Closed earlier in this batch.
+                }
+                Session& session = *worker.slots[slot];
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    closeSession(worker, slot, false);
+                    continue;
+                }
+                if ((events[i].events & EPOLLOUT) && !flush(worker, session, slot)) {
+                    continue;
+                }
+                if (events[i].events & EPOLLIN) handleInput(worker, slot, now);
+            }
+        }
+
+        // Gravity of every session that is due.
+        while (!worker.timers.empty() && worker.timers.top().due <= now) {
+            Timer timer = worker.timers.top();
+            worker.timers.pop();
+            if (timer.slot < worker.slots.size() && worker.slots[timer.slot] &&
+                worker.generations[timer.slot] == timer.generation) {
+                Session& session = *worker.slots[timer.slot];
+                if (session.mode == Mode::Playing && session.nextDrop == timer.due) {
+                    tickSession(worker, timer.slot, now);
+                }
+            }
+        }
+    }
+
+    for (uint32_t slot = 0; slot < worker.slots.size(); ++slot) {
+        if (worker.slots[slot]) closeSession(worker, slot, true);
+    }
+}
+
+void GameServer::acceptSessions(Worker& worker) {
+    for (;;) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        if (sessionCount.fetch_add(1) >= config.maxSessions) {
+            sessionCount.fetch_sub(1);
+            const char full[] = "Server full, try again later.\r\n";
+            if (send(fd, full, sizeof(full) - 1, MSG_NOSIGNAL) < 0) {
+                // Closing anyway.
+            }
+            close(fd);
+            continue;
+        }
+        sessionsServed.fetch_add(1, std::memory_order_relaxed);
+
+        uint32_t slot;
+        if (!worker.freeSlots.empty()) {
+            slot = worker.freeSlots.back();
+            worker.freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(worker.slots.size());
+            worker.slots.emplace_back();
+            worker.generations.push_back(0);
+        }
+        worker.slots[slot].reset(new Session());
+        Session& session   = *worker.slots[slot];
+        session.fd         = fd;
+        session.generation = ++worker.generations[slot];
+
+        epoll_event event{};
+        event.events   = EPOLLIN | EPOLLRDHUP;
+        event.data.u64 = sessionTag(session.generation, slot);
+        epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, fd, &event);
+
+        // An empty board until the first key.
+        session.core.reset(static_cast<uint32_t>(worker.seeds.next()), config.randomizer);
+        worker.out.clear();
+        if (telnet) worker.out += TELNET_CHARACTER_MODE;
+        worker.out += SCREEN_START;
+        session.pending = worker.out;
+        if (flush(worker, session, slot)) sendFrame(worker, session, slot);
+    }
+}
+
+void GameServer::handleInput(Worker& worker, uint32_t slot, long long now) {
+    Session& session = *worker.slots[slot];
+    unsigned char keys[256];
+    ssize_t n = recv(session.fd, keys, sizeof(keys), 0);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+        closeSession(worker, slot, false);
+        return;
+    }
+
+    bool quit = false;
+    Mode before = session.mode;
+    uint64_t hash = session.core.getBoard().hash;
+    Piece piece   = session.core.getCurrentPiece();
+    bool ghost    = session.ghostEnabled;
+    for (ssize_t i = 0; i < n && !quit; ++i) {
+        handleKey(worker, session, slot, keys[i], now, quit);
+    }
+    if (quit) {
+        closeSession(worker, slot, true);
+        return;
+    }
+
+    // One frame for the whole batch of keys, if anything visible changed.
+    const Piece& after = session.core.getCurrentPiece();
+    if (session.mode != before || session.ghostEnabled != ghost ||
+        session.core.getBoard().hash != hash || after.type != piece.type ||
+        after.rotation != piece.rotation || after.pos.x != piece.pos.x ||
+        after.pos.y != piece.pos.y) {
+        sendFrame(worker, session, slot);
+    }
+}
+
+void GameServer::handleKey(Worker& worker, Session& session, uint32_t slot,
+                           unsigned char key, long long now, bool& quit) {
+    // Telnet commands and terminal escapes are not keys.
+    switch (session.inputState) {
+        case ESCAPE:
+            session.inputState = key == '[' ? CSI : KEY;
+            return;
+        case CSI:
+            session.inputState = KEY;
+            if (key == 'A') key = 'w';
+            else if (key == 'B') key = 's';
+            else if (key == 'C') key = 'd';
+            else if (key == 'D') key = 'a';
+            else return;
+            break;
+        case IAC:
+            session.inputState = key >= 251 && key <= 254 ? IAC_OPTION
+                               : key == 250               ? SUBNEGOTIATION
+                                                          : KEY;
+            return;
+        case IAC_OPTION:
+            session.inputState = KEY;
+            return;
+        case SUBNEGOTIATION:
+            if (key == 255) session.inputState = SUBNEGOTIATION_IAC;
+            return;
+        case SUBNEGOTIATION_IAC:
+            session.inputState = key == 240 ? KEY : SUBNEGOTIATION;
+            return;
+        default:
+            if (key == 27) {
+                session.inputState = ESCAPE;
+                return;
+            }
+            if (key == 255) {
+                session.inputState = IAC;
+                return;
+            }
+            break;
+    }
+
+    if (key == 3 || key == 4 || key == 'q' || key == 'Q') {
+        quit = true;
+        return;
+    }
+    if (key == '\r' || key == '\n' || key == 0) return;
+
+    switch (session.mode) {
+        case Mode::Ready:
+            startGame(worker, session, slot, now);
+            return;
+        case Mode::Over:
+            if (key == 'r' || key == 'R') startGame(worker, session, slot, now);
+            return;
+        case Mode::Paused:
+            if (key == 'p' || key == 'P') {
+                session.mode = Mode::Playing;
+                schedule(worker, session, slot, now);
+            }
+            return;
+        case Mode::Playing:
+            break;
+    }
+
+    GameAction action;
+    switch (key) {
+        case 'a': case 'A': action = GameAction::MoveLeft;  break;
+        case 'd': case 'D': action = GameAction::MoveRight; break;
+        case 'w': case 'W': action = GameAction::Rotate;    break;
+        case 's': case 'S': action = GameAction::SoftDrop;  break;
+        case ' ':           action = GameAction::HardDrop;  break;
+        case 'g': case 'G':
+            session.ghostEnabled = !session.ghostEnabled;
+            return;
+        case 'p': case 'P':
+            catchUp(session, now);
+            session.mode = Mode::Paused;   // Its timer lapses.
+            return;
+        default:
+            return;
+    }
+
+    // The action sees the drop counter as the ticks so far left it.
+    catchUp(session, now);
+    StepResult result = session.core.step(action);
+    if (session.core.isGameOver()) {
+        session.mode      = Mode::Over;
+        session.bestScore = std::max(session.bestScore, session.core.getScore());
+    } else if (result.lock.locked) {
+        // A lock restarts the drop count (and may change the level).
+        armDrop(worker, session, slot);
+    }
+}
+
+void GameServer::startGame(Worker& worker, Session& session, uint32_t slot,
+                           long long now) {
+    if (session.mode == Mode::Over) {
+        session.core.reset(static_cast<uint32_t>(worker.seeds.next()), config.randomizer);
+    }
+    session.mode = Mode::Playing;
+    schedule(worker, session, slot, now);
+}
+
+namespace {
+
+// One logic tick per frame of the single-player loop.
+long long tickInterval(const GameCore& core) {
+    return GameCore::computeDropSpeedUs(core.getLevel()) / DROP_INTERVAL_TICKS;
+}
+
+} // namespace
+
+void GameServer::schedule(Worker& worker, Session& session, uint32_t slot,
+                          long long now) {
+    session.nextTick = now + tickInterval(session.core);
+    armDrop(worker, session, slot);
+}
+
+void GameServer::armDrop(Worker& worker, Session& session, uint32_t slot) {
+    // Only the tick that drops the piece wakes the worker; the ones before
+    // it just count, so they run when the drop (or an input) comes.
+    // An earlier timer of the session no longer matches nextDrop.
+    session.nextDrop = session.nextTick +
+                       (session.core.ticksUntilDrop() - 1) * tickInterval(session.core);
+    worker.timers.push({session.nextDrop, slot, session.generation});
+}
+
+void GameServer::catchUp(Session& session, long long now) {
+    // The ticks due by now, all before the drop tick.
+    long long interval = tickInterval(session.core);
+    int       due      = 0;
+    while (session.nextTick <= now &&
+           due < session.core.ticksUntilDrop() - 1) {
+        session.nextTick += interval;
+        ++due;
+    }
+    if (due > 0) session.core.tick(due);
+}
+
+void GameServer::tickSession(Worker& worker, uint32_t slot, long long now) {
+    Session&   session = *worker.slots[slot];
+    StepResult result  = session.core.tick(session.core.ticksUntilDrop());
+    if (session.core.isGameOver()) {
+        session.mode      = Mode::Over;
+        session.bestScore = std::max(session.bestScore, session.core.getScore());
+    } else {
+        schedule(worker, session, slot, now);
+    }
+    if (result.moved || result.lock.locked || session.mode == Mode::Over) {
+        sendFrame(worker, session, slot);
+    }
+}
+
+void GameServer::sendFrame(Worker& worker, Session& session, uint32_t slot) {
+    // The frame on the wire drains first; the newest one follows it.
+    if (!session.pending.empty()) {
+        session.dirty = true;
+        return;
+    }
+    session.dirty = false;
+
+    const GameCore& core = session.core;
+    Board& display = worker.display;
+    if (session.mode != Mode::Over) {
+        composeBoard(core, display, session.ghostEnabled);
+    } else {
+        display = core.getBoard();
+    }
+
+    GameState& state   = worker.state;
+    state.score        = core.getScore();
+    state.level        = core.getLevel();
+    state.linesCleared = core.getLinesCleared();
+    std::vector<std::string>& panel = state.panelLines;
+    for (std::string& line : panel) line.clear();
+    switch (session.mode) {
+        case Mode::Ready:
+            panel[0] = " PRESS A KEY";
+            panel[1] = " TO START";
+            break;
+        case Mode::Paused:
+            panel[0] = " PAUSED";
+            break;
+        case Mode::Over:
+            panel[0] = " GAME OVER";
+            panel[1] = " BEST ";
+            appendInt(panel[1], session.bestScore);
+            panel[2] = " R: AGAIN";
+            panel[3] = " Q: QUIT";
+            break;
+        case Mode::Playing:
+            break;
+    }
+    display.render(state, previews[core.getNextPieceType()], worker.frame);
+
+    // Only the lines that differ from what the player's screen shows.
+    std::string& out = worker.out;
+    out.clear();
+    appendChangedLines(worker.frame, session.lineHash, false, out);
+    if (out.empty()) return;
+
+    ssize_t n = send(session.fd, out.data(), out.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n == static_cast<ssize_t>(out.size())) return;
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        return;   // EPOLLERR or EPOLLHUP closes the session.
+    }
+    session.pending.assign(out, n > 0 ? static_cast<size_t>(n) : 0, std::string::npos);
+    session.pendingSent = 0;
+
+    epoll_event event{};
+    event.events   = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+    event.data.u64 = sessionTag(session.generation, slot);
+    epoll_ctl(worker.epollFd, EPOLL_CTL_MOD, session.fd, &event);
+}
+
+bool GameServer::flush(Worker& worker, Session& session, uint32_t slot) {
+    while (session.pendingSent < session.pending.size()) {
+        ssize_t n = send(session.fd, session.pending.data() + session.pendingSent,
+                         session.pending.size() - session.pendingSent,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0) {
+            session.pendingSent += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            epoll_event event{};
+            event.events   = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+            event.data.u64 = sessionTag(session.generation, slot);
+            epoll_ctl(worker.epollFd, EPOLL_CTL_MOD, session.fd, &event);
+            return true;
+        } else {
+            closeSession(worker, slot, false);
+            return false;
+        }
+    }
+
+    // Drained: back to input only, and release the buffer.
+    std::string().swap(session.pending);
+    session.pendingSent = 0;
+    epoll_event event{};
+    event.events   = EPOLLIN | EPOLLRDHUP;
+    event.data.u64 = sessionTag(session.generation, slot);
+    epoll_ctl(worker.epollFd, EPOLL_CTL_MOD, session.fd, &event);
+    if (session.dirty) sendFrame(worker, session, slot);
+    return true;
+}
+
+void GameServer::closeSession(Worker& worker, uint32_t slot, bool goodbye) {
+    Session& session = *worker.slots[slot];
+    if (goodbye && send(session.fd, SCREEN_END, sizeof(SCREEN_END) - 1,
+                        MSG_NOSIGNAL | MSG_DONTWAIT) < 0) {
+        // The player is gone already.
+    }
+    epoll_ctl(worker.epollFd, EPOLL_CTL_DEL, session.fd, nullptr);
+    close(session.fd);
+    worker.slots[slot].reset();
+    worker.freeSlots.push_back(slot);
+    sessionCount.fetch_sub(1);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "FramePacer.h"
+#include "GameCore.h"
+#include "GameState.h"
+#include "Randomizer.h"
+
+// Settings of a multi-session server.
+struct ServerConfig {
+    std::string address;              // Unix socket path or tcp:PORT.
+    int         workers{0};           // Event loop threads, 0 = all cores.
+    int         maxSessions{1024};    // Connections beyond this are refused.
+    RandomizerMode randomizer{RandomizerMode::Uniform};
+};
+
+// One process hosting many players, each over its own socket connection
+// (telnet, or socat in raw mode for a Unix socket) instead of a terminal.
+//
+// Every worker thread runs its own epoll loop and accepts from the shared
+// listening socket (EPOLLEXCLUSIVE), so a session lives on one worker for
+// its whole life and nothing is locked. A session is a GameCore and a few
+// hundred bytes: instead of a copy of the last frame it keeps a hash of
+// each line it sent, and a new frame, rendered into the worker's scratch
+// buffer, is sent as the lines whose hash changed. Work happens only on
+// input and on gravity, which runs off a per-worker timer heap, so idle
+// sessions (waiting to start, paused, game over) cost nothing. Templates
+// and the seven next-piece previews are built once and shared.
+//
+// A session whose socket cannot take a frame keeps the unsent bytes and
+// skips frames until they drain, then gets the newest one.
+class GameServer {
+public:
+    explicit GameServer(const ServerConfig& config);
+    ~GameServer();
+
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    // Serve until SIGINT, SIGTERM or stop(). False with `error` set when
+    // the address cannot be listened on.
+    bool run(std::string& error);
+
+    // From any thread (or a signal handler).
+    void stop();
+
+    // Bytes held per connected player, frames in flight excepted.
+    static size_t sessionBytes();
+
+private:
+    enum class Mode : uint8_t { Ready, Playing, Paused, Over };
+
+    struct Session {
+        int       fd{-1};
+        uint32_t  generation{0};      // Tells reused slots apart.
+        Mode      mode{Mode::Ready};
+        bool      ghostEnabled{true};
+        bool      dirty{false};       // A frame was skipped for backpressure.
+        uint8_t   inputState{0};      // Escape / telnet command parser.
+        int       bestScore{0};
+        long long nextTick{0};        // Next logic tick, microseconds; the
+                                      // ticks before nextDrop run lazily.
+        long long nextDrop{0};        // Due time of the gravity timer.
+        GameCore  core;
+        uint64_t  lineHash[FRAME_LINES]{};  // Lines on the screen.
+        std::string pending;          // Unsent bytes of the last frame.
+        size_t    pendingSent{0};
+    };
+
+    struct Timer {
+        long long due;
+        uint32_t  slot;
+        uint32_t  generation;
+        bool operator<(const Timer& other) const { return due > other.due; }
+    };
+
+    struct Worker {
+        int         epollFd{-1};
+        std::thread thread;
+        Xoshiro256  seeds;
+        std::vector<std::unique_ptr<Session>> slots;
+        std::vector<uint32_t> generations;   // Per slot, kept across reuse.
+        std::vector<uint32_t> freeSlots;
+        std::priority_queue<Timer> timers;   // Gravity, soonest first.
+
+        // Scratch shared by the worker's sessions.
+        Board       display;
+        GameState   state;
+        std::string frame;
+        std::string out;
+    };
+
+    ServerConfig config;
+    int          listenFd{-1};
+    int          stopFd{-1};         // eventfd every worker watches.
+    bool         telnet{false};      // TCP: negotiate character mode.
+    std::atomic<int>  sessionCount{0};
+    std::atomic<long> sessionsServed{0};
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::string  previews[7][4];     // Next-piece preview of every type.
+
+    void runWorker(Worker& worker);
+    void acceptSessions(Worker& worker);
+    void handleInput(Worker& worker, uint32_t slot, long long now);
+    void handleKey(Worker& worker, Session& session, uint32_t slot,
+                   unsigned char key, long long now, bool& quit);
+    void tickSession(Worker& worker, uint32_t slot, long long now);
+    void schedule(Worker& worker, Session& session, uint32_t slot, long long now);
+    void armDrop(Worker& worker, Session& session, uint32_t slot);
+    void catchUp(Session& session, long long now);
+    void startGame(Worker& worker, Session& session, uint32_t slot, long long now);
+    void sendFrame(Worker& worker, Session& session, uint32_t slot);
+    bool flush(Worker& worker, Session& session, uint32_t slot);
+    void closeSession(Worker& worker, uint32_t slot, bool goodbye);
+};
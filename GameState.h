@@ -1,4 +1,5 @@
 #pragma once
+#include <string>
 #include <vector>
 
 class GameState {
@@ -13,4 +14,7 @@ public:
     int linesCleared{0};
 
     std::vector<int> highScores;
+
+    // Extra rows drawn under the stats panel (PANEL_WIDTH columns each).
+    std::vector<std::string> panelLines;
 };
@@ -0,0 +1,25 @@
+#include "FrameProfiler.h"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef HEAP_HOOKS
+// Replaces the global operator new/delete so every heap allocation of the
+// binary is counted by HeapStats (frame phases, HUD, allocation checks).
+// Linked only into bench and the PROFILE=1 game; the Makefile builds it
+// with -DHEAP_HOOKS, so a plain g++ *.cpp build gets an empty object.
+// Not inlined: GCC would otherwise pair the inlined free() with the
+// new-expressions it sees and warn about a mismatch.
+__attribute__((noinline)) void* operator new(std::size_t size) {
+    if (void* p = std::malloc(size ? size : 1)) {
+        HeapStats::recordAlloc(p);
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    HeapStats::recordFree(p);
+    std::free(p);
+}
+#endif
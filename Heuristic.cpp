@@ -0,0 +1,135 @@
+#include "Heuristic.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+struct WeightField {
+    const char* name;
+    double HeuristicWeights::*member;
+};
+
+const WeightField WEIGHT_FIELDS[HEURISTIC_WEIGHT_COUNT] = {
+    {"aggregateHeight", &HeuristicWeights::aggregateHeight},
+    {"completeLines",   &HeuristicWeights::completeLines},
+    {"holes",           &HeuristicWeights::holes},
+    {"bumpiness",       &HeuristicWeights::bumpiness},
+    {"wellDepth",       &HeuristicWeights::wellDepth},
+    {"rowTransitions",  &HeuristicWeights::rowTransitions},
+    {"maxHeight",       &HeuristicWeights::maxHeight},
+};
+
+} // namespace
+
+template <int W, int H>
+BoardFeatures computeFeatures(const BasicBitBoard<W, H>& board, int lines) {
+    using RowMask = typename BasicBitBoard<W, H>::RowMask;
+
+    BoardFeatures f;
+    f.completeLines = lines;
+
+    int     heights[W] = {};
+    RowMask covered = 0;   // Columns whose top block is above the current row.
+
+    for (int y = 0; y < H; ++y) {
+        RowMask row = board.rows[y];
+
+        // Columns that get their first block in this row.
+        RowMask tops = static_cast<RowMask>(row & ~covered);
+        while (tops) {
+            int x = __builtin_ctz(tops);
+            heights[x] = H - y;
+            tops &= static_cast<RowMask>(tops - 1);
+        }
+        covered |= row;
+
+        f.holes += __builtin_popcount(covered & ~row & BasicBitBoard<W, H>::FULL_ROW);
+
+        // Transitions along the row, walls counting as filled.
+        unsigned walled = (static_cast<unsigned>(row) << 1) |
+                          1u | (1u << (W + 1));
+        f.rowTransitions += __builtin_popcount((walled ^ (walled >> 1)) &
+                                               ((1u << (W + 1)) - 1));
+    }
+
+    for (int x = 0; x < W; ++x) {
+        f.aggregateHeight += heights[x];
+        if (heights[x] > f.maxHeight) f.maxHeight = heights[x];
+        if (x + 1 < W) {
+            f.bumpiness += std::abs(heights[x] - heights[x + 1]);
+        }
+
+        // A well is lower than both neighbours; walls count as tall.
+        int left  = x > 0     ? heights[x - 1] : H;
+        int right = x + 1 < W ? heights[x + 1] : H;
+        int rim   = left < right ? left : right;
+        if (rim > heights[x]) f.wellDepth += rim - heights[x];
+    }
+
+    return f;
+}
+
+template BoardFeatures computeFeatures(const BasicBitBoard<10, 20>&, int);
+template BoardFeatures computeFeatures(const BasicBitBoard<10, 40>&, int);
+template BoardFeatures computeFeatures(const BasicBitBoard<15, 20>&, int);
+
+double evaluateFeatures(const BoardFeatures& f, const HeuristicWeights& w) {
+    return w.aggregateHeight * f.aggregateHeight +
+           w.completeLines   * f.completeLines +
+           w.holes           * f.holes +
+           w.bumpiness       * f.bumpiness +
+           w.wellDepth       * f.wellDepth +
+           w.rowTransitions  * f.rowTransitions +
+           w.maxHeight       * f.maxHeight;
+}
+
+double& weightAt(HeuristicWeights& weights, int i) {
+    return weights.*WEIGHT_FIELDS[i].member;
+}
+
+double weightAt(const HeuristicWeights& weights, int i) {
+    return weights.*WEIGHT_FIELDS[i].member;
+}
+
+const char* weightName(int i) {
+    return WEIGHT_FIELDS[i].name;
+}
+
+bool loadWeights(const std::string& path, HeuristicWeights& weights) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    HeuristicWeights loaded = weights;
+    std::string      line;
+    while (std::getline(file, line)) {
+        std::string::size_type comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream fields(line);
+        std::string name;
+        double      value;
+        if (!(fields >> name)) continue;          // Blank line.
+        if (!(fields >> value)) return false;
+
+        int i = 0;
+        while (i < HEURISTIC_WEIGHT_COUNT && name != weightName(i)) ++i;
+        if (i == HEURISTIC_WEIGHT_COUNT) return false;
+        weightAt(loaded, i) = value;
+    }
+
+    weights = loaded;
+    return true;
+}
+
+bool saveWeights(const std::string& path, const HeuristicWeights& weights) {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    file.precision(17);
+    for (int i = 0; i < HEURISTIC_WEIGHT_COUNT; ++i) {
+        file << weightName(i) << ' ' << weightAt(weights, i) << '\n';
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+
+#include "BitBoard.h"
+
+// Board features used to score a placement.
+struct BoardFeatures {
+    int aggregateHeight{0};   // Sum of column heights.
+    int completeLines{0};     // Rows cleared by the placement.
+    int holes{0};             // Empty cells below a column's top block.
+    int bumpiness{0};         // Sum of height differences of neighbours.
+    int wellDepth{0};         // Sum of depths of one-wide wells.
+    int rowTransitions{0};    // Filled/empty changes along rows (walls filled).
+    int maxHeight{0};         // Tallest column.
+};
+
+// Linear weights applied to BoardFeatures; higher score = better board.
+struct HeuristicWeights {
+    double aggregateHeight{-0.510066};
+    double completeLines{0.760666};
+    double holes{-0.35663};
+    double bumpiness{-0.184483};
+    double wellDepth{0.0};
+    double rowTransitions{0.0};
+    double maxHeight{0.0};
+};
+
+// Number of weights, for code that treats them as a vector (the tuner).
+constexpr int HEURISTIC_WEIGHT_COUNT = 7;
+
+// Weight i in declaration order, and its name in weight files.
+double&     weightAt(HeuristicWeights& weights, int i);
+double      weightAt(const HeuristicWeights& weights, int i);
+const char* weightName(int i);
+
+// Weight files hold one "name value" pair per line; '#' starts a comment.
+// Weights missing from the file keep their current value. Returns false
+// when the file cannot be read or names an unknown weight.
+bool loadWeights(const std::string& path, HeuristicWeights& weights);
+bool saveWeights(const std::string& path, const HeuristicWeights& weights);
+
+// Extract features of a board after a placement that cleared `lines` rows.
+// Defined in Heuristic.cpp for the BasicBitBoard sizes.
+template <int W, int H>
+BoardFeatures computeFeatures(const BasicBitBoard<W, H>& board, int lines);
+
+// Weighted sum of features.
+double evaluateFeatures(const BoardFeatures& features,
+                        const HeuristicWeights& weights);
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bytes kept between data written by different threads.
+constexpr size_t MAILBOX_CACHE_LINE = 64;
+
+// Bounded single-producer, single-consumer queue without locks: one
+// thread pushes, one other thread peeks and pops. Each side only stores
+// its own index and caches the other side's, so an uncontended push or
+// pop touches no shared cache line but its own. Capacity must be a power
+// of two.
+template <typename T, size_t Capacity>
+class Mailbox {
+public:
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Mailbox capacity must be a power of two");
+
+    // Producer side; false when the mailbox is full.
+    bool push(const T& value) {
+        size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - headCache == Capacity) {
+            headCache = headIndex.load(std::memory_order_acquire);
+            if (tail - headCache == Capacity) return false;
+        }
+        slots[tail & (Capacity - 1)] = value;
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: the oldest value, or nullptr when empty. It stays in
+    // the mailbox until pop().
+    const T* front() {
+        size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailCache) {
+            tailCache = tailIndex.load(std::memory_order_acquire);
+            if (head == tailCache) return nullptr;
+        }
+        return &slots[head & (Capacity - 1)];
+    }
+
+    // Empty the mailbox; only while neither side is using it.
+    void clear() {
+        headIndex.store(0, std::memory_order_relaxed);
+        tailIndex.store(0, std::memory_order_relaxed);
+        headCache = 0;
+        tailCache = 0;
+    }
+
+    // Consumer side: drop the value front() returned.
+    void pop() {
+        headIndex.store(headIndex.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+    }
+
+private:
+    // Padding rather than alignas: these live in arrays allocated with new,
+    // which C++11 does not align beyond the fundamental alignment.
+    std::atomic<size_t> headIndex{0};   // Written by the consumer.
+    size_t tailCache{0};                // Consumer's copy of tail.
+    char   consumerPad[MAILBOX_CACHE_LINE - 2 * sizeof(size_t)];
+    std::atomic<size_t> tailIndex{0};   // Written by the producer.
+    size_t headCache{0};                // Producer's copy of head.
+    char   producerPad[MAILBOX_CACHE_LINE - 2 * sizeof(size_t)];
+    T slots[Capacity];
+};
+
+// Latest-value handoff from one writer thread to one reader thread. The
+// writer fills back() and publishes it; the reader picks up the newest
+// published value with update() and keeps reading front() until the next
+// one. Neither side ever waits, and a slow reader just skips values.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side.
+    T&   back() { return slots[backIndex]; }
+    void publish() {
+        uint8_t old = middle.exchange(static_cast<uint8_t>(backIndex | FRESH),
+                                      std::memory_order_acq_rel);
+        backIndex = old & INDEX;
+    }
+
+    // Reader side; true when a newer value replaced front().
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        uint8_t old = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = old & INDEX;
+        return true;
+    }
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    T slots[3];
+    std::atomic<uint8_t> middle{1};     // Slot index | FRESH.
+    char    middlePad[MAILBOX_CACHE_LINE - 1];
+    uint8_t backIndex{0};               // Writer only.
+    char    backPad[MAILBOX_CACHE_LINE - 1];
+    uint8_t frontIndex{2};              // Reader only.
+};
@@ -0,0 +1,388 @@
+#include "MoveGenerator.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Same order as GameCore::rotate().
+const int KICKS[] = {0, -1, 1, -2, 2, -3, 3};
+const int NO_KICK = 100;
+
+// States a run of soft drops reaches from `from` without leaving `open`
+// (rows grow towards higher bits): an occluded fill in six steps.
+inline uint64_t dropFill(uint64_t from, uint64_t open) {
+    from |= open & (from << 1);  open &= open << 1;
+    from |= open & (from << 2);  open &= open << 2;
+    from |= open & (from << 4);  open &= open << 4;
+    from |= open & (from << 8);  open &= open << 8;
+    from |= open & (from << 16); open &= open << 16;
+    from |= open & (from << 32);
+    return from;
+}
+
+// For each rotation of each piece, the lowest rotation covering the same
+// cells and the offset between the two (O, I, S and Z repeat).
+struct Symmetry {
+    int rotation[BlockTemplate::NUM_BLOCK_TYPES][4];
+    int dx[BlockTemplate::NUM_BLOCK_TYPES][4];
+    int dy[BlockTemplate::NUM_BLOCK_TYPES][4];
+
+    Symmetry() {
+        for (int t = 0; t < BlockTemplate::NUM_BLOCK_TYPES; ++t) {
+            for (int r = 0; r < 4; ++r) {
+                const PieceShape& s = pieceShape(t, r);
+                int base = 0;
+                while (!sameCells(s, pieceShape(t, base))) ++base;
+
+                const PieceShape& b = pieceShape(t, base);
+                rotation[t][r] = base;
+                dx[t][r]       = s.minCol - b.minCol;
+                dy[t][r]       = s.minRow - b.minRow;
+            }
+        }
+    }
+
+    // Equal shapes once both are moved to their top-left corner.
+    static bool sameCells(const PieceShape& a, const PieceShape& b) {
+        if (a.maxRow - a.minRow != b.maxRow - b.minRow) return false;
+        for (int row = 0; row <= a.maxRow - a.minRow; ++row) {
+            if ((a.rows[a.minRow + row] >> a.minCol) !=
+                (b.rows[b.minRow + row] >> b.minCol)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+template <int W, int H>
+Piece BasicMoveGenerator<W, H>::stateAt(int type, int index) {
+    Piece p;
+    p.type     = type;
+    p.pos.y    = index % Y_SLOTS - Y_OFFSET;
+    index     /= Y_SLOTS;
+    p.pos.x    = index % X_SLOTS - X_OFFSET;
+    p.rotation = index / X_SLOTS;
+    return p;
+}
+
+template <int W, int H>
+void BasicMoveGenerator<W, H>::canonical(int type, int& rotation, int& x, int& y) {
+    static const Symmetry symmetry;
+
+    x += symmetry.dx[type][rotation];
+    y += symmetry.dy[type][rotation];
+    rotation = symmetry.rotation[type][rotation];
+}
+
+template <int W, int H>
+void BasicMoveGenerator<W, H>::buildFitMasks(const BoardType& board) {
+    // Column c of the board as a mask over rows; the floor and everything
+    // below it count as filled, rows above the top edge as open.
+    const uint64_t floor = ~0ULL << (H + Y_OFFSET);
+    uint64_t columns[W];
+    for (int c = 0; c < W; ++c) columns[c] = floor;
+    for (int y = 0; y < H; ++y) {
+        unsigned row = board.rows[y];
+        while (row) {
+            int c = __builtin_ctz(row);
+            columns[c] |= 1ULL << (y + Y_OFFSET);
+            row &= row - 1;
+        }
+    }
+
+    for (int rot = 0; rot < 4; ++rot) {
+        const PieceShape& s = pieceShape(type, rot);
+        for (int slot = 0; slot < X_SLOTS; ++slot) {
+            int x = slot - X_OFFSET;
+            uint64_t taken = 0;
+            for (int row = s.minRow; row <= s.maxRow; ++row) {
+                for (unsigned m = s.rows[row]; m; m &= m - 1) {
+                    int c = x + __builtin_ctz(m);
+                    // A cell outside the walls collides at every row.
+                    taken |= (c < 0 || c >= W) ? ~0ULL : columns[c] >> row;
+                }
+            }
+            fits[rot][slot] = ~taken;
+        }
+    }
+}
+
+template <int W, int H>
+int BasicMoveGenerator<W, H>::rotationKick(int rotation, int x, int y) const {
+    int newRot = (rotation + 1) % 4;
+    for (int dx : KICKS) {
+        if (fitsAt(newRot, x + dx, y)) return dx;
+    }
+    return NO_KICK;
+}
+
+template <int W, int H>
+void BasicMoveGenerator<W, H>::generate(const BoardType& board,
+                                        const Piece& piece,
+                                        std::vector<Placement>& out) {
+    out.clear();
+    type  = piece.type;
+    start = piece;
+
+    std::memset(reach, 0, sizeof(reach));
+    std::memset(landed, 0, sizeof(landed));
+    buildFitMasks(board);
+    if (!fitsAt(piece.rotation, piece.pos.x, piece.pos.y)) return;
+
+    // Flood the reachable states to a fixed point. A column is queued
+    // again whenever it gains states; each gain is closed under soft
+    // drop right away.
+    const int COLUMNS = 4 * X_SLOTS;
+    int16_t queue[COLUMNS];
+    bool    queued[COLUMNS] = {};
+    int     head = 0, pending = 0;
+
+    auto add = [&](int rot, int slot, uint64_t states) {
+        states &= fits[rot][slot] & ~reach[rot][slot];
+        if (!states) return;
+        reach[rot][slot] |= dropFill(states, fits[rot][slot]);
+
+        int column = rot * X_SLOTS + slot;
+        if (!queued[column]) {
+            queued[column] = true;
+            queue[(head + pending++) % COLUMNS] = static_cast<int16_t>(column);
+        }
+    };
+
+    add(piece.rotation, piece.pos.x + X_OFFSET,
+        1ULL << (piece.pos.y + Y_OFFSET));
+
+    while (pending > 0) {
+        int column = queue[head];
+        head = (head + 1) % COLUMNS;
+        --pending;
+        queued[column] = false;
+
+        int      rot    = column / X_SLOTS;
+        int      slot   = column % X_SLOTS;
+        uint64_t states = reach[rot][slot];
+
+        if (slot > 0)           add(rot, slot - 1, states);
+        if (slot + 1 < X_SLOTS) add(rot, slot + 1, states);
+
+        // Each state takes the first kick that fits, like rotate().
+        int      newRot  = (rot + 1) % 4;
+        uint64_t waiting = states;
+        for (int dx : KICKS) {
+            int target = slot + dx;
+            if (target < 0 || target >= X_SLOTS) continue;
+            uint64_t kicked = waiting & fits[newRot][target];
+            add(newRot, target, kicked);
+            waiting &= ~kicked;
+            if (!waiting) break;
+        }
+    }
+
+    // Reachable states with no room below are the lock positions.
+    for (int rot = 0; rot < 4; ++rot) {
+        for (int slot = 0; slot < X_SLOTS; ++slot) {
+            uint64_t locks = reach[rot][slot] & ~(fits[rot][slot] >> 1);
+            for (; locks; locks &= locks - 1) {
+                int x = slot - X_OFFSET;
+                int y = __builtin_ctzll(locks) - Y_OFFSET;
+
+                // Symmetric rotations covering the same cells share one
+                // entry.
+                int cr = rot, cx = x, cy = y;
+                canonical(type, cr, cx, cy);
+                uint32_t  bit     = 1u << (cx + X_OFFSET);
+                uint32_t& lockRow = landed[cr][cy + Y_OFFSET];
+                if (lockRow & bit) continue;
+                lockRow |= bit;
+                placementAt[stateIndex(cr, cx, cy)] =
+                    static_cast<int16_t>(out.size());
+
+                Placement placement;
+                placement.rotation = rot;
+                placement.x        = x;
+                placement.y        = y;
+                out.push_back(placement);
+            }
+        }
+    }
+}
+
+template <int W, int H>
+int BasicMoveGenerator<W, H>::reachableStates() const {
+    int total = 0;
+    for (int rot = 0; rot < 4; ++rot) {
+        for (int slot = 0; slot < X_SLOTS; ++slot) {
+            total += __builtin_popcountll(reach[rot][slot]);
+        }
+    }
+    return total;
+}
+
+template <int W, int H>
+int BasicMoveGenerator<W, H>::find(int rotation, int x, int y) const {
+    canonical(type, rotation, x, y);
+    if (x + X_OFFSET < 0 || x + X_OFFSET >= X_SLOTS ||
+        y + Y_OFFSET < 0 || y + Y_OFFSET >= Y_SLOTS) {
+        return -1;
+    }
+    if (!(landed[rotation][y + Y_OFFSET] & (1u << (x + X_OFFSET)))) return -1;
+    return placementAt[stateIndex(rotation, x, y)];
+}
+
+template <int W, int H>
+int BasicMoveGenerator<W, H>::searchLockState(int index) {
+    std::memset(visited, 0, sizeof(visited));
+
+    // The frontier of one layer as a list of (rotation, slot) columns and
+    // a mask of their states. Every state of a layer takes the same number
+    // of inputs, so the first one whose hard drop locks the target is a
+    // cheapest way there.
+    const int COLUMNS = 4 * X_SLOTS;
+    int16_t  columns[COLUMNS], nextColumns[COLUMNS];
+    uint64_t frontier[4][X_SLOTS] = {};
+    uint64_t next[4][X_SLOTS]     = {};
+    int      columnCount = 0;
+
+    int startSlot = start.pos.x + X_OFFSET;
+    frontier[start.rotation][startSlot] = 1ULL << (start.pos.y + Y_OFFSET);
+    visited[start.rotation][startSlot]  = frontier[start.rotation][startSlot];
+    depth[stateIndex(start.rotation, start.pos.x, start.pos.y)] = 0;
+    columns[columnCount++] =
+        static_cast<int16_t>(start.rotation * X_SLOTS + startSlot);
+
+    for (int layer = 0; columnCount > 0; ++layer) {
+        for (int i = 0; i < columnCount; ++i) {
+            int rot  = columns[i] / X_SLOTS;
+            int slot = columns[i] % X_SLOTS;
+            int x    = slot - X_OFFSET;
+
+            // A state under a visited one drops to the same place, and
+            // that one got there with no more inputs: only the tops of
+            // vertical runs can lock somewhere new.
+            uint64_t tops = frontier[rot][slot] & ~(visited[rot][slot] << 1);
+            for (; tops; tops &= tops - 1) {
+                int y = __builtin_ctzll(tops) - Y_OFFSET;
+                if (find(rot, x, landingRow(rot, x, y)) == index) {
+                    return stateIndex(rot, x, y);
+                }
+            }
+        }
+
+        int nextCount = 0;
+        auto reachStates = [&](int rot, int slot, uint64_t states) {
+            states &= fits[rot][slot] & ~visited[rot][slot];
+            if (!states) return;
+            if (!next[rot][slot]) {
+                nextColumns[nextCount++] = static_cast<int16_t>(rot * X_SLOTS + slot);
+            }
+            next[rot][slot] |= states;
+        };
+
+        for (int i = 0; i < columnCount; ++i) {
+            int      rot    = columns[i] / X_SLOTS;
+            int      slot   = columns[i] % X_SLOTS;
+            uint64_t states = frontier[rot][slot];
+            frontier[rot][slot] = 0;
+
+            if (slot > 0)           reachStates(rot, slot - 1, states);
+            if (slot + 1 < X_SLOTS) reachStates(rot, slot + 1, states);
+            reachStates(rot, slot, states << 1);
+
+            int      newRot  = (rot + 1) % 4;
+            uint64_t waiting = states;
+            for (int dx : KICKS) {
+                int target = slot + dx;
+                if (target < 0 || target >= X_SLOTS) continue;
+                uint64_t kicked = waiting & fits[newRot][target];
+                reachStates(newRot, target, kicked);
+                waiting &= ~kicked;
+                if (!waiting) break;
+            }
+        }
+
+        // Depths are written as states join, so path() never reads a
+        // stale one from an earlier search.
+        for (int i = 0; i < nextCount; ++i) {
+            int rot  = nextColumns[i] / X_SLOTS;
+            int slot = nextColumns[i] % X_SLOTS;
+            uint64_t states = next[rot][slot];
+            uint8_t* columnDepth = &depth[stateIndex(rot, slot - X_OFFSET, -Y_OFFSET)];
+            for (uint64_t bits = states; bits; bits &= bits - 1) {
+                columnDepth[__builtin_ctzll(bits)] = static_cast<uint8_t>(layer + 1);
+            }
+
+            frontier[rot][slot]  = states;
+            visited[rot][slot]  |= states;
+            next[rot][slot]      = 0;
+            columns[i]           = nextColumns[i];
+        }
+        columnCount = nextCount;
+    }
+    return -1;
+}
+
+template <int W, int H>
+void BasicMoveGenerator<W, H>::path(int index,
+                                    std::vector<GameAction>& inputs,
+                                    std::vector<Piece>& states) {
+    inputs.clear();
+    states.clear();
+
+    int lockState = searchLockState(index);
+    if (lockState < 0) return;
+
+    // Walk back from the hard drop state, one layer per step, to any
+    // neighbour one input closer to the start that leads here.
+    Piece p = stateAt(type, lockState);
+    states.push_back(p);
+    inputs.push_back(GameAction::HardDrop);
+
+    for (int d = depth[lockState]; d > 0; --d) {
+        int rot = p.rotation, x = p.pos.x, y = p.pos.y;
+        auto previous = [&](int r, int px, int py) {
+            unsigned slot = static_cast<unsigned>(px + X_OFFSET);
+            unsigned row  = static_cast<unsigned>(py + Y_OFFSET);
+            return slot < static_cast<unsigned>(X_SLOTS) &&
+                   row < static_cast<unsigned>(Y_SLOTS) &&
+                   ((visited[r][slot] >> row) & 1) &&
+                   depth[stateIndex(r, px, py)] == d - 1;
+        };
+
+        GameAction action = GameAction::None;
+        if (previous(rot, x, y - 1)) {
+            action = GameAction::SoftDrop;
+            --p.pos.y;
+        } else if (previous(rot, x + 1, y)) {
+            action = GameAction::MoveLeft;
+            ++p.pos.x;
+        } else if (previous(rot, x - 1, y)) {
+            action = GameAction::MoveRight;
+            --p.pos.x;
+        } else {
+            int prevRot = (rot + 3) % 4;
+            for (int dx : KICKS) {
+                if (previous(prevRot, x - dx, y) &&
+                    rotationKick(prevRot, x - dx, y) == dx) {
+                    action     = GameAction::Rotate;
+                    p.rotation = prevRot;
+                    p.pos.x    = x - dx;
+                    break;
+                }
+            }
+        }
+
+        states.push_back(p);
+        inputs.push_back(action);
+    }
+
+    std::reverse(inputs.begin(), inputs.end());
+    std::reverse(states.begin(), states.end());
+}
+
+template class BasicMoveGenerator<10, 20>;
+template class BasicMoveGenerator<10, 40>;
+template class BasicMoveGenerator<15, 20>;
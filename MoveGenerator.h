@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "BitBoard.h"
+#include "GameCore.h"
+#include "Piece.h"
+
+// A final resting position of a piece and its heuristic score.
+struct Placement {
+    int    rotation{0};
+    int    x{0};
+    int    y{0};
+    int    lines{0};
+    double score{0.0};
+};
+
+// Reachability search over (rotation, x, y) states of the active piece
+// with GameCore's exact rules: one-column shifts, clockwise rotation with
+// the kick list {0, -1, 1, -2, 2, -3, 3}, soft drop and hard drop. It finds
+// every lock position reachable from the piece's current state, tucks
+// and spins under overhangs included, and the shortest input sequence to
+// each. Rotations that cover the same cells count as one placement.
+//
+// States are bits: one 64-bit mask over rows per (rotation, x), so a soft
+// drop run, a shift or a rotation with its kicks moves a whole column of
+// states in a few instructions. generate() floods these masks to a fixed
+// point; path() then runs a breadth-first search, one layer per input,
+// only until it reaches the requested placement.
+//
+// Sized like BasicBitBoard; the column of states must fit one 64-bit mask,
+// so boards up to 56 rows deep work.
+template <int W, int H>
+class BasicMoveGenerator {
+public:
+    using BoardType = BasicBitBoard<W, H>;
+
+    // Every distinct lock position of `piece` on `board`, ordered by
+    // rotation and column. `lines` and `score` are left at zero.
+    void generate(const BoardType& board, const Piece& piece,
+                  std::vector<Placement>& out);
+
+    // Index of the placement of the last generate() covering the same
+    // cells as (rotation, x, y), or -1 when it is not reachable.
+    int find(int rotation, int x, int y) const;
+
+    // Shortest inputs locking placement `index` of the last generate(),
+    // ending with HardDrop. states[i] is the piece before inputs[i].
+    void path(int index, std::vector<GameAction>& inputs,
+              std::vector<Piece>& states);
+
+    // States reachable in the last generate().
+    int reachableStates() const;
+
+private:
+    static constexpr int X_OFFSET    = BlockTemplate::BLOCK_SIZE - 1;
+    static constexpr int X_SLOTS     = W + X_OFFSET;
+    static constexpr int Y_OFFSET    = BlockTemplate::BLOCK_SIZE;
+    static constexpr int Y_SLOTS     = H + Y_OFFSET;
+    static constexpr int STATE_COUNT = 4 * X_SLOTS * Y_SLOTS;
+
+    static_assert(X_SLOTS <= 32, "lock masks hold one row of x states");
+    static_assert(Y_SLOTS + BlockTemplate::BLOCK_SIZE <= 64,
+                  "state masks hold every row of a column");
+
+    int       type{0};
+    Piece     start;
+    uint64_t  fits[4][X_SLOTS];      // Bit y + Y_OFFSET: the piece fits.
+    uint64_t  reach[4][X_SLOTS];     // Reachable states.
+    uint32_t  landed[4][Y_SLOTS];    // Canonical lock states already listed.
+    int16_t   placementAt[STATE_COUNT]; // Output index of a landed state.
+
+    // Breadth-first search state of path().
+    uint64_t  visited[4][X_SLOTS];
+    uint8_t   depth[STATE_COUNT];    // Inputs to reach a visited state.
+
+    static int stateIndex(int rotation, int x, int y) {
+        return (rotation * X_SLOTS + x + X_OFFSET) * Y_SLOTS + y + Y_OFFSET;
+    }
+    static Piece stateAt(int type, int index);
+
+    // The lowest rotation covering the same cells as (rotation, x, y),
+    // moved so it covers exactly those cells (O, I, S and Z repeat).
+    static void canonical(int type, int& rotation, int& x, int& y);
+
+    // Fill `fits` for the current piece type.
+    void buildFitMasks(const BoardType& board);
+
+    bool fitsAt(int rotation, int x, int y) const {
+        // Kicks can try columns past every slot; those are inside a wall.
+        unsigned slot = static_cast<unsigned>(x + X_OFFSET);
+        if (slot >= static_cast<unsigned>(X_SLOTS)) return false;
+        return (fits[rotation][slot] >> (y + Y_OFFSET)) & 1;
+    }
+
+    // Row reached by a hard drop from (rotation, x, y).
+    int landingRow(int rotation, int x, int y) const {
+        uint64_t below = ~fits[rotation][x + X_OFFSET] >> (y + Y_OFFSET + 1);
+        return y + __builtin_ctzll(below);
+    }
+
+    // Kick used when rotating from (rotation, x, y), or NO_KICK.
+    int rotationKick(int rotation, int x, int y) const;
+
+    // Breadth-first search from `start` until a state whose hard drop
+    // locks placement `index`; returns that state's index or -1.
+    int searchLockState(int index);
+};
+
+using MoveGenerator = BasicMoveGenerator<BOARD_WIDTH, BOARD_HEIGHT>;
+
+// Compiled once in MoveGenerator.cpp, for the BasicBitBoard sizes.
+extern template class BasicMoveGenerator<10, 20>;
+extern template class BasicMoveGenerator<10, 40>;
+extern template class BasicMoveGenerator<15, 20>;
@@ -0,0 +1,71 @@
+#include "Policy.h"
+#include "AutoPlayer.h"
+#include "BeamSearch.h"
+
+template <int W, int H>
+GameAction BasicRandomPolicy<W, H>::nextAction(const BasicGameCore<W, H>&) {
+    static const GameAction ACTIONS[] = {
+        GameAction::None,
+        GameAction::MoveLeft,
+        GameAction::MoveRight,
+        GameAction::Rotate,
+        GameAction::SoftDrop,
+        GameAction::HardDrop
+    };
+    return ACTIONS[rng.below(6)];
+}
+
+template <int W, int H>
+std::unique_ptr<BasicPolicy<W, H>> createPolicy(const std::string& name,
+                                                uint32_t seed,
+                                                const HeuristicWeights& weights,
+                                                SearchBudget budget) {
+    using PolicyPtr = std::unique_ptr<BasicPolicy<W, H>>;
+    if (name == "random") {
+        return PolicyPtr(new BasicRandomPolicy<W, H>(seed));
+    }
+    if (name == "greedy") {
+        return PolicyPtr(new BasicAutoPlayer<W, H>(weights));
+    }
+    if (name == "beam" || name == "beam-mt" || name == "beam-deep") {
+        // beam-mt splits each search over every core; plain beam stays on
+        // one thread so batch runners can parallelise across games instead.
+        // beam-deep also searches the second and third preview pieces.
+        SearchConfig config;
+        config.threads = (name == "beam-mt") ? ThreadPool::hardwareThreads() : 1;
+        if (name == "beam-deep") {
+            config.depth        = 4;
+            config.beamWidth    = 8;
+            config.timeBudgetUs = 20000;
+        }
+        if (budget == SearchBudget::Unlimited) config.timeBudgetUs = 0;
+        return PolicyPtr(new BasicBeamSearchPlayer<W, H>(config, weights));
+    }
+    return PolicyPtr();
+}
+
+template class BasicRandomPolicy<10, 20>;
+template class BasicRandomPolicy<10, 40>;
+template class BasicRandomPolicy<15, 20>;
+
+template std::unique_ptr<BasicPolicy<10, 20>> createPolicy<10, 20>(
+    const std::string&, uint32_t, const HeuristicWeights&, SearchBudget);
+template std::unique_ptr<BasicPolicy<10, 40>> createPolicy<10, 40>(
+    const std::string&, uint32_t, const HeuristicWeights&, SearchBudget);
+template std::unique_ptr<BasicPolicy<15, 20>> createPolicy<15, 20>(
+    const std::string&, uint32_t, const HeuristicWeights&, SearchBudget);
+
+std::vector<std::string> policyNames() {
+    return {"random", "greedy", "beam", "beam-mt", "beam-deep"};
+}
+
+bool isPolicyName(const std::string& name) {
+    for (const std::string& known : policyNames()) {
+        if (name == known) return true;
+    }
+    return false;
+}
+
+std::string batchPolicyName(const std::string& name) {
+    return name == "beam-mt" ? "beam" : name;
+}
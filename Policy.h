@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GameCore.h"
+#include "Heuristic.h"
+
+// A player that chooses one action per logic step from the core state.
+// Templated on the board size like BasicGameCore; Policy plays the game's.
+template <int W, int H>
+class BasicPolicy {
+public:
+    virtual ~BasicPolicy() = default;
+
+    // Action to apply before the next gravity tick.
+    virtual GameAction nextAction(const BasicGameCore<W, H>& core) = 0;
+};
+
+using Policy = BasicPolicy<BOARD_WIDTH, BOARD_HEIGHT>;
+
+// Presses uniformly random keys; a baseline for throughput runs.
+template <int W, int H>
+class BasicRandomPolicy : public BasicPolicy<W, H> {
+public:
+    // The key stream is jumped away from the piece stream of a game with
+    // the same seed, so keys and pieces stay independent.
+    explicit BasicRandomPolicy(uint32_t seed) : rng(seed) { rng.jump(); }
+
+    GameAction nextAction(const BasicGameCore<W, H>& core) override;
+
+private:
+    Xoshiro256 rng;
+};
+
+using RandomPolicy = BasicRandomPolicy<BOARD_WIDTH, BOARD_HEIGHT>;
+
+// Compiled once in Policy.cpp, for the BasicBitBoard sizes.
+extern template class BasicRandomPolicy<10, 20>;
+extern template class BasicRandomPolicy<10, 40>;
+extern template class BasicRandomPolicy<15, 20>;
+
+// How long a bot search may run per move.
+enum class SearchBudget {
+    Unlimited,   // Always searches to the end: moves depend only on the seed.
+    WallClock    // Stops at SearchConfig::timeBudgetUs (interactive play).
+};
+
+// Create a policy for a W x H core by name, or nullptr when the name is
+// unknown. The bot policies score boards with `weights`. Batch runners keep
+// the default Unlimited budget so their games replay identically on any
+// machine load. Defined in Policy.cpp for the BasicBitBoard sizes.
+template <int W, int H>
+std::unique_ptr<BasicPolicy<W, H>> createPolicy(
+    const std::string& name, uint32_t seed,
+    const HeuristicWeights& weights = HeuristicWeights(),
+    SearchBudget budget = SearchBudget::Unlimited);
+
+// The same for the game's own size.
+inline std::unique_ptr<Policy> createPolicy(
+    const std::string& name, uint32_t seed,
+    const HeuristicWeights& weights = HeuristicWeights(),
+    SearchBudget budget = SearchBudget::Unlimited) {
+    return createPolicy<BOARD_WIDTH, BOARD_HEIGHT>(name, seed, weights, budget);
+}
+
+// Names accepted by createPolicy().
+std::vector<std::string> policyNames();
+
+// True if `name` is one of policyNames(); checks a name without building
+// the policy (beam-mt would start a thread pool).
+bool isPolicyName(const std::string& name);
+
+// The policy to run where many games already share the cores (batch
+// runners, the spectator wall): beam-mt becomes beam, the same search on
+// one thread. Other names are returned unchanged.
+std::string batchPolicyName(const std::string& name);
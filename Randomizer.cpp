@@ -0,0 +1,151 @@
+#include "Randomizer.h"
+
+namespace {
+
+uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Piece type indices, same order as BlockTemplate.
+const int TYPE_S = 3;
+const int TYPE_Z = 4;
+
+} // namespace
+
+void Xoshiro256::reseed(uint64_t seed) {
+    for (uint64_t& word : s) word = splitMix64(seed);
+}
+
+uint64_t Xoshiro256::next() {
+    const uint64_t result = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t      = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3]  = rotl(s[3], 45);
+    return result;
+}
+
+uint32_t Xoshiro256::below(uint32_t bound) {
+    // Lemire's multiply-shift; retry the few values that would bias it.
+    uint64_t product = (next() >> 32) * bound;
+    uint32_t low     = static_cast<uint32_t>(product);
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            product = (next() >> 32) * bound;
+            low     = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+void Xoshiro256::jump() {
+    static const uint64_t JUMP[] = {
+        0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+        0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL
+    };
+
+    uint64_t t[4] = {0, 0, 0, 0};
+    for (uint64_t word : JUMP) {
+        for (int b = 0; b < 64; ++b) {
+            if (word & (1ULL << b)) {
+                for (int i = 0; i < 4; ++i) t[i] ^= s[i];
+            }
+            next();
+        }
+    }
+    for (int i = 0; i < 4; ++i) s[i] = t[i];
+}
+
+bool parseRandomizerMode(const std::string& name, RandomizerMode& out) {
+    if (name == "uniform") {
+        out = RandomizerMode::Uniform;
+    } else if (name == "bag") {
+        out = RandomizerMode::Bag;
+    } else if (name == "history") {
+        out = RandomizerMode::History;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* randomizerModeName(RandomizerMode mode) {
+    switch (mode) {
+    case RandomizerMode::Bag:     return "bag";
+    case RandomizerMode::History: return "history";
+    default:                      return "uniform";
+    }
+}
+
+void Randomizer::reset(uint64_t seed, RandomizerMode newMode) {
+    rng.reseed(seed);
+    mode    = newMode;
+    head    = 0;
+    bagLeft = 0;
+
+    // An S or Z first on an empty board forces a hole; start the history
+    // full of them so the history mode rarely opens with one.
+    for (int i = 0; i < HISTORY_SIZE; ++i) {
+        history[i] = static_cast<int8_t>(i % 2 ? TYPE_Z : TYPE_S);
+    }
+
+    for (int i = 0; i < PREVIEW_COUNT; ++i) {
+        queue[i] = static_cast<int8_t>(draw());
+    }
+}
+
+int Randomizer::next() {
+    int type    = queue[head];
+    queue[head] = static_cast<int8_t>(draw());
+    head        = static_cast<uint8_t>((head + 1) % PREVIEW_COUNT);
+    return type;
+}
+
+int Randomizer::draw() {
+    const int types = BlockTemplate::NUM_BLOCK_TYPES;
+
+    switch (mode) {
+    case RandomizerMode::Bag: {
+        if (bagLeft == 0) {
+            for (int i = 0; i < types; ++i) bag[i] = static_cast<int8_t>(i);
+            bagLeft = static_cast<uint8_t>(types);
+        }
+        // Take a random remaining type and fill its slot with the last.
+        int pick  = static_cast<int>(rng.below(bagLeft));
+        int type  = bag[pick];
+        bag[pick] = bag[--bagLeft];
+        return type;
+    }
+
+    case RandomizerMode::History: {
+        int type = 0;
+        for (int roll = 0; roll < HISTORY_ROLLS; ++roll) {
+            type = static_cast<int>(rng.below(types));
+
+            bool recent = false;
+            for (int i = 0; i < HISTORY_SIZE; ++i) {
+                if (history[i] == type) recent = true;
+            }
+            if (!recent) break;
+        }
+        for (int i = 0; i + 1 < HISTORY_SIZE; ++i) history[i] = history[i + 1];
+        history[HISTORY_SIZE - 1] = static_cast<int8_t>(type);
+        return type;
+    }
+
+    default:
+        return static_cast<int>(rng.below(types));
+    }
+}
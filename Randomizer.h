@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "BlockTemplate.h"
+
+// xoshiro256** (Blackman & Vigna): 32 bytes of state, a few cycles per
+// number. jump() advances 2^128 draws, so streams split with it never
+// overlap however long each one runs.
+class Xoshiro256 {
+public:
+    // Any seed, zero included; expanded with SplitMix64.
+    explicit Xoshiro256(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed);
+
+    uint64_t next();
+
+    // Uniform in [0, bound), without modulo bias.
+    uint32_t below(uint32_t bound);
+
+    // Skip 2^128 draws.
+    void jump();
+
+    // A copy of this generator, which then jumps ahead: successive splits
+    // give independent, reproducible streams (one per thread or game).
+    Xoshiro256 split() {
+        Xoshiro256 stream = *this;
+        jump();
+        return stream;
+    }
+
+private:
+    uint64_t s[4];
+};
+
+// How upcoming piece types are drawn.
+enum class RandomizerMode {
+    Uniform,   // Every type equally likely each time.
+    Bag,       // Each run of seven pieces is a shuffled full set.
+    History    // Reroll types seen among the last four pieces (TGM style).
+};
+
+// Parse "uniform", "bag" or "history"; false for anything else.
+bool parseRandomizerMode(const std::string& name, RandomizerMode& out);
+const char* randomizerModeName(RandomizerMode mode);
+
+// Piece type source with a fixed lookahead queue. Plain data with no heap
+// storage, so copying a GameCore (snapshots, search, rollback) copies the
+// whole future of the game in a few dozen bytes.
+class Randomizer {
+public:
+    // Upcoming pieces known at any time.
+    static constexpr int PREVIEW_COUNT = 5;
+
+    explicit Randomizer(uint64_t seed = 0,
+                        RandomizerMode mode = RandomizerMode::Uniform) {
+        reset(seed, mode);
+    }
+
+    void reset(uint64_t seed, RandomizerMode mode);
+
+    // Take the next piece type; the queue refills behind it.
+    int next();
+
+    // Piece type `index` places ahead, 0 = the next one next() returns.
+    int peek(int index) const {
+        return queue[(head + index) % PREVIEW_COUNT];
+    }
+
+    RandomizerMode getMode() const { return mode; }
+
+private:
+    static constexpr int HISTORY_SIZE  = 4;
+    static constexpr int HISTORY_ROLLS = 4;
+
+    Xoshiro256     rng;
+    RandomizerMode mode{RandomizerMode::Uniform};
+
+    int8_t  queue[PREVIEW_COUNT];
+    uint8_t head{0};
+
+    int8_t  bag[BlockTemplate::NUM_BLOCK_TYPES];  // Types left in the bag.
+    uint8_t bagLeft{0};
+
+    int8_t  history[HISTORY_SIZE];                // Most recent last.
+
+    // Draw one type with the current mode.
+    int draw();
+};
@@ -0,0 +1,237 @@
+#include "Replay.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+const char   EVENT_CHARS[] = "-lrwsh";   // Indexed by GameAction.
+const char   TICK_CHAR     = '.';
+const size_t LINE_WIDTH    = 72;
+
+char eventChar(uint8_t event) {
+    if (event == Replay::TICK) return TICK_CHAR;
+    return EVENT_CHARS[event];
+}
+
+bool parseEvent(char c, uint8_t& event) {
+    if (c == TICK_CHAR) {
+        event = Replay::TICK;
+        return true;
+    }
+    for (int i = 1; EVENT_CHARS[i]; ++i) {
+        if (EVENT_CHARS[i] == c) {
+            event = static_cast<uint8_t>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+constexpr uint8_t Replay::TICK;
+constexpr uint8_t Replay::GARBAGE;
+
+void Replay::begin(uint32_t newSeed, RandomizerMode newMode) {
+    seed   = newSeed;
+    mode   = newMode;
+    score  = 0;
+    lines  = 0;
+    pieces = 0;
+    ticks  = 0;
+    events.clear();
+
+    // Room for tens of minutes of play, so recording stays out of the
+    // allocator during a game.
+    events.reserve(1 << 16);
+}
+
+void Replay::finish(const GameCore& core) {
+    score  = core.getScore();
+    lines  = core.getLinesCleared();
+    pieces = core.getPiecesPlaced();
+    ticks  = core.getTickCount();
+}
+
+bool Replay::matches(const GameCore& core) const {
+    return core.getScore() == score && core.getLinesCleared() == lines &&
+           core.getPiecesPlaced() == pieces && core.getTickCount() == ticks;
+}
+
+bool loadReplay(const std::string& path, Replay& replay) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    Replay      loaded;
+    std::string line;
+    bool        inEvents = false;
+    bool        ended    = false;
+    bool        garbage  = false;     // Inside "(rows,hole)".
+    long        garbageRows = -1;
+    while (std::getline(file, line)) {
+        std::string::size_type comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream fields(line);
+        std::string name;
+        if (!(fields >> name)) continue;          // Blank line.
+
+        if (inEvents) {
+            if (name == "end") {
+                ended = true;
+                break;
+            }
+
+            long repeat = 0;
+            for (char c : line) {
+                if (std::isspace(static_cast<unsigned char>(c))) continue;
+                if (c >= '0' && c <= '9') {
+                    repeat = repeat * 10 + (c - '0');
+                    if (repeat > 1000000) return false;
+                    continue;
+                }
+                if (c == '(') {
+                    garbage = true;
+                    if (repeat != 0) return false;
+                    continue;
+                }
+                if (garbage) {
+                    // "(rows,hole)", the digits collected in `repeat`.
+                    if (c == ',') {
+                        garbageRows = repeat;
+                    } else if (c == ')' && garbageRows >= 0 &&
+                               garbageRows < 256 && repeat < 256) {
+                        loaded.recordGarbage(static_cast<int>(garbageRows),
+                                             static_cast<int>(repeat));
+                        garbage     = false;
+                        garbageRows = -1;
+                    } else {
+                        return false;
+                    }
+                    repeat = 0;
+                    continue;
+                }
+
+                uint8_t event;
+                if (!parseEvent(c, event)) return false;
+                loaded.events.insert(loaded.events.end(),
+                                     repeat > 0 ? repeat : 1, event);
+                repeat = 0;
+            }
+            if (repeat != 0 || garbage) return false;   // Unfinished event.
+            continue;
+        }
+
+        if (name == "events") {
+            inEvents = true;
+            continue;
+        }
+
+        std::string value;
+        if (!(fields >> value)) return false;
+        if (name == "randomizer") {
+            if (!parseRandomizerMode(value, loaded.mode)) return false;
+            continue;
+        }
+
+        char* endPtr = nullptr;
+        long  number = std::strtol(value.c_str(), &endPtr, 10);
+        if (*endPtr != '\0') return false;
+
+        if (name == "seed") {
+            loaded.seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (name == "score") {
+            loaded.score = static_cast<int>(number);
+        } else if (name == "lines") {
+            loaded.lines = static_cast<int>(number);
+        } else if (name == "pieces") {
+            loaded.pieces = number;
+        } else if (name == "ticks") {
+            loaded.ticks = number;
+        } else {
+            return false;
+        }
+    }
+    if (!ended) return false;
+
+    replay = loaded;
+    return true;
+}
+
+bool saveReplay(const std::string& path, const Replay& replay) {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    file << "seed "       << replay.seed << '\n'
+         << "randomizer " << randomizerModeName(replay.mode) << '\n'
+         << "score "      << replay.score << '\n'
+         << "lines "      << replay.lines << '\n'
+         << "pieces "     << replay.pieces << '\n'
+         << "ticks "      << replay.ticks << '\n'
+         << "events\n";
+
+    // Run-length encode the events and wrap the lines.
+    std::string row;
+    const std::vector<uint8_t>& events = replay.events;
+    for (size_t i = 0; i < events.size();) {
+        if (events[i] == Replay::GARBAGE && i + 2 < events.size()) {
+            std::string token = "(" + std::to_string(events[i + 1]) + "," +
+                                std::to_string(events[i + 2]) + ")";
+            if (row.size() + token.size() > LINE_WIDTH) {
+                file << row << '\n';
+                row.clear();
+            }
+            row += token;
+            i += 3;
+            continue;
+        }
+
+        size_t run = 1;
+        while (i + run < events.size() && events[i + run] == events[i]) ++run;
+
+        std::string token = run > 1 ? std::to_string(run) : std::string();
+        token += eventChar(events[i]);
+        if (row.size() + token.size() > LINE_WIDTH) {
+            file << row << '\n';
+            row.clear();
+        }
+        row += token;
+        i += run;
+    }
+    if (!row.empty()) file << row << '\n';
+
+    file << "end\n";
+    return static_cast<bool>(file);
+}
+
+void ReplayPlayer::start(GameCore& core) {
+    core.reset(replay.seed, replay.mode);
+    position = 0;
+}
+
+bool ReplayPlayer::nextFrame(GameCore& core, LockResult* lock) {
+    const std::vector<uint8_t>& events = replay.events;
+    if (position >= events.size()) return false;
+
+    if (lock) *lock = LockResult();
+    while (position < events.size()) {
+        uint8_t event = events[position++];
+        if (event == Replay::TICK) {
+            StepResult result = core.tick();
+            if (lock && result.lock.locked) *lock = result.lock;
+            break;
+        }
+        if (event == Replay::GARBAGE) {
+            if (position + 2 > events.size()) break;
+            core.queueGarbage(events[position], events[position + 1]);
+            position += 2;
+            continue;
+        }
+        StepResult result = core.step(static_cast<GameAction>(event));
+        if (lock && result.lock.locked) *lock = result.lock;
+    }
+    return true;
+}
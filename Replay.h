@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "GameCore.h"
+
+// A recorded game: the seed and randomizer mode it started from and every
+// step()/tick() call in order. GameCore is deterministic, so playing the
+// events back on a fresh core reproduces the game exactly.
+//
+// File format (text, '#' starts a comment):
+//   seed 12345
+//   randomizer bag
+//   score 4200
+//   lines 31
+//   pieces 97
+//   ticks 1804
+//   events
+//   4.l.w.3.h.12. ...
+//   end
+// Events are one character each: l r w s h for MoveLeft, MoveRight,
+// Rotate, SoftDrop, HardDrop and '.' for a gravity tick. A decimal count
+// in front repeats the next event. Garbage from a versus opponent is
+// written (rows,hole) where it was queued.
+struct Replay {
+    uint32_t       seed{0};
+    RandomizerMode mode{RandomizerMode::Uniform};
+
+    // Result the recording ended with; playback must reproduce it.
+    int  score{0};
+    int  lines{0};
+    long pieces{0};
+    long ticks{0};
+
+    // Each event is a GameAction value, TICK, or GARBAGE followed by two
+    // bytes: rows and hole column.
+    static constexpr uint8_t TICK    = 0xFF;
+    static constexpr uint8_t GARBAGE = 0xFE;
+    std::vector<uint8_t> events;
+
+    // Start recording a new game.
+    void begin(uint32_t newSeed, RandomizerMode newMode);
+
+    void recordAction(GameAction action) {
+        if (action != GameAction::None) events.push_back(static_cast<uint8_t>(action));
+    }
+    void recordTick() { events.push_back(TICK); }
+    void recordGarbage(int rows, int hole) {
+        events.push_back(GARBAGE);
+        events.push_back(static_cast<uint8_t>(rows));
+        events.push_back(static_cast<uint8_t>(hole));
+    }
+
+    // Copy the final numbers of the game from the core.
+    void finish(const GameCore& core);
+
+    // True when the core ended where the recording did.
+    bool matches(const GameCore& core) const;
+};
+
+// Read or write a replay file; false on I/O or format errors.
+bool loadReplay(const std::string& path, Replay& replay);
+bool saveReplay(const std::string& path, const Replay& replay);
+
+// Feeds a replay into a GameCore one frame at a time. A frame is the
+// actions up to and including the next gravity tick, like one pass of
+// the game loop.
+class ReplayPlayer {
+public:
+    explicit ReplayPlayer(const Replay& replay) : replay(replay) {}
+
+    // Reset the core to the start of the replay.
+    void start(GameCore& core);
+
+    // Apply the next frame; false when the replay has no events left.
+    // `lock`, if given, receives the frame's last lock (`locked` is false
+    // when no piece locked).
+    bool nextFrame(GameCore& core, LockResult* lock = nullptr);
+
+private:
+    const Replay& replay;
+    std::size_t   position{0};
+};
@@ -0,0 +1,266 @@
+#include "SelfPlay.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+void BatchStats::add(const GameResult& result) {
+    score.add(result.score);
+    lines.add(result.lines);
+    pieces.add(static_cast<double>(result.pieces));
+    ticks.add(static_cast<double>(result.ticks));
+
+    scoreDigest.add(result.score);
+    lengthDigest.add(static_cast<double>(result.ticks));
+
+    for (int i = 0; i < 5; ++i) {
+        clearCounts[i] += result.clearCounts[i];
+    }
+    for (int i = 0; i < BlockTemplate::NUM_BLOCK_TYPES; ++i) {
+        pieceCounts[i] += result.pieceCounts[i];
+    }
+}
+
+void BatchStats::merge(const BatchStats& other) {
+    score.merge(other.score);
+    lines.merge(other.lines);
+    pieces.merge(other.pieces);
+    ticks.merge(other.ticks);
+
+    scoreDigest.merge(other.scoreDigest);
+    lengthDigest.merge(other.lengthDigest);
+
+    for (int i = 0; i < 5; ++i) {
+        clearCounts[i] += other.clearCounts[i];
+    }
+    for (int i = 0; i < BlockTemplate::NUM_BLOCK_TYPES; ++i) {
+        pieceCounts[i] += other.pieceCounts[i];
+    }
+}
+
+namespace {
+
+const char* const CLEAR_NAMES[5] = {
+    "none", "single", "double", "triple", "tetris"
+};
+const char* const PIECE_NAMES[BlockTemplate::NUM_BLOCK_TYPES] = {
+    "I", "O", "T", "S", "Z", "J", "L"
+};
+const double QUANTILES[]          = {0.01, 0.10, 0.50, 0.90, 0.99};
+const char* const QUANTILE_NAMES[] = {"p1", "p10", "p50", "p90", "p99"};
+const int NUM_QUANTILES = 5;
+
+void writeJsonMetric(FILE* out, const char* name, const RunningStats& stats,
+                     const TDigest* digest, bool last) {
+    std::fprintf(out,
+        "  \"%s\": {\"mean\": %.4f, \"stddev\": %.4f, "
+        "\"min\": %.0f, \"max\": %.0f",
+        name, stats.mean(), stats.stddev(), stats.min(), stats.max());
+    if (digest) {
+        for (int i = 0; i < NUM_QUANTILES; ++i) {
+            std::fprintf(out, ", \"%s\": %.1f",
+                         QUANTILE_NAMES[i], digest->quantile(QUANTILES[i]));
+        }
+    }
+    std::fprintf(out, "}%s\n", last ? "" : ",");
+}
+
+void writeCsvMetric(FILE* out, const RunningStats& stats,
+                    const TDigest* digest) {
+    std::fprintf(out, ",%.4f,%.4f,%.0f,%.0f",
+                 stats.mean(), stats.stddev(), stats.min(), stats.max());
+    if (digest) {
+        for (int i = 0; i < NUM_QUANTILES; ++i) {
+            std::fprintf(out, ",%.1f", digest->quantile(QUANTILES[i]));
+        }
+    }
+}
+
+void writeCsvHeader(FILE* out, const char* name, bool quantiles) {
+    std::fprintf(out, ",%s_mean,%s_stddev,%s_min,%s_max",
+                 name, name, name, name);
+    if (quantiles) {
+        for (int i = 0; i < NUM_QUANTILES; ++i) {
+            std::fprintf(out, ",%s_%s", name, QUANTILE_NAMES[i]);
+        }
+    }
+}
+
+} // namespace
+
+void BatchStats::writeJson(FILE* out) const {
+    std::fprintf(out, "{\n  \"games\": %lld,\n", games());
+    writeJsonMetric(out, "score",  score,  &scoreDigest,  false);
+    writeJsonMetric(out, "lines",  lines,  nullptr,       false);
+    writeJsonMetric(out, "pieces", pieces, nullptr,       false);
+    writeJsonMetric(out, "ticks",  ticks,  &lengthDigest, false);
+
+    std::fprintf(out, "  \"clears\": {");
+    for (int i = 0; i < 5; ++i) {
+        std::fprintf(out, "%s\"%s\": %lld",
+                     i ? ", " : "", CLEAR_NAMES[i], clearCounts[i]);
+    }
+    std::fprintf(out, "},\n  \"pieces_by_type\": {");
+    for (int i = 0; i < BlockTemplate::NUM_BLOCK_TYPES; ++i) {
+        std::fprintf(out, "%s\"%s\": %lld",
+                     i ? ", " : "", PIECE_NAMES[i], pieceCounts[i]);
+    }
+    std::fprintf(out, "}\n}\n");
+}
+
+void BatchStats::writeCsv(FILE* out) const {
+    std::fprintf(out, "games");
+    writeCsvHeader(out, "score",  true);
+    writeCsvHeader(out, "lines",  false);
+    writeCsvHeader(out, "pieces", false);
+    writeCsvHeader(out, "ticks",  true);
+    for (int i = 0; i < 5; ++i) {
+        std::fprintf(out, ",clear_%s", CLEAR_NAMES[i]);
+    }
+    for (int i = 0; i < BlockTemplate::NUM_BLOCK_TYPES; ++i) {
+        std::fprintf(out, ",piece_%s", PIECE_NAMES[i]);
+    }
+
+    std::fprintf(out, "\n%lld", games());
+    writeCsvMetric(out, score,  &scoreDigest);
+    writeCsvMetric(out, lines,  nullptr);
+    writeCsvMetric(out, pieces, nullptr);
+    writeCsvMetric(out, ticks,  &lengthDigest);
+    for (int i = 0; i < 5; ++i) {
+        std::fprintf(out, ",%lld", clearCounts[i]);
+    }
+    for (int i = 0; i < BlockTemplate::NUM_BLOCK_TYPES; ++i) {
+        std::fprintf(out, ",%lld", pieceCounts[i]);
+    }
+    std::fprintf(out, "\n");
+}
+
+template <int W, int H>
+GameResult playGame(uint32_t seed, BasicPolicy<W, H>& policy, long maxPieces,
+                    RandomizerMode mode) {
+    BasicGameCore<W, H> core(seed, mode);
+    GameResult          result;
+
+    // One player action, then one gravity tick, like a frame of run().
+    while (!core.isGameOver()) {
+        if (maxPieces > 0 && core.getPiecesPlaced() >= maxPieces) break;
+
+        StepResult step = core.step(policy.nextAction(core));
+        if (step.lock.locked) {
+            ++result.clearCounts[step.lock.linesCleared];
+            ++result.pieceCounts[step.lock.pieceType];
+        }
+
+        StepResult fall = core.tick();
+        if (fall.lock.locked) {
+            ++result.clearCounts[fall.lock.linesCleared];
+            ++result.pieceCounts[fall.lock.pieceType];
+        }
+    }
+
+    result.seed   = seed;
+    result.score  = core.getScore();
+    result.lines  = core.getLinesCleared();
+    result.pieces = core.getPiecesPlaced();
+    result.ticks  = core.getTickCount();
+    return result;
+}
+
+template GameResult playGame(uint32_t, BasicPolicy<10, 20>&, long,
+                             RandomizerMode);
+template GameResult playGame(uint32_t, BasicPolicy<10, 40>&, long,
+                             RandomizerMode);
+template GameResult playGame(uint32_t, BasicPolicy<15, 20>&, long,
+                             RandomizerMode);
+
+namespace {
+
+template <int W, int H>
+BatchStats runSelfPlayOn(const SelfPlayConfig& config) {
+    BatchStats total;
+
+    long perTask   = std::max(1L, config.gamesPerTask);
+    long taskCount = (config.games + perTask - 1) / perTask;
+
+    {
+        ThreadPool pool(config.threads);
+
+        // One accumulator per task, merged into the total in task order as
+        // soon as every earlier task has been merged: t-digest merges
+        // depend on their order, so the report must not depend on which
+        // worker ran which task. At most `window` tasks past the merge
+        // cursor are submitted at any time, and the next ones only as the
+        // cursor advances, so no more than that many accumulators wait in
+        // memory whatever the game count.
+        long window = std::min(taskCount, 2L * pool.size());
+        std::vector<std::unique_ptr<BatchStats>> finished(window);
+        long       nextMerge  = 0;
+        long       nextSubmit = 0;
+        std::mutex mergeMutex;
+
+        // Called with mergeMutex held (or before any task runs).
+        std::function<void()> fillWindow;
+        fillWindow = [&]() {
+            for (; nextSubmit < taskCount && nextSubmit < nextMerge + window;
+                 ++nextSubmit) {
+                long task = nextSubmit;
+                pool.submit([&, task](int) {
+                    long first = task * perTask;
+                    long last  = std::min(config.games, first + perTask);
+
+                    std::unique_ptr<BatchStats> local(new BatchStats());
+                    for (long game = first; game < last; ++game) {
+                        uint32_t seed = config.firstSeed +
+                                        static_cast<uint32_t>(game);
+
+                        // The policy is seeded from the game seed so results
+                        // do not depend on which worker picked the game up.
+                        std::unique_ptr<BasicPolicy<W, H>> policy =
+                            createPolicy<W, H>(
+                                batchPolicyName(config.policyName),
+                                seed ^ 0x9E3779B9u, config.weights);
+                        local->add(playGame(seed, *policy, config.maxPieces,
+                                            config.randomizer));
+                    }
+
+                    std::lock_guard<std::mutex> lock(mergeMutex);
+                    finished[task % window] = std::move(local);
+                    while (nextMerge < nextSubmit &&
+                           finished[nextMerge % window]) {
+                        total.merge(*finished[nextMerge % window]);
+                        finished[nextMerge % window].reset();
+                        ++nextMerge;
+                    }
+                    fillWindow();
+                });
+            }
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(mergeMutex);
+            fillWindow();
+        }
+        pool.wait();
+    }
+    return total;
+}
+
+} // namespace
+
+BatchStats runSelfPlay(const SelfPlayConfig& config) {
+    if (config.games <= 0 || !isPolicyName(config.policyName)) return BatchStats();
+
+    if (config.boardWidth == 10 && config.boardHeight == 20) {
+        return runSelfPlayOn<10, 20>(config);
+    }
+    if (config.boardWidth == 10 && config.boardHeight == 40) {
+        return runSelfPlayOn<10, 40>(config);
+    }
+    if (config.boardWidth == BOARD_WIDTH && config.boardHeight == BOARD_HEIGHT) {
+        return runSelfPlayOn<BOARD_WIDTH, BOARD_HEIGHT>(config);
+    }
+    return BatchStats();
+}
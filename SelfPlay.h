@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "BlockTemplate.h"
+#include "Policy.h"
+#include "Stats.h"
+
+// Settings for a batch of headless games.
+struct SelfPlayConfig {
+    std::string policyName{"random"};
+    uint32_t    firstSeed{1};      // Games use seeds firstSeed .. firstSeed+games-1.
+    long        games{1000};
+    int         threads{0};        // 0 = all hardware threads.
+    long        maxPieces{0};      // Stop a game after this many locks (0 = no cap).
+    long        gamesPerTask{64};  // Games handed to a worker at once.
+    HeuristicWeights weights;      // Board weights of the bot policies.
+    RandomizerMode randomizer{RandomizerMode::Uniform}; // Piece type source.
+    int         boardWidth{BOARD_WIDTH};   // One of the BasicBitBoard sizes.
+    int         boardHeight{BOARD_HEIGHT};
+};
+
+// Final numbers of one game.
+struct GameResult {
+    uint32_t seed{0};
+    int      score{0};
+    int      lines{0};
+    long     pieces{0};
+    long     ticks{0};             // Game length in logic ticks.
+
+    // Locks by number of rows cleared: [0] no clear, [1] single .. [4] tetris.
+    long     clearCounts[5]{};
+    // Locked pieces by type (I, O, T, S, Z, J, L).
+    long     pieceCounts[BlockTemplate::NUM_BLOCK_TYPES]{};
+};
+
+// Streaming aggregate over any number of games in constant memory.
+// Each task of a batch keeps its own copy; runSelfPlay() merges them in
+// task order, so the quantiles do not depend on the thread count.
+struct BatchStats {
+    RunningStats score;
+    RunningStats lines;
+    RunningStats pieces;
+    RunningStats ticks;
+
+    TDigest      scoreDigest;      // Score quantiles.
+    TDigest      lengthDigest;     // Survival length quantiles (ticks).
+
+    long long    clearCounts[5]{};
+    long long    pieceCounts[BlockTemplate::NUM_BLOCK_TYPES]{};
+
+    long long games() const { return score.count(); }
+
+    void add(const GameResult& result);
+    void merge(const BatchStats& other);
+
+    // Machine-readable reports.
+    void writeJson(FILE* out) const;
+    void writeCsv(FILE* out) const;
+};
+
+// Play one game to the end (or to maxPieces) with the given policy, on
+// the policy's board size. Defined in SelfPlay.cpp for the BasicBitBoard
+// sizes.
+template <int W, int H>
+GameResult playGame(uint32_t seed, BasicPolicy<W, H>& policy, long maxPieces,
+                    RandomizerMode mode = RandomizerMode::Uniform);
+
+// Play config.games games spread over a work-stealing pool. The stats are
+// the same for any thread count.
+// Returns empty stats when the policy name or the board size is unknown.
+BatchStats runSelfPlay(const SelfPlayConfig& config);
@@ -0,0 +1,112 @@
+#include "SpectatorClient.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "BlockTemplate.h"
+#include "GameCore.h"
+
+SpectatorClient::SpectatorClient(const std::string& spectateAddress)
+    : address(spectateAddress) {
+}
+
+bool SpectatorClient::decodeInput(bool& changed) {
+    size_t at = 0;
+    while (input.size() - at >= 4) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(input.data() + at);
+        size_t length = p[0] | p[1] << 8 | p[2] << 16 | static_cast<size_t>(p[3]) << 24;
+        if (length > MAX_MESSAGE) return false;
+        if (input.size() - at - 4 < length) break;
+        if (!decodeFrame(p + 4, length, frame, synced)) return false;
+        at     += 4 + length;
+        changed = true;
+    }
+    input.erase(0, at);
+    return true;
+}
+
+void SpectatorClient::draw() {
+    // Locked cells, then the ghost and the piece as the game composes them.
+    std::memcpy(board.grid, frame.cells, sizeof(board.grid));
+    board.recomputeHash();
+    if (!frame.gameOver) composeBoard(board, frame.piece, true);
+
+    state.score        = frame.score;
+    state.level        = frame.level;
+    state.linesCleared = frame.lines;
+    state.paused       = frame.paused;
+    state.panelLines.resize(4);
+    state.panelLines[0] = " WATCHING";
+    state.panelLines[1] = " #";
+    appendInt(state.panelLines[1], frame.seq);
+    state.panelLines[2].clear();
+    state.panelLines[3] = frame.gameOver ? " GAME OVER" : frame.paused ? " PAUSED" : "";
+
+    if (frame.nextType != previewType) {
+        renderPiecePreview(frame.nextType, preview);
+        previewType = frame.nextType;
+    }
+    board.draw(state, preview, frameBuffer);
+}
+
+bool SpectatorClient::run(std::string& error) {
+    int fd = connectTo(address, error);
+    if (fd < 0) return false;
+
+    BlockTemplate::initializeTemplates();
+
+    // Raw keyboard for Q; hidden cursor.
+    termios original{};
+    bool    terminal = tcgetattr(STDIN_FILENO, &original) == 0;
+    if (terminal) {
+        termios raw = original;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+    }
+    std::cout << "\033[?25l\033[2J\033[1;1HWaiting for " << address << "...";
+    std::cout.flush();
+
+    bool ok     = true;
+    bool closed = false;
+    char chunk[4096];
+    pollfd fds[2] = {{fd, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+    while (!closed) {
+        if (poll(fds, terminal ? 2 : 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (terminal && (fds[1].revents & POLLIN)) {
+            char key = 0;
+            if (read(STDIN_FILENO, &key, 1) == 1 && (key == 'q' || key == 'Q')) break;
+        }
+        if (!(fds[0].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n <= 0) {
+            closed = true;
+        } else {
+            input.append(chunk, static_cast<size_t>(n));
+        }
+
+        // Only the newest of the frames that arrived together is drawn.
+        bool changed = false;
+        if (!decodeInput(changed)) {
+            error = "Corrupt broadcast stream from " + address;
+            ok    = false;
+            break;
+        }
+        if (changed && synced) draw();
+    }
+    close(fd);
+
+    std::cout << "\033[0m\033[?25h\n";
+    if (ok && closed) std::cout << "The game at " << address << " closed the broadcast.\n";
+    std::cout.flush();
+    if (terminal) tcsetattr(STDIN_FILENO, TCSAFLUSH, &original);
+    return ok;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+
+#include "Board.h"
+#include "Broadcast.h"
+#include "GameState.h"
+
+// Watches a game published by a BroadcastServer: connects read-only,
+// applies the keyframes and deltas as they come and draws the newest
+// frame the way the game draws its own, ghost piece included. Nothing is
+// ever sent back, and the player's terminal is not involved at all.
+class SpectatorClient {
+public:
+    explicit SpectatorClient(const std::string& address);
+
+    // Watch until Q is pressed or the game closes the connection. False
+    // with `error` set when the connection fails or the stream is corrupt.
+    bool run(std::string& error);
+
+private:
+    // Messages longer than this are a corrupt stream, not a frame.
+    static constexpr size_t MAX_MESSAGE = 64 * 1024;
+
+    std::string    address;
+    SpectatorFrame frame;
+    bool           synced{false};      // A keyframe arrived.
+    std::string    input;              // Bytes not yet decoded.
+
+    Board          board;              // Display buffer.
+    GameState      state;
+    std::string    preview[4];
+    int            previewType{-1};
+    std::string    frameBuffer;
+
+    // Decode every whole message in `input`; false on a corrupt one.
+    bool decodeInput(bool& changed);
+    void draw();
+};
@@ -0,0 +1,210 @@
+#include "SpectatorWall.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void writeAll(const std::string& text) {
+    size_t done = 0;
+    while (done < text.size()) {
+        ssize_t n = write(STDOUT_FILENO, text.data() + done, text.size() - done);
+        if (n <= 0) return;
+        done += static_cast<size_t>(n);
+    }
+}
+
+} // namespace
+
+SpectatorWall::SpectatorWall(const WallConfig& wallConfig)
+    : config(wallConfig) {
+    if (config.games < 1)           config.games = 1;
+    if (config.ticksPerSecond < 1)  config.ticksPerSecond = 1;
+    if (config.framesPerSecond < 1) config.framesPerSecond = 1;
+}
+
+void SpectatorWall::startGame(Seat& seat, uint32_t seed) {
+    seat.seed   = seed;
+    seat.core.reset(seed, config.randomizer);
+    seat.policy = createPolicy(batchPolicyName(config.policyName), seed,
+                               config.weights);
+}
+
+void SpectatorWall::advance(Seat& seat, int ticks) {
+    // One bot action, then one gravity tick, like a frame of the game.
+    for (int t = 0; t < ticks; ++t) {
+        if (seat.core.isGameOver()) {
+            seat.bestScore = std::max(seat.bestScore, seat.core.getScore());
+            ++seat.gamesFinished;
+            startGame(seat, seat.seed + static_cast<uint32_t>(config.games));
+        }
+        seat.core.step(seat.policy->nextAction(seat.core));
+        seat.core.tick();
+    }
+}
+
+void SpectatorWall::simulate(int ticks) {
+    if (ticks <= 0) return;
+
+    // Contiguous shards, one task per worker; the boards never interact.
+    int count  = static_cast<int>(seats.size());
+    int shards = std::min(pool->size(), count);
+    for (int s = 0; s < shards; ++s) {
+        int first = count * s / shards;
+        int last  = count * (s + 1) / shards;
+        pool->submit([this, first, last, ticks](int) {
+            for (int i = first; i < last; ++i) advance(seats[i], ticks);
+        });
+    }
+    pool->wait();
+}
+
+bool SpectatorWall::layout() {
+    int columns, rows;
+    terminalSize(columns, rows);
+    if (columns == screenColumns && rows == screenRows) return false;
+    screenColumns = columns;
+    screenRows    = rows;
+
+    // Row 1 is the status line; tiles below it, as many as fit.
+    int tileColumns = std::max(1, (columns + 1) / (TILE_WIDTH + 1));
+    int tileRows    = std::max(1, rows / (TILE_HEIGHT + 1));
+    visibleTiles    = std::min(static_cast<int>(seats.size()), tileColumns * tileRows);
+
+    compositor.setLayout(visibleTiles, tileColumns, 2);
+    for (Seat& seat : seats) seat.drawn = false;
+    return true;
+}
+
+int SpectatorWall::drawTiles(std::string& out) {
+    int changed = 0;
+    char label[64];
+    for (int i = 0; i < visibleTiles; ++i) {
+        Seat& seat = seats[i];
+        const GameCore& core = seat.core;
+
+        // Boards whose position, score and game count are unchanged are
+        // not rendered at all.
+        uint64_t key = core.hash() ^
+                       static_cast<uint64_t>(core.getScore()) * 0x9E3779B97F4A7C15ULL ^
+                       static_cast<uint64_t>(seat.gamesFinished) << 48;
+        if (seat.drawn && key == seat.drawnKey) continue;
+        seat.drawn    = true;
+        seat.drawnKey = key;
+
+        std::snprintf(label, sizeof(label), "#%d %d L%d", i + 1,
+                      core.getScore(), core.getLinesCleared());
+        renderBoardTile(core, label, tileLines);
+        compositor.update(i, tileLines, out);
+        ++changed;
+    }
+    return changed;
+}
+
+bool SpectatorWall::run() {
+    if (!isPolicyName(config.policyName)) return false;
+
+    BlockTemplate::initializeTemplates();
+    seats.clear();
+    seats.resize(config.games);
+    for (int i = 0; i < config.games; ++i) {
+        startGame(seats[i], config.firstSeed + static_cast<uint32_t>(i));
+    }
+    pool.reset(new ThreadPool(config.threads));
+
+    // Raw, non-blocking keyboard; hidden cursor.
+    termios original{};
+    tcgetattr(STDIN_FILENO, &original);
+    termios raw = original;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN]  = 0;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+    int flags = fcntl(STDIN_FILENO, F_GETFL, 0);
+    fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
+    writeAll("\033[?25l\033[2J");
+
+    const Clock::duration frameTime = std::chrono::microseconds(1000000 / config.framesPerSecond);
+    // At most this many ticks per board per frame; beyond it the games
+    // slow down rather than the screen freezing.
+    const long maxCatchUp = std::max(1, 4 * config.ticksPerSecond / config.framesPerSecond);
+
+    Clock::time_point start     = Clock::now();
+    Clock::time_point nextFrame = start;
+    Clock::time_point fpsStart  = start;
+    long long ticksDone  = 0;
+    long long ticksBehind = 0;      // Ticks given up to the catch-up limit.
+    int       framesShown = 0;
+    double    fps         = 0.0;
+    std::string out;
+
+    for (;;) {
+        char key = 0;
+        if (read(STDIN_FILENO, &key, 1) == 1 && (key == 'q' || key == 'Q')) break;
+
+        Clock::time_point now = Clock::now();
+        long long target = std::chrono::duration_cast<std::chrono::microseconds>(
+                               now - start).count() * config.ticksPerSecond / 1000000 -
+                           ticksBehind;
+        long long due = target - ticksDone;
+        if (due > maxCatchUp) {
+            ticksBehind += due - maxCatchUp;
+            due = maxCatchUp;
+        }
+        simulate(static_cast<int>(due));
+        ticksDone += due;
+
+        out.clear();
+        if (layout()) {
+            out += "\033[2J";
+            compositor.invalidate();
+        }
+        drawTiles(out);
+
+        ++framesShown;
+        double window = std::chrono::duration<double>(now - fpsStart).count();
+        if (window >= 1.0) {
+            fps         = framesShown / window;
+            framesShown = 0;
+            fpsStart    = now;
+        }
+
+        long finished = 0;
+        int  best     = 0;
+        for (const Seat& seat : seats) {
+            finished += seat.gamesFinished;
+            best = std::max(best, std::max(seat.bestScore, seat.core.getScore()));
+        }
+        char status[200];
+        std::snprintf(status, sizeof(status),
+                      "\033[1;1H\033[0m %d boards (%d shown), %s | %d ticks/s%s | "
+                      "%.1f fps | %ld games over | best %d | Q quits\033[K",
+                      config.games, visibleTiles, config.policyName.c_str(),
+                      config.ticksPerSecond, ticksBehind > 0 ? " (behind)" : "",
+                      fps, finished, best);
+        out += status;
+        writeAll(out);
+
+        // Late frames are dropped, not made up in a burst.
+        nextFrame += frameTime;
+        now = Clock::now();
+        if (nextFrame < now) {
+            nextFrame = now;
+        } else {
+            usleep(static_cast<useconds_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(nextFrame - now).count()));
+        }
+    }
+
+    writeAll("\033[0m\033[2J\033[1;1H\033[?25h");
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &original);
+    fcntl(STDIN_FILENO, F_SETFL, flags);
+    pool.reset();
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GameCore.h"
+#include "Heuristic.h"
+#include "Policy.h"
+#include "ThreadPool.h"
+#include "TileRenderer.h"
+
+// Settings of a spectator wall.
+struct WallConfig {
+    int         games{16};            // Boards running at once.
+    std::string policyName{"greedy"}; // Bot playing every board.
+    HeuristicWeights weights;
+    uint32_t    firstSeed{1};         // Board i starts with seed firstSeed + i.
+    RandomizerMode randomizer{RandomizerMode::Uniform};
+    int         ticksPerSecond{30};   // Logic ticks of every board per second.
+    int         framesPerSecond{30};  // Target screen refresh rate.
+    int         threads{0};           // Simulation workers, 0 = all cores.
+};
+
+// K independent bot games shown tiled in one terminal. The boards are
+// simulated in parallel shards on a thread pool; each frame redraws only
+// the tiles, and within them the lines, that changed. Simulation runs on
+// the wall clock, so when K boards take longer than a frame to simulate
+// and draw the frame rate drops while the games keep their speed (up to
+// a catch-up limit, after which the games slow down instead).
+class SpectatorWall {
+public:
+    explicit SpectatorWall(const WallConfig& config);
+
+    // Run until Q is pressed. False when the policy name is unknown.
+    bool run();
+
+private:
+    // One board of the wall and the bot playing it.
+    struct Seat {
+        GameCore                core;
+        std::unique_ptr<Policy> policy;
+        uint32_t                seed{0};
+        long                    gamesFinished{0};
+        int                     bestScore{0};
+        uint64_t                drawnKey{0};    // State shown on screen.
+        bool                    drawn{false};
+    };
+
+    WallConfig               config;
+    std::vector<Seat>        seats;
+    std::unique_ptr<ThreadPool> pool;
+    TileCompositor           compositor;
+    std::vector<std::string> tileLines;
+    int                      visibleTiles{0};
+
+    int                      screenColumns{0};
+    int                      screenRows{0};
+
+    void startGame(Seat& seat, uint32_t seed);
+    void simulate(int ticks);
+    void advance(Seat& seat, int ticks);
+    bool layout();
+    int  drawTiles(std::string& out);
+};
@@ -0,0 +1,179 @@
+#include "Stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// k1 scale function and its inverse: centroids near the tails stay small.
+double scaleK(double q, double compression) {
+    return compression / (2.0 * PI) * std::asin(2.0 * q - 1.0);
+}
+
+double scaleKInverse(double k, double compression) {
+    double angle = k * 2.0 * PI / compression;
+    if (angle >= PI / 2.0) return 1.0;
+    return (std::sin(angle) + 1.0) / 2.0;
+}
+
+} // namespace
+
+// \=== RunningStats ===
+
+void RunningStats::add(double x) {
+    if (n == 0) {
+        lo = hi = x;
+    } else {
+        lo = std::min(lo, x);
+        hi = std::max(hi, x);
+    }
+
+    ++n;
+    double delta = x - mu;
+    mu += delta / static_cast<double>(n);
+    m2 += delta * (x - mu);
+}
+
+void RunningStats::merge(const RunningStats& other) {
+    if (other.n == 0) return;
+    if (n == 0) {
+        *this = other;
+        return;
+    }
+
+    // Chan et al. parallel combination.
+    double total = static_cast<double>(n + other.n);
+    double delta = other.mu - mu;
+    mu += delta * static_cast<double>(other.n) / total;
+    m2 += other.m2 +
+          delta * delta * static_cast<double>(n) *
+          static_cast<double>(other.n) / total;
+    n  += other.n;
+    lo = std::min(lo, other.lo);
+    hi = std::max(hi, other.hi);
+}
+
+double RunningStats::variance() const {
+    return n > 1 ? m2 / static_cast<double>(n - 1) : 0.0;
+}
+
+double RunningStats::stddev() const {
+    return std::sqrt(variance());
+}
+
+// \=== TDigest ===
+
+TDigest::TDigest(double compression)
+    : compression(compression),
+      bufferLimit(static_cast<size_t>(compression * 5.0)) {
+    centroids.reserve(static_cast<size_t>(compression * 2.0));
+    buffer.reserve(bufferLimit);
+}
+
+void TDigest::add(double x, double weight) {
+    if (totalWeight() == 0.0) {
+        lo = hi = x;
+    } else {
+        lo = std::min(lo, x);
+        hi = std::max(hi, x);
+    }
+
+    Centroid point = {x, weight};
+    buffer.push_back(point);
+    bufferedWeight += weight;
+
+    if (buffer.size() >= bufferLimit) flush();
+}
+
+void TDigest::merge(const TDigest& other) {
+    if (other.totalWeight() == 0.0) return;
+
+    if (totalWeight() == 0.0) {
+        lo = other.lo;
+        hi = other.hi;
+    } else {
+        lo = std::min(lo, other.lo);
+        hi = std::max(hi, other.hi);
+    }
+
+    other.flush();
+    for (const Centroid& c : other.centroids) {
+        buffer.push_back(c);
+        bufferedWeight += c.weight;
+        if (buffer.size() >= bufferLimit) flush();
+    }
+}
+
+void TDigest::flush() const {
+    if (buffer.empty()) return;
+
+    buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+    std::sort(buffer.begin(), buffer.end(),
+              [](const Centroid& a, const Centroid& b) {
+                  return a.mean < b.mean;
+              });
+
+    double total = processedWeight + bufferedWeight;
+    centroids.clear();
+
+    // Greedily merge neighbours while the centroid stays within one unit
+    // of the scale function.
+    Centroid current     = buffer[0];
+    double   weightSoFar = 0.0;
+    double   limit       = total * scaleKInverse(
+        scaleK(0.0, compression) + 1.0, compression);
+
+    for (size_t i = 1; i < buffer.size(); ++i) {
+        const Centroid& next = buffer[i];
+        if (weightSoFar + current.weight + next.weight <= limit) {
+            double merged = current.weight + next.weight;
+            current.mean += (next.mean - current.mean) * next.weight / merged;
+            current.weight = merged;
+        } else {
+            weightSoFar += current.weight;
+            centroids.push_back(current);
+            limit = total * scaleKInverse(
+                scaleK(weightSoFar / total, compression) + 1.0, compression);
+            current = next;
+        }
+    }
+    centroids.push_back(current);
+
+    buffer.clear();
+    processedWeight = total;
+    bufferedWeight  = 0.0;
+}
+
+double TDigest::quantile(double q) const {
+    flush();
+    if (centroids.empty()) return 0.0;
+    if (centroids.size() == 1) return centroids[0].mean;
+
+    q = std::min(1.0, std::max(0.0, q));
+    double index = q * processedWeight;
+
+    // Interpolate between centroid centres; the ends use min and max.
+    double cumulative = 0.0;
+    for (size_t i = 0; i < centroids.size(); ++i) {
+        double center = cumulative + centroids[i].weight / 2.0;
+        if (index < center) {
+            if (i == 0) {
+                double t = center > 0.0 ? index / center : 0.0;
+                return lo + t * (centroids[0].mean - lo);
+            }
+            double prevCenter = cumulative - centroids[i - 1].weight / 2.0;
+            double t = (index - prevCenter) / (center - prevCenter);
+            return centroids[i - 1].mean +
+                   t * (centroids[i].mean - centroids[i - 1].mean);
+        }
+        cumulative += centroids[i].weight;
+    }
+
+    const Centroid& last = centroids.back();
+    double lastCenter = processedWeight - last.weight / 2.0;
+    double span       = processedWeight - lastCenter;
+    double t = span > 0.0 ? (index - lastCenter) / span : 1.0;
+    return last.mean + t * (hi - last.mean);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Streaming mean / variance / min / max (Welford), mergeable across workers.
+class RunningStats {
+public:
+    void add(double x);
+    void merge(const RunningStats& other);
+
+    long long count() const { return n; }
+    double mean() const     { return n > 0 ? mu : 0.0; }
+    double variance() const;           // Sample variance.
+    double stddev() const;
+    double min() const      { return n > 0 ? lo : 0.0; }
+    double max() const      { return n > 0 ? hi : 0.0; }
+
+private:
+    long long n{0};
+    double    mu{0.0};
+    double    m2{0.0};
+    double    lo{0.0};
+    double    hi{0.0};
+};
+
+// Merging t-digest quantile sketch (Dunning, k1 scale function).
+// Memory is bounded by the compression factor, not by the sample count,
+// and two digests merge into one with the same accuracy guarantees.
+class TDigest {
+public:
+    explicit TDigest(double compression = 100.0);
+
+    void add(double x, double weight = 1.0);
+    void merge(const TDigest& other);
+
+    // Estimated value at quantile q in [0, 1].
+    double quantile(double q) const;
+
+    double totalWeight() const { return processedWeight + bufferedWeight; }
+
+private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    double compression;
+    std::size_t bufferLimit;
+
+    // Folding the buffer in is invisible to callers, hence mutable.
+    mutable std::vector<Centroid> centroids;
+    mutable std::vector<Centroid> buffer;
+    mutable double                processedWeight{0.0};
+    mutable double                bufferedWeight{0.0};
+
+    double lo{0.0};
+    double hi{0.0};
+
+    void flush() const;
+};
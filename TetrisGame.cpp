@@ -9,13 +9,15 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
+#include <random>
 
 static const string HIGH_SCORE_FILE = "highscores.txt";
 
 TetrisGame::TetrisGame() {
     random_device rd;
-    rng.seed(rd());
+    rng.reseed((static_cast<uint64_t>(rd()) << 32) | rd());
     loadHighScores();
 }
 
@@ -46,7 +48,7 @@ void TetrisGame::drawStartScreen() {
     // Clear screen and move cursor to top\-left.
     screen += "\033[2J\033[1;1H";
 
-    int totalWidth = (BOARD_WIDTH * 2) + 13; // Match in\-game layout.
+    int totalWidth = (BOARD_WIDTH * 2) + PANEL_WIDTH; // Match in\-game layout.
 
     // Top border.
     screen += "╔";
@@ -166,7 +168,7 @@ void TetrisGame::drawGameOverScreen(int rank) {
     // Xóa màn hình
     screen += "\033[2J\033[1;1H";
 
-    int totalWidth = (BOARD_WIDTH * 2) + 13;
+    int totalWidth = (BOARD_WIDTH * 2) + PANEL_WIDTH;
 
     // Top border
     screen += "╔";
@@ -179,7 +181,7 @@ void TetrisGame::drawGameOverScreen(int rank) {
     screen += "║\n";
 
     // "GAME OVER" title
-    const string title = "GAME OVER";
+    const string title = versusResult.empty() ? "GAME OVER" : versusResult;
     int titlePadding        = totalWidth - static_cast<int>(title.length());
     int titleLeft           = titlePadding / 2;
     int titleRight          = titlePadding - titleLeft;
@@ -327,18 +329,21 @@ void TetrisGame::resetGame() {
     state.running      = true;
     state.paused       = false;
     state.quitByUser   = false;
-    state.score        = 0;
-    state.level        = 1;
-    state.linesCleared = 0;
-
-    board.init();
-    dropCounter = 0;
-
-    // Lấy ngẫu nhiên loại block
-    uniform_int_distribution<int> dist(0,
-        BlockTemplate::NUM_BLOCK_TYPES - 1);
-    nextPieceType = dist(rng);
-    spawnNewPiece();
+
+    // Mỗi ván chơi dùng một seed mới cho core
+    uint32_t seed = static_cast<uint32_t>(rng.next());
+    core.reset(seed, randomizerMode);
+    if (!recordPath.empty()) {
+        recording.begin(seed, randomizerMode);
+    }
+    if (!versusPolicy.empty()) {
+        startVersus(seed);
+    }
+    board = core.getBoard();
+    animator.clear();
+
+    syncState();
+    updateDifficulty();
 }
 
 // \=== Terminal raw mode handling ===
@@ -395,305 +400,130 @@ void TetrisGame::flushInput() const {
 
 // \=== Game logic ===
 
-void TetrisGame::animateGameOver() {
-    // Chuyển tất cả các block đã khóa thành '#' từ dưới lên để tạo hiệu ứng sóng
-    for (int y = BOARD_HEIGHT - 1; y >= 0; --y) {
-        bool hasBlock = false;
-        for (int x = 0; x < BOARD_WIDTH; ++x) {
-            if (board.grid[y][x] != ' ') {
-                hasBlock = true;
-                board.grid[y][x] = '#';
-
-                string preview[4];
-                getNextPiecePreview(preview);
-                board.draw(state, preview);
-
-                usleep(ANIM_DELAY_US);
-            }
-        }
-
-        if (!hasBlock) {
-            // Bỏ qua các hàng trống
-            continue;
-        }
-    }
-
-    flushInput();
-    usleep(500000); // Dừng 0.5s để người chơi thấy frame cuối cùng
+void TetrisGame::playEnding() {
+    // Thua thì có hiệu ứng sóng; thắng trận versus chỉ giữ frame cuối
+    animator.gameOver(core.isGameOver());
     flushInput();
-}
-
-bool TetrisGame::isInsidePlayfield(int x, int y) const {
-    // Kiểm tra xem tọa độ có nằm trong playfield không
-    return x >= 0 && x < BOARD_WIDTH && y >= 0 && y < BOARD_HEIGHT;
-}
-
-Piece TetrisGame::calculateGhostPiece() const {
-    // Tạo một bản sao của block hiện tại và thả nó xuống cho đến khi va chạm
-    Piece ghost = currentPiece;
-
-    bool canMoveDown = true;
-    while (canMoveDown) {
-        canMoveDown = false;
-
-        // Kiểm tra va chạm với các block đã khóa
-        for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
-            for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
-                char cell = BlockTemplate::getCell(
-                    ghost.type, ghost.rotation, row, col
-                );
-                if (cell == ' ') continue;
-
-                int xt = ghost.pos.x + col;
-                int yt = ghost.pos.y + row + 1; // test next row down
-
-                // Nếu vượt quá giới hạn dưới, dừng lại
-                if (yt >= BOARD_HEIGHT) {
-                    goto done_checking;
-                }
-
-                if (yt >= 0) {
-                    // Chỉ va chạm với các block thực tế, không va chạm với các cell của ghost '.'
-                    char gridCell = board.grid[yt][xt];
-                    if (gridCell != ' ' && gridCell != '.') {
-                        goto done_checking;
-                    }
-                }
-            }
-        }
 
-        canMoveDown = true;
-    done_checking:
-        if (canMoveDown) {
-            ++ghost.pos.y;
+    // Chạy theo nhịp frame: mỗi frame vẽ lại một lần dù hiệu ứng dài bao
+    // lâu, phím vẫn được đọc (Q bỏ qua) và khán giả vẫn nhận frame
+    for (;;) {
+        long long now = chrono::duration_cast<chrono::microseconds>(
+                            chrono::steady_clock::now().time_since_epoch()).count();
+        if (!animator.isEnding(now) || getInput() == 'q') break;
+
+        if (pacer.ready(now)) {
+            // Khối cuối cùng vẫn hiện, không ghi đè các cell đã khóa
+            composeEndingBoard(core, board);
+            presentFrame(now);
         }
+        if (broadcast) broadcast->publish(core, state);
+        pacer.pump(now, ANIM_FRAME_US);
     }
 
-    return ghost;
-}
-
-bool TetrisGame::canSpawn(const Piece& piece) const {
-    // Kiểm tra xem block có thể xuất hiện không
-    for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
-        for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
-            char cell = BlockTemplate::getCell(
-                piece.type, piece.rotation, row, col
-            );
-            if (cell == ' ') continue;
-
-            int xt = piece.pos.x + col;
-            int yt = piece.pos.y + row;
-
-            if (xt < 0 || xt >= BOARD_WIDTH)   return false;
-            if (yt >= BOARD_HEIGHT)            return false;
-
-            if (yt >= 0) {
-                char gridCell = board.grid[yt][xt];
-                if (gridCell != ' ' && gridCell != '.') {
-                    return false;
-                }
-            }
-        }
-    }
-    return true;
-}
-
-bool TetrisGame::canMove(int dx, int dy, int newRotation) const {
-    // Kiểm tra xem block có thể di chuyển không
-    for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
-        for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
-            char cell = BlockTemplate::getCell(
-                currentPiece.type, newRotation, row, col
-            );
-            if (cell == ' ') continue;
-
-            int xt = currentPiece.pos.x + col + dx;
-            int yt = currentPiece.pos.y + row + dy;
-
-            if (xt < 0 || xt >= BOARD_WIDTH)   return false;
-            if (yt >= BOARD_HEIGHT)            return false;
-
-            if (yt >= 0) {
-                char gridCell = board.grid[yt][xt];
-                if (gridCell != ' ' && gridCell != '.') {
-                    return false;
-                }
-            }
-        }
-    }
-    return true;
+    animator.clear();
+    pacer.drain();
+    flushInput();
 }
 
-void TetrisGame::placePiece(const Piece& piece, bool place) {
-    // Write or erase the piece in the board grid.
-    for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
-        for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
-            char cell = BlockTemplate::getCell(
-                piece.type, piece.rotation, row, col
-            );
-            if (cell == ' ') continue;
-
-            int xt = piece.pos.x + col;
-            int yt = piece.pos.y + row;
-
-            if (!isInsidePlayfield(xt, yt)) continue;
-
-            board.grid[yt][xt] = place ? cell : ' ';
-        }
-    }
+void TetrisGame::composeFrame() {
+    // Dựng lại display buffer: các cell đã khóa của core, ghost và block
+    // hiện tại vẽ lên trên
+    PROFILE_PHASE(profiler, Compose);
+    composeBoard(core, board, state.ghostEnabled);
 }
 
-void TetrisGame::clearAllGhostDots() {
-    // Chỉ xóa các cell đã được đánh dấu là ghost '.'
-    for (const Position& pos : lastGhostPositions) {
-        if (isInsidePlayfield(pos.x, pos.y) &&
-            board.grid[pos.y][pos.x] == '.') {
-            board.grid[pos.y][pos.x] = ' ';
-        }
-    }
-    lastGhostPositions.clear();
+void TetrisGame::presentFrame(long long now) {
+    // Các dòng panel được ghi đè tại chỗ, không tạo lại mỗi frame
+    if (match) {
+        versusPanel(state.panelLines);
+    } else {
+        state.panelLines.clear();
+    }
+#ifdef FRAME_PROFILE
+    // HUD p50/p99 per phase, or the heap use of the last frame, under
+    // the stats panel.
+    if (profileHud == 1) profiler.hudLines(state.panelLines);
+    if (profileHud == 2) profiler.heapHudLines(state.panelLines);
+#endif
+
+    // Hiệu ứng vẽ đè lên board hiển thị theo thời điểm của frame này,
+    // rồi render cả frame
+    PROFILE_PHASE(profiler, Draw);
+    renderFrame(board, state, animator, getNextPiecePreview(), now, frameBuffer);
+    drawOpponent();
+    pacer.submit(frameBuffer, now, match ? &opponentBuffer : nullptr);
+    TRACE_INSTANT(trace, "frame write", "render", core.getTickCount());
 }
 
-void TetrisGame::placeGhostPiece(const Piece& ghostPiece) {
-    // Vẽ outline của ghost block vào các cell trống
-    for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
-        for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
-            char cell = BlockTemplate::getCell(
-                ghostPiece.type, ghostPiece.rotation, row, col
-            );
-            if (cell == ' ') continue;
-
-            int xt = ghostPiece.pos.x + col;
-            int yt = ghostPiece.pos.y + row;
-
-            if (!isInsidePlayfield(xt, yt)) continue;
-
-            if (board.grid[yt][xt] == ' ') {
-                board.grid[yt][xt] = '.';
-                lastGhostPositions.emplace_back(xt, yt);
-            }
-        }
+void TetrisGame::applyAction(GameAction action) {
+    if (!recordPath.empty()) {
+        recording.recordAction(action);
     }
-}
-
-void TetrisGame::placePieceSafe(const Piece& piece) {
-    // Giống placePiece(true) nhưng không ghi đè các cell không rỗng
-    for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
-        for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
-            char cell = BlockTemplate::getCell(
-                piece.type, piece.rotation, row, col
-            );
-            if (cell == ' ') continue;
-
-            int xt = piece.pos.x + col;
-            int yt = piece.pos.y + row;
 
-            if (!isInsidePlayfield(xt, yt)) continue;
-
-            if (board.grid[yt][xt] == ' ') {
-                board.grid[yt][xt] = cell;
-            }
-        }
-    }
+    // Soft drop và hard drop khóa block mà không phát âm thanh khóa
+    StepResult result = core.step(action);
+    handleLockResult(result.lock, true);
 }
 
-void TetrisGame::spawnNewPiece() {
-    // Tạo block mới
-    uniform_int_distribution<int> dist(0,
-        BlockTemplate::NUM_BLOCK_TYPES - 1);
-
-    Piece spawn;
-    spawn.type      = nextPieceType;
-    spawn.rotation  = 0;
-    int spawnX      = (BOARD_WIDTH / 2) - (BlockTemplate::BLOCK_SIZE / 2);
-    spawn.pos       = Position(spawnX, -1);
+void TetrisGame::handleLockResult(const LockResult& lock, bool muteLockSound) {
+    syncState();
+    if (match) match->send(0, core, lock);
+    if (!lock.locked) return;
 
-    currentPiece = spawn;
-
-    if (!canSpawn(spawn)) {
-        // Nếu block mới không thể xuất hiện, trò chơi kết thúc
-        state.running = false;
-        return;
-    }
+    TRACE_SPAN(trace, "lock", "game");
+    if (lock.linesCleared > 0) {
+        TRACE_INSTANT(trace, "line clear", "game", lock.linesCleared);
 
-    nextPieceType = dist(rng);
-}
-
-bool TetrisGame::lockPieceAndCheck(bool muteLockSound) {
-    // Tự động khóa block hiện tại và xóa các hàng nếu cần
-    placePiece(currentPiece, true);
-
-    int lines = board.clearLines();
-    if (lines > 0) {
         // Nếu có hàng được xóa, chơi âm thanh
-        if (lines == 4) {
-            SoundManager::play4LinesClearSound();
+        if (lock.linesCleared == 4) {
+            playSound(SoundManager::play4LinesClearSound, "sound: tetris");
         } else {
-            SoundManager::playLineClearSound();
+            playSound(SoundManager::playLineClearSound, "sound: line clear");
         }
 
-        state.linesCleared += lines;
-
-        // Tính điểm: điểm cơ bản nhân với cấp độ hiện tại
-        const int scores[] = {0, 100, 300, 500, 800};
-        state.score += scores[lines] * state.level;
-
-        int oldLevel = state.level;
-
-        // +1 level per 10 lines
-        state.level = 1 + (state.linesCleared / LINES_PER_LEVEL);
-
-        if (state.level > oldLevel) {
-            SoundManager::playLevelUpSound();
+        animator.lineClear(lock.clearedTop, lock.clearedRows);
+        if (lock.leveledUp) {
+            playSound(SoundManager::playLevelUpSound, "sound: level up");
+            animator.levelUp(state.level);
         }
 
         updateDifficulty();
     } else if (!muteLockSound) {
-        SoundManager::playLockPieceSound();
+        playSound(SoundManager::playLockPieceSound, "sound: lock");
     }
-
-    spawnNewPiece();
-    return state.running;
 }
 
-void TetrisGame::softDrop() {
-    // Di chuyển block xuống nhanh hơn
-    if (canMove(0, 1, currentPiece.rotation)) {
-        ++currentPiece.pos.y;
-    } else {
-        // Kết thúc trò chơi nếu block rơi ra ngoài board
-        if (currentPiece.pos.y < 0) {
-            state.running = false;
-            return;
-        }
-        state.running = lockPieceAndCheck(true);
-        dropCounter   = 0;
-    }
+void TetrisGame::playSound(void (*play)(), const char* traceName) {
+    // SoundManager gọi system() ngay trên thread game, nên mỗi lần phát
+    // âm thanh là một span trong trace để thấy các lần bị chặn
+    TRACE_SPAN(trace, traceName, "sound");
+    (void)traceName;
+    play();
 }
 
-void TetrisGame::hardDrop() {
-    // Di chuyển xuống cho đến khi block va chạm
-    while (canMove(0, 1, currentPiece.rotation)) {
-        ++currentPiece.pos.y;
-    }
+void TetrisGame::syncState() {
+    // Sao chép số liệu từ core sang state dùng để hiển thị
+    state.score        = core.getScore();
+    state.level        = core.getLevel();
+    state.linesCleared = core.getLinesCleared();
 
-    // Kết thúc trò chơi nếu block rơi ra ngoài board
-    if (currentPiece.pos.y < 0) {
+    if (core.isGameOver()) {
         state.running = false;
-        return;
     }
-
-    state.running = lockPieceAndCheck(true);
-    dropCounter   = 0;
 }
 
 void TetrisGame::handleInput() {
     char c = getInput();
     if (c == 0) return;
+    TRACE_INSTANT(trace, "key", "input", c);
 
     // Bật/tắt pause
     if (c == 'p') {
         state.paused = !state.paused;
+        opponentTile.invalidate();   // Màn hình pause xóa cả bảng đối thủ
+        pacer.drain();               // Frame đang gửi dở phải xong trước
+        pacer.invalidate();
         flushInput();
         if (state.paused) {
             drawPauseScreen();
@@ -707,6 +537,20 @@ void TetrisGame::handleInput() {
         return;
     }
 
+    // Bật/tắt chế độ bot tự chơi
+    if (c == 'b') {
+        setAutoPlay(!autoPlayer);
+        return;
+    }
+
+#ifdef FRAME_PROFILE
+    // Đổi bảng HUD: tắt, thời gian từng pha, cấp phát heap từng pha
+    if (c == 'f') {
+        profileHud = (profileHud + 1) % 3;
+        return;
+    }
+#endif
+
     if (state.paused) {
         // Chỉ xử lý 'q' để thoát khi trò chơi bị pause
         if (c == 'q') {
@@ -717,39 +561,29 @@ void TetrisGame::handleInput() {
         return;
     }
 
+    // Khi bot đang chơi, chỉ xử lý phím thoát
+    if (autoPlayer && c != 'q') return;
+
     // Xử lý các phím gameplay
     switch (c) {
         case 'a': // di chuyển trái
-            if (canMove(-1, 0, currentPiece.rotation)) {
-                --currentPiece.pos.x;
-            }
+            applyAction(GameAction::MoveLeft);
             break;
         case 'd': // di chuyển phải
-            if (canMove(1, 0, currentPiece.rotation)) {
-                ++currentPiece.pos.x;
-            }
+            applyAction(GameAction::MoveRight);
             break;
         case 's': // soft drop
-            SoundManager::playSoftDropSound();
-            softDrop();
+            playSound(SoundManager::playSoftDropSound, "sound: soft drop");
+            applyAction(GameAction::SoftDrop);
             break;
         case ' ': // hard drop
-            SoundManager::playHardDropSound();
-            hardDrop();
+            playSound(SoundManager::playHardDropSound, "sound: hard drop");
+            applyAction(GameAction::HardDrop);
             flushInput();
             break;
-        case 'w': { // xoay block
-            int newRot = (currentPiece.rotation + 1) % 4;
-            int kicks[] = {0, -1, 1, -2, 2, -3, 3};
-            for (int dx : kicks) {
-                if (canMove(dx, 0, newRot)) {
-                    currentPiece.pos.x += dx;
-                    currentPiece.rotation = newRot;
-                    break;
-                }
-            }
+        case 'w': // xoay block
+            applyAction(GameAction::Rotate);
             break;
-        }
         case 'q': // quit
             state.running    = false;
             state.quitByUser = true;
@@ -760,78 +594,140 @@ void TetrisGame::handleInput() {
     }
 }
 
+void TetrisGame::setAutoPlay(bool enabled) {
+    if (enabled) {
+        autoPlayer = createPolicy(autoPlayPolicy, static_cast<uint32_t>(rng.next()),
+                                  autoPlayWeights, SearchBudget::WallClock);
+    } else {
+        autoPlayer.reset();
+    }
+}
+
+bool TetrisGame::setAutoPlayPolicy(const string& name) {
+    if (!isPolicyName(name)) return false;
+
+    autoPlayPolicy = name;
+    if (autoPlayer) setAutoPlay(true);
+    return true;
+}
+
+void TetrisGame::setAutoPlayWeights(const HeuristicWeights& weights) {
+    autoPlayWeights = weights;
+    if (autoPlayer) setAutoPlay(true);
+}
+
+void TetrisGame::handleAutoPlay() {
+    if (!autoPlayer || !state.running || state.paused) return;
+
+    // Bot chọn một hành động mỗi frame, giống như người chơi nhấn phím
+    GameAction action = autoPlayer->nextAction(core);
+    if (action == GameAction::HardDrop) {
+        playSound(SoundManager::playHardDropSound, "sound: hard drop");
+    }
+    applyAction(action);
+}
+
 void TetrisGame::handleGravity() {
     // Nếu trò chơi không chạy hoặc bị pause, không xử lý
     if (!state.running || state.paused) return;
 
-    ++dropCounter;
+    if (!recordPath.empty()) {
+        recording.recordTick();
+    }
 
     // Block chỉ rơi xuống 1 hàng sau mỗi DROP_INTERVAL_TICKS lần gọi
-    if (dropCounter < DROP_INTERVAL_TICKS) {
-        return;
+    StepResult result = core.tick();
+    handleLockResult(result.lock, false);
+}
+
+const string* TetrisGame::getNextPiecePreview() {
+    // Nếu block tiếp theo chưa thay đổi, dùng lại preview đã lưu (không copy)
+    int nextPieceType = core.getNextPieceType();
+    if (cachedNextPieceType != nextPieceType) {
+        // Render 4 hàng của template 4x4 thành "██" + khoảng trắng, ghi
+        // đè vào các chuỗi đã có nên không cấp phát lại
+        renderPiecePreview(nextPieceType, cachedNextPiecePreview);
+        cachedNextPieceType = nextPieceType;
     }
+    return cachedNextPiecePreview;
+}
 
-    dropCounter = 0;
+// \=== Versus ===
 
-    // Kiểm tra xem block có thể rơi xuống 1 hàng không
-    if (canMove(0, 1, currentPiece.rotation)) {
-        ++currentPiece.pos.y;
-    } else {
-        if (currentPiece.pos.y < 0) {
-            state.running = false;
-            return;
-        }
-        state.running = lockPieceAndCheck();
-    }
+bool TetrisGame::setVersus(const string& policy) {
+    if (!isPolicyName(policy)) return false;
+
+    versusPolicy = policy;
+    return true;
 }
 
-void TetrisGame::getNextPiecePreview(string lines[4]) {
-    // Nếu block tiếp theo chưa thay đổi, tái sử dụng preview đã lưu
-    if (cachedNextPieceType == nextPieceType) {
-        for (int i = 0; i < 4; ++i) {
-            lines[i] = cachedNextPiecePreview[i];
-        }
-        return;
+void TetrisGame::startVersus(uint32_t seed) {
+    // Hai bảng dùng cùng seed nên nhận cùng một chuỗi khối
+    match.reset(new VersusMatch(2, seed));
+    opponent.reset(seed, randomizerMode);
+    opponentBot = createPolicy(versusPolicy, static_cast<uint32_t>(rng.next()),
+                               autoPlayWeights, SearchBudget::WallClock);
+    opponentView.back() = opponent;
+    opponentView.publish();
+
+    // Bảng đối thủ nằm ngay bên phải khung game
+    opponentTile.setLayout(1, 1, 1, BOARD_WIDTH * 2 + PANEL_WIDTH + 5);
+    opponentBuffer.reserve(TILE_HEIGHT * (TILE_LINE_CAPACITY + 16));
+    versusResult.clear();
+
+    opponentThread = thread(&TetrisGame::runOpponent, this);
+}
+
+void TetrisGame::runOpponent() {
+    // Bot chơi từng frame như game loop; sync() không cho nó đi trước
+    // người chơi quá GARBAGE_DELAY_TICKS tick nên nó chơi cùng tốc độ
+    while (playBotFrame(*match, 1, opponent, *opponentBot)) {
+        opponentView.back() = opponent;
+        opponentView.publish();
     }
+    opponentView.back() = opponent;
+    opponentView.publish();
+}
 
-    // Render 4 hàng của template 4x4 thành "██" + khoảng trắng
-    for (int row = 0; row < 4; ++row) {
-        cachedNextPiecePreview[row].clear();
-        cachedNextPiecePreview[row].reserve(64);
-
-        for (int col = 0; col < 4; ++col) {
-            char cell = BlockTemplate::getCell(nextPieceType, 0, row, col);
-            if (cell != ' ') {
-                cachedNextPiecePreview[row] += PIECE_COLORS[nextPieceType];
-                cachedNextPiecePreview[row].append("██");
-                cachedNextPiecePreview[row] += COLOR_RESET;
-            } else {
-                cachedNextPiecePreview[row].append("  ");
-            }
-        }
+void TetrisGame::finishVersus() {
+    if (!match) return;
 
-        lines[row] = cachedNextPiecePreview[row];
-    }
+    match->finish(0, core);
+    opponentThread.join();
 
-    cachedNextPieceType = nextPieceType;
+    int winner = match->winner();
+    versusResult = winner == 0 ? "YOU WIN" : (winner == 1 ? "YOU LOSE" : "DRAW");
+    match.reset();
 }
 
-long TetrisGame::computeDropSpeedUs(int level) const {
-    // Tốc độ rơi của block dựa theo level
-    if (level <= 3) {          // Slow early levels
-        return 500000;         // 0.50s per tick group
-    } else if (level <= 6) {   // Medium
-        return 300000;         // 0.30s
-    } else if (level <= 9) {   // Fast
-        return 150000;         // 0.15s
-    } else {                   // Very fast for 10+
-        return 80000;          // 0.08s
-    }
+void TetrisGame::versusPanel(vector<string>& lines) const {
+    // Garbage đang chờ dâng lên và tổng số hàng đã gửi
+    lines.resize(4);
+    lines[0] = " INCOMING:";
+    lines[1] = ' ';
+    appendInt(lines[1], core.getPendingGarbage());
+    lines[2] = " SENT:";
+    lines[3] = ' ';
+    appendInt(lines[3], match->garbageSent(0));
+}
+
+void TetrisGame::drawOpponent() {
+    if (!match) return;
+
+    opponentView.update();
+    const GameCore& view = opponentView.front();
+    opponentLabel = "BOT ";
+    appendInt(opponentLabel, view.getScore());
+    renderBoardTile(view, opponentLabel, opponentLines);
+
+    // Chỉ các dòng của bảng đối thủ đã thay đổi, gửi cùng frame qua pacer
+    opponentBuffer.clear();
+    opponentTile.update(0, opponentLines, opponentBuffer);
 }
 
 void TetrisGame::updateDifficulty() {
     // Cập nhật tốc độ rơi theo level
-    dropSpeedUs = computeDropSpeedUs(state.level);
+    dropSpeedUs = GameCore::computeDropSpeedUs(state.level);
 }
 
 void TetrisGame::drawPauseScreen() const {
@@ -840,7 +736,7 @@ void TetrisGame::drawPauseScreen() const {
 
     screen += "\033[2J\033[1;1H";
 
-    int totalWidth = (BOARD_WIDTH * 2) + 13;
+    int totalWidth = (BOARD_WIDTH * 2) + PANEL_WIDTH;
 
     // Top border
     screen += "╔";
@@ -963,15 +859,19 @@ void TetrisGame::drawPauseScreen() const {
 void TetrisGame::run() {
     BlockTemplate::initializeTemplates();
 
+#ifdef FRAME_PROFILE
+    if (!tracePath.empty()) {
+        trace.enable();
+        profiler.setTrace(&trace);
+    }
+#endif
+
+    pacer.open(STDOUT_FILENO);
+
     bool shouldRestart = true;
 
     while (shouldRestart) {
-        board.init();
-
-        uniform_int_distribution<int> dist(
-            0, BlockTemplate::NUM_BLOCK_TYPES - 1
-        );
-        nextPieceType = dist(rng);
+        resetGame();
 
         drawStartScreen();
         waitForKeyPress();
@@ -981,58 +881,76 @@ void TetrisGame::run() {
         usleep(100000);
         SoundManager::playBackgroundSound();
 
-        updateDifficulty();
-        spawnNewPiece();
+        // Màn hình bắt đầu đã xóa frame cũ
+        pacer.invalidate();
 
         // Core game loop.
         while (state.running) {
-            handleInput();
+            TRACE_SPAN(trace, "frame", "loop");
+
+            // Versus: chờ bot và nhận garbage đến hạn trước mỗi frame
+            if (match && !match->sync(0, core, recordPath.empty() ? nullptr : &recording)) {
+                state.running = false;
+                break;
+            }
+
+            {
+                PROFILE_PHASE(profiler, Input);
+                handleInput();
+            }
 
             if (state.paused) {
+                if (broadcast) broadcast->publish(core, state);
                 usleep(100000);
                 continue;
             }
 
             if (!state.running) break;
 
-            handleGravity();
-
-            // Update ghost piece.
-            clearAllGhostDots();
-            if (state.ghostEnabled) {
-                Piece ghost = calculateGhostPiece();
-                if (ghost.pos.y != currentPiece.pos.y) {
-                    placeGhostPiece(ghost);
-                }
+            {
+                PROFILE_PHASE(profiler, Bot);
+                handleAutoPlay();
+            }
+            {
+                PROFILE_PHASE(profiler, Gravity);
+                handleGravity();
             }
 
-            // Draw current piece over board, then remove it again.
-            placePiece(currentPiece, true);
-
-            string preview[4];
-            getNextPiecePreview(preview);
-            board.draw(state, preview);
+            // Terminal còn đang nhận frame trước thì bỏ qua frame này;
+            // logic và phím vẫn chạy đủ tốc độ, frame sau luôn là mới nhất
+            long long now = chrono::duration_cast<chrono::microseconds>(
+                                chrono::steady_clock::now().time_since_epoch()).count();
+            if (pacer.ready(now)) {
+                // Compose ghost and current piece over the locked cells.
+                composeFrame();
+                presentFrame(now);
+            }
 
-            placePiece(currentPiece, false);
+            // Khán giả nhận frame qua thread riêng, không bao giờ chặn game loop
+            if (broadcast) broadcast->publish(core, state);
 
-            usleep(dropSpeedUs / DROP_INTERVAL_TICKS);
+            {
+                // Vừa chờ vừa gửi tiếp phần frame còn lại
+                PROFILE_PHASE(profiler, Sleep);
+                pacer.pump(now, dropSpeedUs / DROP_INTERVAL_TICKS);
+            }
+#ifdef FRAME_PROFILE
+            // Cấp phát heap của từng pha trong frame vừa xong
+            profiler.endFrame();
+#endif
         }
 
-        if (!state.quitByUser) {
-            // Make sure last piece is visible.
-            placePieceSafe(currentPiece);
+        finishVersus();
+        pacer.drain();
 
-            string preview[4];
-            getNextPiecePreview(preview);
-            board.draw(state, preview);
-
-            flushInput();
-            usleep(800000);
-            flushInput();
-
-            animateGameOver();
+        // Lưu replay của ván vừa chơi (ghi đè file mỗi ván)
+        if (!recordPath.empty()) {
+            recording.finish(core);
+            saveReplay(recordPath, recording);
         }
 
+        if (!state.quitByUser) playEnding();
+
         SoundManager::stopBackgroundSound();
 
         int rank = saveAndGetRank();
@@ -1041,7 +959,6 @@ void TetrisGame::run() {
 
         char choice = waitForKeyPress();
         if (choice == 'r' || choice == 'R') {
-            resetGame();
             shouldRestart = true;
         } else {
             shouldRestart = false;
@@ -1049,4 +966,34 @@ void TetrisGame::run() {
 
         disableRawMode();
     }
+
+#ifdef FRAME_PROFILE
+    // Ghi toàn bộ histogram của các pha khi thoát
+    if (profiler.writeReport(FRAME_PROFILE_PATH)) {
+        std::printf("Frame timings written to %s\n", FRAME_PROFILE_PATH);
+    }
+
+    // Trace dạng Chrome trace-event JSON, mở bằng ui.perfetto.dev
+    if (trace.isEnabled() && trace.writeChromeTrace(tracePath)) {
+        std::printf("Trace written to %s (%zu events)\n", tracePath.c_str(),
+                    trace.size());
+    }
+#endif
+}
+
+bool TetrisGame::setBroadcast(const string& address, string& error) {
+    unique_ptr<BroadcastServer> server(new BroadcastServer());
+    if (!server->start(address, error)) return false;
+    broadcast = std::move(server);
+    return true;
+}
+
+bool TetrisGame::setTracePath(const string& path) {
+#ifdef FRAME_PROFILE
+    tracePath = path;
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
 }
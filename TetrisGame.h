@@ -1,44 +1,88 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
-#include <random>
 #include <termios.h>
 
+#include "Animation.h"
 #include "Board.h"
+#include "Broadcast.h"
+#include "FrameProfiler.h"
+#include "FramePacer.h"
+#include "GameCore.h"
 #include "GameState.h"
 #include "Piece.h"
+#include "Policy.h"
+#include "Mailbox.h"
+#include "Replay.h"
+#include "TileRenderer.h"
+#include "Versus.h"
 
 using namespace std;
 
-// Base drop speed and timing constants (microseconds / ticks).
-constexpr long BASE_DROP_SPEED_US  = 500000; // Base tick group duration.
-constexpr int  DROP_INTERVAL_TICKS = 5;      // Logic steps per drop.
-constexpr int  ANIM_DELAY_US       = 15000;  // Game-over animation delay.
-
-// Level progression constant.
-constexpr int  LINES_PER_LEVEL     = 10;     // Lines needed to advance one level.
+// Histograms written on exit by a FRAME_PROFILE build.
+constexpr const char* FRAME_PROFILE_PATH = "frame_profile.txt";
 
 
+// Terminal frontend: input, sound and rendering over a GameCore.
 class TetrisGame {
 private:
-    Board      board;
+    GameCore   core;                  // Rules and simulation state.
+    Board      board;                 // Display buffer composed each frame.
     GameState  state;
-    Piece      currentPiece;
-    int        nextPieceType{0};
 
     termios    origTermios{};         // Saved terminal settings.
     long       dropSpeedUs{BASE_DROP_SPEED_US};
-    int        dropCounter{0};
-
-    // Track previous ghost locations to clear only those cells.
-    vector<Position> lastGhostPositions;
 
     // Cache for "next piece" preview.
     string cachedNextPiecePreview[4];
     int         cachedNextPieceType{-1};
 
-    mt19937 rng;                 // Random generator for piece types.
+    // Frame text, reused every frame so drawing does not allocate.
+    string     frameBuffer;
+
+    // Game frames go out through the pacer: changed lines only, never
+    // blocking, fewer frames and no colors when the terminal is slow.
+    FramePacer pacer;
+
+    // Line-clear flash, level-up banner and game-over wave, drawn over
+    // the frame by the frame clock.
+    Animator   animator;
+
+    Xoshiro256 rng;              // Seeds a new GameCore for every game.
+    RandomizerMode randomizerMode{RandomizerMode::Uniform};
+
+    unique_ptr<Policy> autoPlayer;    // Bot driving the game, if enabled.
+    string     autoPlayPolicy{"greedy"}; // Policy name used by the bot.
+    HeuristicWeights autoPlayWeights;   // Board weights used by the bot.
+
+    string     recordPath;            // Replay file of the last game, if set.
+    Replay     recording;             // Events of the game in progress.
+
+    // Versus against a bot: this game is board 0 of the match, the bot
+    // plays board 1 on its own thread and publishes snapshots of it.
+    string     versusPolicy;          // Opponent policy, empty when playing alone.
+    unique_ptr<VersusMatch> match;    // Match in progress, if any.
+    GameCore   opponent;              // Only touched by opponentThread.
+    unique_ptr<Policy> opponentBot;
+    thread     opponentThread;
+    TripleBuffer<GameCore> opponentView;
+    TileCompositor opponentTile;      // Opponent board right of the frame.
+    vector<string> opponentLines;
+    string     opponentLabel;
+    string     opponentBuffer;        // Escapes of the tile lines that changed.
+    string     versusResult;          // Title of the game over screen.
+
+    unique_ptr<BroadcastServer> broadcast; // Spectators of this session, if any.
+
+#ifdef FRAME_PROFILE
+    FrameProfiler profiler;           // Per-phase timings of the game loop.
+    int        profileHud{0};         // Panel: 0 off, 1 timings, 2 heap (F cycles).
+    TraceBuffer trace;                // Trace events, once enabled.
+    string     tracePath;             // Chrome trace written on exit, if set.
+#endif
 
     // \=== High score handling ===
     void loadHighScores();
@@ -58,34 +102,61 @@ private:
 
     // \=== Game logic helpers ===
     void resetGame();
-    void animateGameOver();
-    bool isInsidePlayfield(int x, int y) const;
-    Piece calculateGhostPiece() const;
-    bool  canSpawn(const Piece& piece) const;
-    bool  canMove(int dx, int dy, int newRotation) const;
-
-    void placePiece(const Piece& piece, bool place);
-    void placePieceSafe(const Piece& piece);
-    void clearAllGhostDots();
-    void placeGhostPiece(const Piece& ghostPiece);
-
-    void spawnNewPiece();
-    bool lockPieceAndCheck(bool muteLockSound = false);
-    void softDrop();
-    void hardDrop();
+    void playEnding();               // Game-over sequence, frame by frame.
+    void composeFrame();             // Display board of the frame.
+    void presentFrame(long long nowUs); // Panel, effects, render, send.
+
+    void playSound(void (*play)(), const char* traceName);
+    void applyAction(GameAction action);
+    void handleLockResult(const LockResult& lock, bool muteLockSound);
+    void syncState();
     void handleInput();
+    void handleAutoPlay();
     void handleGravity();
 
-    void getNextPiecePreview(string lines[4]);
+    const string* getNextPiecePreview();
+
+    // \=== Versus ===
+    void startVersus(uint32_t seed);
+    void runOpponent();
+    void finishVersus();
+    void versusPanel(vector<string>& lines) const;
+    void drawOpponent();             // Into opponentBuffer.
 
     // \=== Difficulty / speed ===
-    long computeDropSpeedUs(int level) const;
     void updateDifficulty();
 
 public:
     // Constructor
     TetrisGame();
 
+    // Let the built-in bot play (toggled in game with B).
+    void setAutoPlay(bool enabled);
+
+    // Choose the bot policy by name (see policyNames()); false if unknown.
+    bool setAutoPlayPolicy(const string& name);
+
+    // Board evaluation weights of the bot (e.g. from the tuner).
+    void setAutoPlayWeights(const HeuristicWeights& weights);
+
+    // How piece types are drawn (uniform, 7-bag, history); from the next game.
+    void setRandomizerMode(RandomizerMode mode) { randomizerMode = mode; }
+
+    // Record every game to a replay file (tools/replay plays it back).
+    void setRecordPath(const string& path) { recordPath = path; }
+
+    // Play every game against a bot with this policy, exchanging garbage;
+    // false if the policy is unknown.
+    bool setVersus(const string& policy);
+
+    // Publish every frame to read-only spectators on a Unix socket path
+    // or tcp:PORT (loopback); false with `error` set if it cannot listen.
+    bool setBroadcast(const string& address, string& error);
+
+    // Trace the game loop into a Chrome trace-event file written on exit.
+    // False when the game was built without FRAME_PROFILE.
+    bool setTracePath(const string& path);
+
     // Run the game
     void run();
 };
\ No newline at end of file
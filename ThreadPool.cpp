@@ -0,0 +1,96 @@
+#include "ThreadPool.h"
+
+int ThreadPool::hardwareThreads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<int>(n);
+}
+
+ThreadPool::ThreadPool(int threadCount)
+    : workerCount(threadCount > 0 ? threadCount : hardwareThreads()) {
+    for (int i = 0; i < workerCount; ++i) {
+        queues.emplace_back(new WorkQueue());
+    }
+    for (int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    int index = static_cast<int>(nextQueue.fetch_add(1) % static_cast<unsigned>(workerCount));
+
+    pendingTasks.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    queuedTasks.fetch_add(1);
+
+    // Take the idle lock so a worker about to sleep cannot miss the signal.
+    { std::lock_guard<std::mutex> lock(idleMutex); }
+    workAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(idleMutex);
+    allDone.wait(lock, [this]() { return pendingTasks.load() == 0; });
+}
+
+bool ThreadPool::popLocal(int index, Task& task) {
+    WorkQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+
+    // Newest first: the task is most likely still warm in this core's cache.
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(int thief, Task& task) {
+    int count = size();
+    for (int offset = 1; offset < count; ++offset) {
+        WorkQueue& victim = *queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) continue;
+
+        // Oldest first: leaves the victim its hot end of the deque.
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int index) {
+    for (;;) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            queuedTasks.fetch_sub(1);
+            task(index);
+
+            if (pendingTasks.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(idleMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idleMutex);
+        workAvailable.wait(lock, [this]() {
+            return stopping || queuedTasks.load() > 0;
+        });
+        if (stopping && queuedTasks.load() == 0) return;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool.
+// Every worker owns a task deque: it pops its own newest task first and,
+// when empty, steals the oldest task from another worker. Tasks receive
+// the index of the worker running them so callers can keep per-worker
+// state without any locking.
+class ThreadPool {
+public:
+    using Task = std::function<void(int workerIndex)>;
+
+    // threadCount <= 0 uses every hardware thread.
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task. Tasks are spread round-robin over worker deques.
+    void submit(Task task);
+
+    // Block until every submitted task has finished.
+    void wait();
+
+    int size() const { return workerCount; }
+
+    // Number of hardware threads (at least 1).
+    static int hardwareThreads();
+
+private:
+    // Set before any worker starts; workers is still growing while the
+    // first ones already run and call size().
+    const int workerCount;
+
+    struct WorkQueue {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::thread>                workers;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+
+    std::mutex              idleMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+
+    std::atomic<long> pendingTasks{0};  // Submitted but not yet finished.
+    std::atomic<long> queuedTasks{0};   // Sitting in some deque.
+    std::atomic<unsigned> nextQueue{0};   // Wraps around harmlessly.
+    bool              stopping{false};
+
+    bool popLocal(int index, Task& task);
+    bool steal(int thief, Task& task);
+    void workerLoop(int index);
+};
@@ -0,0 +1,134 @@
+#include "TileRenderer.h"
+
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+
+// 256-color palette index of a piece cell (I, O, T, S, Z, J, L), 0 = empty.
+int cellColor(char cell) {
+    switch (cell) {
+        case 'I': return 51;
+        case 'O': return 226;
+        case 'T': return 129;
+        case 'S': return 46;
+        case 'Z': return 196;
+        case 'J': return 27;
+        case 'L': return 208;
+        case ' ': return 0;
+        default:  return 250;  // Garbage and anything else.
+    }
+}
+
+void appendColor(std::string& out, int fg, int bg) {
+    out += "\033[";
+    if (fg) {
+        out += "38;5;";
+        appendInt(out, fg);
+    } else {
+        out += "39";
+    }
+    out += ';';
+    if (bg) {
+        out += "48;5;";
+        appendInt(out, bg);
+    } else {
+        out += "49";
+    }
+    out += 'm';
+}
+
+} // namespace
+
+void renderBoardTile(const GameCore& core, const std::string& label,
+                     std::vector<std::string>& lines) {
+    lines.resize(TILE_HEIGHT);
+    for (std::string& line : lines) line.reserve(TILE_LINE_CAPACITY);
+
+    // Locked cells plus the active piece, without the ghost.
+    Board board;
+    composeBoard(core, board, false);
+
+    std::string& title = lines[0];
+    title.assign(label, 0, TILE_WIDTH);
+    title.append(TILE_WIDTH - title.size(), ' ');
+
+    std::string& top = lines[1];
+    top = "┌";
+    for (int x = 0; x < BOARD_WIDTH; ++x) top += "─";
+    top += "┐";
+
+    // Two board rows per line: an upper half block in the top cell's color
+    // over the bottom cell's color, or a lower half block when only the
+    // bottom cell is filled.
+    for (int r = 0; r < (BOARD_HEIGHT + 1) / 2; ++r) {
+        std::string& line = lines[2 + r];
+        line = "│";
+        int lastFg = -1, lastBg = -1;
+        for (int x = 0; x < BOARD_WIDTH; ++x) {
+            int upper = cellColor(board.grid[2 * r][x]);
+            int lower = 2 * r + 1 < BOARD_HEIGHT ? cellColor(board.grid[2 * r + 1][x]) : 0;
+            int fg    = upper ? upper : lower;
+            int bg    = upper ? lower : 0;
+            if (fg != lastFg || bg != lastBg) {
+                appendColor(line, fg, bg);
+                lastFg = fg;
+                lastBg = bg;
+            }
+            line += upper ? "▀" : (lower ? "▄" : " ");
+        }
+        line += "\033[0m│";
+    }
+
+    std::string& bottom = lines[TILE_HEIGHT - 1];
+    bottom = "└";
+    for (int x = 0; x < BOARD_WIDTH; ++x) bottom += "─";
+    bottom += "┘";
+}
+
+void TileCompositor::setLayout(int tileCount, int columns, int top, int left) {
+    drawn.assign(tileCount, std::vector<std::string>());
+    tileColumns = columns > 0 ? columns : 1;
+    topRow      = top;
+    leftColumn  = left;
+}
+
+void TileCompositor::invalidate() {
+    for (std::vector<std::string>& tile : drawn) tile.clear();
+}
+
+int TileCompositor::update(int index, const std::vector<std::string>& lines,
+                           std::string& out) {
+    std::vector<std::string>& previous = drawn[index];
+    previous.resize(lines.size());
+
+    // One blank column and one blank row between tiles.
+    int row = topRow + (index / tileColumns) * (TILE_HEIGHT + 1);
+    int col = leftColumn + (index % tileColumns) * (TILE_WIDTH + 1);
+
+    int written = 0;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (previous[i] == lines[i]) continue;
+        previous[i].reserve(TILE_LINE_CAPACITY);
+        out += "\033[";
+        appendInt(out, row + static_cast<int>(i));
+        out += ';';
+        appendInt(out, col);
+        out += 'H';
+        out += lines[i];
+        previous[i] = lines[i];
+        ++written;
+    }
+    return written;
+}
+
+void terminalSize(int& columns, int& rows) {
+    winsize size{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0) {
+        columns = size.ws_col;
+        rows    = size.ws_row;
+    } else {
+        columns = 80;
+        rows    = 24;
+    }
+}
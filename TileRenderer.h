@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "GameCore.h"
+
+// Compact view of one game for multi-board screens: half-block cells
+// ("▀", two board rows per terminal row, one column per cell) inside a
+// thin frame, under a one-line label.
+constexpr int TILE_WIDTH  = BOARD_WIDTH + 2;
+constexpr int TILE_HEIGHT = (BOARD_HEIGHT + 1) / 2 + 3;
+
+// Bytes of the longest tile line: a color change before every cell.
+constexpr int TILE_LINE_CAPACITY = BOARD_WIDTH * 24 + 32;
+
+// Render the locked cells and the active piece of `core` into
+// TILE_HEIGHT lines of TILE_WIDTH columns each (plus color escapes).
+// The label is cut to fit the first line.
+void renderBoardTile(const GameCore& core, const std::string& label,
+                     std::vector<std::string>& lines);
+
+// Places tiles on a grid of the terminal and writes only what changed:
+// every line of every tile is remembered, and update() emits a cursor
+// move and the new text just for the lines that differ from last time.
+class TileCompositor {
+public:
+    // `columns` tiles per row, the top-left tile at terminal row `top` and
+    // column `left` (1-based). Forgets everything drawn before.
+    void setLayout(int tileCount, int columns, int top, int left = 1);
+
+    // Append the escapes that bring tile `index` from its last drawn
+    // state to `lines`; returns the number of lines rewritten. Needs at
+    // most TILE_HEIGHT * (TILE_LINE_CAPACITY + 16) bytes of `out` per tile.
+    int update(int index, const std::vector<std::string>& lines,
+               std::string& out);
+
+    // Forget what is on screen, e.g. after clearing it.
+    void invalidate();
+
+    int columns() const { return tileColumns; }
+
+private:
+    std::vector<std::vector<std::string>> drawn;  // Per tile, per line.
+    int tileColumns{1};
+    int topRow{1};
+    int leftColumn{1};
+};
+
+// Terminal size in character cells, or 80x24 when not a terminal.
+void terminalSize(int& columns, int& rows);
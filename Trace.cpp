@@ -0,0 +1,103 @@
+#include "Trace.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+void TraceBuffer::enable(size_t capacity) {
+    events.assign(capacity > 0 ? capacity : 1, TraceEvent());
+    next     = 0;
+    recorded = 0;
+    origin   = Clock::now();
+}
+
+uint64_t TraceBuffer::sinceOrigin(Clock::time_point t) const {
+    if (t < origin) return 0;
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t - origin).count());
+}
+
+TraceEvent& TraceBuffer::push() {
+    TraceEvent& event = events[next];
+    if (++next == events.size()) next = 0;
+    ++recorded;
+    return event;
+}
+
+void TraceBuffer::span(const char* name, const char* category,
+                       Clock::time_point start, Clock::time_point end) {
+    if (!isEnabled()) return;
+    TraceEvent& event = push();
+    event.name       = name;
+    event.category   = category;
+    event.type       = 'X';
+    event.startNs    = sinceOrigin(start);
+    event.durationNs = sinceOrigin(end) - event.startNs;
+    event.hasValue   = false;
+}
+
+void TraceBuffer::span(const char* name, const char* category,
+                       Clock::time_point start, Clock::time_point end,
+                       int64_t value) {
+    if (!isEnabled()) return;
+    span(name, category, start, end);
+    TraceEvent& event = events[next == 0 ? events.size() - 1 : next - 1];
+    event.value    = value;
+    event.hasValue = true;
+}
+
+void TraceBuffer::instant(const char* name, const char* category) {
+    if (!isEnabled()) return;
+    TraceEvent& event = push();
+    event.name       = name;
+    event.category   = category;
+    event.type       = 'i';
+    event.startNs    = sinceOrigin(Clock::now());
+    event.durationNs = 0;
+    event.hasValue   = false;
+}
+
+void TraceBuffer::instant(const char* name, const char* category,
+                          int64_t value) {
+    if (!isEnabled()) return;
+    instant(name, category);
+    TraceEvent& event = events[next == 0 ? events.size() - 1 : next - 1];
+    event.value    = value;
+    event.hasValue = true;
+}
+
+bool TraceBuffer::writeChromeTrace(const std::string& path) const {
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    // Timestamps are microseconds with nanosecond decimals.
+    std::fprintf(out, "{\"displayTimeUnit\": \"ns\", \"otherData\": "
+                      "{\"dropped\": %" PRIu64 "},\n\"traceEvents\": [\n",
+                 dropped());
+    std::fprintf(out, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, "
+                      "\"tid\": 1, \"args\": {\"name\": \"tetris\"}}");
+
+    // Oldest first: after a wrap-around the oldest event sits at `next`.
+    size_t count = size();
+    size_t first = recorded > events.size() ? next : 0;
+    for (size_t i = 0; i < count; ++i) {
+        const TraceEvent& e = events[(first + i) % events.size()];
+        std::fprintf(out, ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"%c\", "
+                          "\"pid\": 1, \"tid\": 1, \"ts\": %" PRIu64 ".%03u",
+                     e.name, e.category, e.type, e.startNs / 1000,
+                     static_cast<unsigned>(e.startNs % 1000));
+        if (e.type == 'X') {
+            std::fprintf(out, ", \"dur\": %" PRIu64 ".%03u", e.durationNs / 1000,
+                         static_cast<unsigned>(e.durationNs % 1000));
+        } else {
+            std::fprintf(out, ", \"s\": \"t\"");
+        }
+        if (e.hasValue) {
+            std::fprintf(out, ", \"args\": {\"value\": %" PRId64 "}", e.value);
+        }
+        std::fprintf(out, "}");
+    }
+    std::fprintf(out, "\n]}\n");
+
+    bool ok = !std::ferror(out);
+    return std::fclose(out) == 0 && ok;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One Chrome trace event. Names and categories must be string literals:
+// recording copies the pointers, never the text.
+struct TraceEvent {
+    const char* name{nullptr};
+    const char* category{nullptr};
+    uint64_t    startNs{0};      // Since TraceBuffer::enable().
+    uint64_t    durationNs{0};   // Complete spans only.
+    int64_t     value{0};        // Optional "value" argument.
+    char        type{'X'};       // 'X' complete span, 'i' instant event.
+    bool        hasValue{false};
+};
+
+// Ring buffer of trace events for the game thread. When full, the oldest
+// events are overwritten, so a long session keeps its last few minutes.
+// Nothing is recorded until enable() and recording never allocates.
+// Not thread-safe: only the thread running the game loop records.
+class TraceBuffer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 18;  // About 12 MB.
+
+    // Allocate the ring and start the clock.
+    void enable(size_t capacity = DEFAULT_CAPACITY);
+    bool isEnabled() const { return !events.empty(); }
+
+    // A span that ran from `start` to `end`.
+    void span(const char* name, const char* category,
+              Clock::time_point start, Clock::time_point end);
+    void span(const char* name, const char* category,
+              Clock::time_point start, Clock::time_point end, int64_t value);
+
+    // A point in time, e.g. a key arriving.
+    void instant(const char* name, const char* category);
+    void instant(const char* name, const char* category, int64_t value);
+
+    // Events kept and events lost to wrap-around.
+    size_t   size() const    { return recorded < events.size() ? recorded : events.size(); }
+    uint64_t dropped() const { return recorded - size(); }
+
+    // Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev);
+    // false on I/O error.
+    bool writeChromeTrace(const std::string& path) const;
+
+private:
+    std::vector<TraceEvent> events;
+    size_t            next{0};       // Slot of the next event.
+    uint64_t          recorded{0};
+    Clock::time_point origin;
+
+    uint64_t sinceOrigin(Clock::time_point t) const;
+    TraceEvent& push();
+};
+
+// Records its own lifetime as a span when the buffer is enabled.
+class TraceSpan {
+public:
+    TraceSpan(TraceBuffer& buffer, const char* name, const char* category)
+        : buffer(buffer), name(name), category(category),
+          start(buffer.isEnabled() ? TraceBuffer::Clock::now()
+                                   : TraceBuffer::Clock::time_point()) {}
+
+    ~TraceSpan() {
+        if (buffer.isEnabled()) {
+            buffer.span(name, category, start, TraceBuffer::Clock::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceBuffer&                  buffer;
+    const char*                   name;
+    const char*                   category;
+    TraceBuffer::Clock::time_point start;
+};
+
+// Trace hooks, present only in FRAME_PROFILE builds like PROFILE_PHASE.
+//   TRACE_SPAN(trace, "lock", "game");         span of the enclosing scope
+//   TRACE_INSTANT(trace, "key", "input", c);   instant with a value
+#ifdef FRAME_PROFILE
+#define TRACE_JOIN2(a, b) a##b
+#define TRACE_JOIN(a, b)  TRACE_JOIN2(a, b)
+#define TRACE_SPAN(trace, name, category) \
+    TraceSpan TRACE_JOIN(traceSpan, __LINE__)(trace, name, category)
+#define TRACE_INSTANT(trace, name, category, value) \
+    ((trace).isEnabled() ? (trace).instant(name, category, value) : (void)0)
+#else
+#define TRACE_SPAN(trace, name, category) ((void)0)
+#define TRACE_INSTANT(trace, name, category, value) ((void)0)
+#endif
@@ -0,0 +1,74 @@
+#include "TranspositionTable.h"
+
+#include <cstring>
+
+namespace {
+
+const uint64_t VALID_BIT = 1ULL << 63;
+
+} // namespace
+
+TranspositionTable::TranspositionTable(int sizeBits)
+    : slots(new Slot[1ULL << sizeBits]),
+      mask((1ULL << sizeBits) - 1) {
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (uint64_t i = 0; i <= mask; ++i) {
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t TranspositionTable::pack(const TTEntry& entry) {
+    uint32_t scoreBits;
+    std::memcpy(&scoreBits, &entry.score, sizeof(scoreBits));
+
+    return VALID_BIT |
+           static_cast<uint64_t>(scoreBits) |
+           (static_cast<uint64_t>(entry.depth & 0xFF)      << 32) |
+           (static_cast<uint64_t>(entry.rotation & 0x3)    << 40) |
+           (static_cast<uint64_t>((entry.x + 8) & 0x3F)    << 42) |
+           (static_cast<uint64_t>((entry.y + 8) & 0x3F)    << 48);
+}
+
+TTEntry TranspositionTable::unpack(uint64_t data) {
+    TTEntry entry;
+    uint32_t scoreBits = static_cast<uint32_t>(data);
+    std::memcpy(&entry.score, &scoreBits, sizeof(scoreBits));
+
+    entry.depth    = static_cast<int>((data >> 32) & 0xFF);
+    entry.rotation = static_cast<int>((data >> 40) & 0x3);
+    entry.x        = static_cast<int>((data >> 42) & 0x3F) - 8;
+    entry.y        = static_cast<int>((data >> 48) & 0x3F) - 8;
+    return entry;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& out) const {
+    const Slot& slot = slots[key & mask];
+    uint64_t data  = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+    if (!(data & VALID_BIT) || (check ^ data) != key) return false;
+
+    out = unpack(data);
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, const TTEntry& entry) {
+    Slot& slot = slots[key & mask];
+
+    // Depth-preferred replacement for the same position, always replace
+    // a different one: recent positions matter most to a running search.
+    uint64_t oldData  = slot.data.load(std::memory_order_relaxed);
+    uint64_t oldCheck = slot.check.load(std::memory_order_relaxed);
+    if ((oldData & VALID_BIT) && (oldCheck ^ oldData) == key &&
+        unpack(oldData).depth > entry.depth) {
+        return;
+    }
+
+    uint64_t data = pack(entry);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
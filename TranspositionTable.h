@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// One cached search result.
+struct TTEntry {
+    float score{0.0f};
+    int   depth{0};        // Plies searched below the position (0 = static eval).
+    int   rotation{0};     // Best move, if depth > 0.
+    int   x{0};
+    int   y{0};            // Landing row; tucks share rotation and x.
+};
+
+// Fixed-size, lock-free transposition table shared by all search threads.
+// Each slot is two 64-bit words written independently; the key word is
+// stored XORed with the data word so a torn read (words from two
+// different writers) simply fails the key check instead of returning
+// mixed data.
+class TranspositionTable {
+public:
+    // 2^sizeBits slots of 16 bytes each.
+    explicit TranspositionTable(int sizeBits = 18);
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    bool probe(uint64_t key, TTEntry& out) const;
+
+    // A shallower result never replaces a deeper one for the same key.
+    void store(uint64_t key, const TTEntry& entry);
+
+    void clear();
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check;   // key ^ data
+        std::atomic<uint64_t> data;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    uint64_t                mask;
+
+    static uint64_t pack(const TTEntry& entry);
+    static TTEntry  unpack(uint64_t data);
+};
@@ -0,0 +1,167 @@
+#include "Versus.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+// Spin briefly, then yield, then sleep: a board waiting on a slower one
+// should not hold a core the slower one needs, nor burn a whole core
+// while a human opponent has the game paused.
+void backoff(int& spins) {
+    ++spins;
+    if (spins < 64) return;
+    if (spins < 256) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+} // namespace
+
+VersusMatch::VersusMatch(int boards, uint32_t seed, long maxTicks)
+    : boardCount(std::max(2, std::min(boards, MAX_VERSUS_BOARDS))),
+      maxTicks(maxTicks),
+      seats(new Seat[boardCount]),
+      mailboxes(new AttackMailbox[boardCount * boardCount]) {
+    reset(seed);
+}
+
+void VersusMatch::reset(uint32_t seed) {
+    Xoshiro256 streams(seed);
+    for (int i = 0; i < boardCount; ++i) {
+        Seat& seat = seats[i];
+        seat.progress.store(0, std::memory_order_relaxed);
+        seat.finishedAt.store(-1, std::memory_order_relaxed);
+        seat.lost       = false;
+        seat.holes      = streams.split();
+        seat.nextTarget = 0;
+        seat.sent       = 0;
+    }
+    for (int i = 0; i < boardCount * boardCount; ++i) {
+        mailboxes[i].clear();
+    }
+}
+
+bool VersusMatch::sync(int board, GameCore& core, Replay* recording) {
+    Seat& seat = seats[board];
+    long  tick = core.getTickCount();
+    seat.progress.store(tick, std::memory_order_release);
+    if (maxTicks > 0 && tick >= maxTicks) return false;
+
+    // Every attack stamped up to `due` must be in its mailbox.
+    long due = tick - GARBAGE_DELAY_TICKS;
+    bool opponentsDone = true;
+    long lastFinish    = 0;
+    for (int other = 0; other < boardCount; ++other) {
+        if (other == board) continue;
+        Seat& opponent = seats[other];
+
+        int  spins = 0;
+        long finished;
+        while ((finished = opponent.finishedAt.load(std::memory_order_acquire)) < 0 &&
+               opponent.progress.load(std::memory_order_acquire) <= due) {
+            backoff(spins);
+        }
+
+        if (finished < 0) {
+            opponentsDone = false;
+        } else {
+            lastFinish = std::max(lastFinish, finished);
+        }
+
+        AttackMailbox& inbox = mailbox(other, board);
+        const Attack* attack;
+        while ((attack = inbox.front()) != nullptr && attack->tick <= due) {
+            core.queueGarbage(attack->rows, attack->hole);
+            if (recording) recording->recordGarbage(attack->rows, attack->hole);
+            inbox.pop();
+        }
+    }
+
+    // The last opponent's final attacks have all arrived.
+    return !(opponentsDone && tick >= lastFinish + GARBAGE_DELAY_TICKS);
+}
+
+void VersusMatch::send(int board, const GameCore& core, const LockResult& lock) {
+    if (lock.garbageSent <= 0) return;
+
+    Seat& seat = seats[board];
+    int target = (board + 1 + seat.nextTarget) % boardCount;
+    seat.nextTarget = (seat.nextTarget + 1) % (boardCount - 1);
+
+    Attack attack;
+    attack.tick = core.getTickCount();
+    attack.rows = lock.garbageSent;
+    attack.hole = static_cast<int>(seat.holes.below(GameCore::BoardType::WIDTH));
+    seat.sent  += attack.rows;
+
+    // A finished target no longer reads its mailbox; the attack is moot.
+    AttackMailbox& outbox = mailbox(board, target);
+    int spins = 0;
+    while (!outbox.push(attack)) {
+        if (seats[target].finishedAt.load(std::memory_order_acquire) >= 0) return;
+        backoff(spins);
+    }
+}
+
+void VersusMatch::finish(int board, const GameCore& core) {
+    Seat& seat = seats[board];
+    seat.lost  = core.isGameOver();
+    seat.progress.store(core.getTickCount(), std::memory_order_release);
+    seat.finishedAt.store(core.getTickCount(), std::memory_order_release);
+}
+
+int VersusMatch::winner() const {
+    // Among the boards that topped out, the last one outlasted the others.
+    int  alive      = -1;
+    int  aliveCount = 0;
+    int  last       = -1;
+    long lastTick   = -1;
+    bool tie        = false;
+    for (int i = 0; i < boardCount; ++i) {
+        const Seat& seat = seats[i];
+        long tick = seat.finishedAt.load(std::memory_order_acquire);
+        if (!seat.lost) {
+            alive = i;
+            ++aliveCount;
+        } else if (tick > lastTick) {
+            last     = i;
+            lastTick = tick;
+            tie      = false;
+        } else if (tick == lastTick) {
+            tie = true;
+        }
+    }
+    if (aliveCount == 1) return alive;
+    if (aliveCount == 0 && !tie) return last;
+    return -1;
+}
+
+long VersusMatch::finishTick(int board) const {
+    return seats[board].finishedAt.load(std::memory_order_acquire);
+}
+
+long VersusMatch::garbageSent(int board) const {
+    return seats[board].sent;
+}
+
+bool playBotFrame(VersusMatch& match, int board, GameCore& core,
+                  Policy& policy, Replay* recording) {
+    if (!match.sync(board, core, recording) || core.isGameOver()) {
+        match.finish(board, core);
+        return false;
+    }
+
+    GameAction action = policy.nextAction(core);
+    if (recording) recording->recordAction(action);
+    match.send(board, core, core.step(action).lock);
+
+    if (!core.isGameOver()) {
+        if (recording) recording->recordTick();
+        match.send(board, core, core.tick().lock);
+    }
+    return true;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "GameCore.h"
+#include "Mailbox.h"
+#include "Policy.h"
+#include "Replay.h"
+
+// Garbage rows on their way from one board to another.
+struct Attack {
+    long tick{0};    // Sender's tick count when the piece locked.
+    int  rows{0};
+    int  hole{0};    // Open column of the rows.
+};
+
+// Ticks an attack travels before it is queued on its target. It is also
+// how far apart in game time the boards of a match may drift.
+constexpr int GARBAGE_DELAY_TICKS = 10;
+
+constexpr int MAX_VERSUS_BOARDS   = 8;
+
+// A match of several boards, each driven by its own thread, exchanging
+// garbage through one lock-free mailbox per (sender, target) pair.
+//
+// Every attack carries the sender's tick, and a board about to play tick
+// t first waits until each opponent has played past t - GARBAGE_DELAY_TICKS,
+// then queues exactly the attacks sent up to that tick, sender by sender.
+// What a board receives and when therefore depends only on the games,
+// never on thread timing: a match replays identically with any number of
+// threads, and each board's Replay (with the garbage events) plays back on
+// its own.
+//
+// A board's thread calls, every frame, sync() before its actions and
+// gravity tick, send() after each lock, and finish() once when it stops.
+// The match ends for a board when it tops out, when every opponent has
+// finished (after their last attacks could still arrive) or at maxTicks.
+class VersusMatch {
+public:
+    // `seed` picks the hole columns of every board's garbage;
+    // maxTicks > 0 stops every board at that tick.
+    VersusMatch(int boards, uint32_t seed, long maxTicks = 0);
+
+    // Start over with a new seed, reusing the mailboxes. Only while no
+    // thread is playing the match.
+    void reset(uint32_t seed);
+
+    int boards() const { return boardCount; }
+
+    // Wait for the opponents and queue the garbage due on `core`, adding
+    // it to `recording` if given. False when the board should stop.
+    bool sync(int board, GameCore& core, Replay* recording = nullptr);
+
+    // Send the garbage of a lock to the next opponent in turn.
+    void send(int board, const GameCore& core, const LockResult& lock);
+
+    // The board stopped; `core` tells whether it topped out.
+    void finish(int board, const GameCore& core);
+
+    // After every board finished: the last board standing, or -1 for a
+    // draw (ties, or several boards still alive at maxTicks).
+    int  winner() const;
+    long finishTick(int board) const;
+    long garbageSent(int board) const;
+
+private:
+    using AttackMailbox = Mailbox<Attack, 256>;
+
+    struct Seat {
+        std::atomic<long> progress{0};     // Ticks fully played and sent.
+        std::atomic<long> finishedAt{-1};  // Tick count at finish(), or -1.
+        bool       lost{false};
+        Xoshiro256 holes;
+        int        nextTarget{0};          // Opponent offset of the next attack.
+        long       sent{0};
+    };
+
+    int  boardCount;
+    long maxTicks;
+    std::unique_ptr<Seat[]>          seats;
+    std::unique_ptr<AttackMailbox[]> mailboxes;   // [sender * boards + target]
+
+    AttackMailbox& mailbox(int sender, int target) {
+        return mailboxes[sender * boardCount + target];
+    }
+};
+
+// One frame of a bot-driven board, the way the game loop plays it: sync,
+// one action, one gravity tick. Calls finish() and returns false when the
+// board stops.
+bool playBotFrame(VersusMatch& match, int board, GameCore& core,
+                  Policy& policy, Replay* recording = nullptr);
@@ -0,0 +1,82 @@
+#include "Zobrist.h"
+
+namespace {
+
+// Piece coordinates are offset so that templates hanging over the left
+// or top edge still index the tables.
+const int POS_OFFSET = 4;
+const int POS_RANGE  = ZOBRIST_MAX_HEIGHT + 2 * POS_OFFSET;
+
+uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+struct KeyTables {
+    uint64_t cells[ZOBRIST_MAX_HEIGHT][ZOBRIST_MAX_WIDTH];
+    uint64_t rowLow[ZOBRIST_MAX_HEIGHT][256];    // Bits 0..7 of a row.
+    uint64_t rowHigh[ZOBRIST_MAX_HEIGHT][256];   // Bits 8..15 of a row.
+    uint64_t pieces[7][4];
+    uint64_t pieceX[POS_RANGE];
+    uint64_t pieceY[POS_RANGE];
+    uint64_t next[7];
+
+    KeyTables() {
+        // Fixed seed: hashes are stable across runs and machines.
+        uint64_t state = 0x5D0C5D0C7E7215ULL;
+
+        for (int y = 0; y < ZOBRIST_MAX_HEIGHT; ++y) {
+            for (int x = 0; x < ZOBRIST_MAX_WIDTH; ++x) {
+                cells[y][x] = splitMix64(state);
+            }
+            for (unsigned m = 0; m < 256; ++m) {
+                uint64_t low = 0, high = 0;
+                for (int b = 0; b < 8; ++b) {
+                    if (!(m & (1u << b))) continue;
+                    low  ^= cells[y][b];
+                    high ^= cells[y][b + 8];
+                }
+                rowLow[y][m]  = low;
+                rowHigh[y][m] = high;
+            }
+        }
+
+        for (int t = 0; t < 7; ++t) {
+            for (int r = 0; r < 4; ++r) pieces[t][r] = splitMix64(state);
+            next[t] = splitMix64(state);
+        }
+        for (int i = 0; i < POS_RANGE; ++i) {
+            pieceX[i] = splitMix64(state);
+            pieceY[i] = splitMix64(state);
+        }
+    }
+};
+
+const KeyTables& keys() {
+    static const KeyTables tables;
+    return tables;
+}
+
+} // namespace
+
+uint64_t Zobrist::cell(int x, int y) {
+    return keys().cells[y][x];
+}
+
+uint64_t Zobrist::row(int y, unsigned mask) {
+    const KeyTables& k = keys();
+    return k.rowLow[y][mask & 0xFFu] ^ k.rowHigh[y][(mask >> 8) & 0xFFu];
+}
+
+uint64_t Zobrist::activePiece(int type, int rotation, int x, int y) {
+    const KeyTables& k = keys();
+    return k.pieces[type][rotation] ^
+           k.pieceX[x + POS_OFFSET] ^
+           k.pieceY[y + POS_OFFSET];
+}
+
+uint64_t Zobrist::nextPiece(int type) {
+    return keys().next[type];
+}
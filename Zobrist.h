@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+// Board dimensions live in Board.h; this header only needs the constants.
+constexpr int ZOBRIST_MAX_WIDTH  = 16;
+constexpr int ZOBRIST_MAX_HEIGHT = 64;
+
+// Fixed random keys for Zobrist hashing of game positions.
+// A board hash is the XOR of the keys of its occupied cells, so placing
+// or clearing a cell is one XOR. Row masks hash through byte tables built
+// from the same cell keys, which keeps Board (char grid) and BitBoard
+// (row masks) hashes identical for the same contents.
+class Zobrist {
+public:
+    // Key of an occupied cell.
+    static uint64_t cell(int x, int y);
+
+    // XOR of cell() over the set bits of a row mask.
+    static uint64_t row(int y, unsigned mask);
+
+    // Key of the active piece at a position and rotation.
+    static uint64_t activePiece(int type, int rotation, int x, int y);
+
+    // Key of the preview piece.
+    static uint64_t nextPiece(int type);
+};
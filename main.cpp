@@ -1,7 +1,121 @@
+#include "GameServer.h"
+#include "SpectatorClient.h"
+#include "SpectatorWall.h"
 #include "TetrisGame.h"
 
-int main() {
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
     TetrisGame game;
+    WallConfig wall;       // Used instead of the game with --wall.
+    bool       wallMode{false};
+    const char* spectateAddress = nullptr;  // Watch a broadcast instead.
+    ServerConfig server;   // Used instead of the game with --serve.
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--auto") == 0) {
+            game.setAutoPlay(true);   // Bot plays from the first piece.
+        } else if (std::strcmp(argv[i], "--bot") == 0 && i + 1 < argc) {
+            // --bot greedy | beam | beam-mt | beam-deep
+            if (!game.setAutoPlayPolicy(argv[++i])) {
+                std::fprintf(stderr, "Unknown bot '%s'\n", argv[i]);
+                return 1;
+            }
+            game.setAutoPlay(true);
+            wall.policyName = argv[i];
+        } else if (std::strcmp(argv[i], "--weights") == 0 && i + 1 < argc) {
+            // Weights file written by the tuner (tools/tune).
+            HeuristicWeights weights;
+            if (!loadWeights(argv[++i], weights)) {
+                std::fprintf(stderr, "Cannot load weights '%s'\n", argv[i]);
+                return 1;
+            }
+            game.setAutoPlayWeights(weights);
+            wall.weights = weights;
+        } else if (std::strcmp(argv[i], "--randomizer") == 0 && i + 1 < argc) {
+            // --randomizer uniform | bag | history
+            RandomizerMode mode;
+            if (!parseRandomizerMode(argv[++i], mode)) {
+                std::fprintf(stderr, "Unknown randomizer '%s'\n", argv[i]);
+                return 1;
+            }
+            game.setRandomizerMode(mode);
+            wall.randomizer   = mode;
+            server.randomizer = mode;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            // Replay of the last game played (tools/replay).
+            game.setRecordPath(argv[++i]);
+        } else if (std::strcmp(argv[i], "--versus") == 0 && i + 1 < argc) {
+            // --versus greedy | beam | ...: play against a bot, with garbage.
+            if (!game.setVersus(argv[++i])) {
+                std::fprintf(stderr, "Unknown bot '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--broadcast") == 0 && i + 1 < argc) {
+            // --broadcast /tmp/tetris.sock | tcp:PORT: let others watch.
+            std::string error;
+            if (!game.setBroadcast(argv[++i], error)) {
+                std::fprintf(stderr, "%s\n", error.c_str());
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--spectate") == 0 && i + 1 < argc) {
+            // Watch a game started with --broadcast, read-only.
+            spectateAddress = argv[++i];
+        } else if (std::strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            // --serve /tmp/tetris.sock | tcp:PORT: host many players at once.
+            server.address = argv[++i];
+        } else if (std::strcmp(argv[i], "--serve-workers") == 0 && i + 1 < argc) {
+            // Event loop threads of the server, 0 = all cores.
+            server.workers = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--serve-max") == 0 && i + 1 < argc) {
+            // Players connected at once; more are turned away.
+            server.maxSessions = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            // Chrome trace-event JSON of the game loop, written on exit.
+            if (!game.setTracePath(argv[++i])) {
+                std::fprintf(stderr, "Tracing needs a build with make PROFILE=1\n");
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--wall") == 0 && i + 1 < argc) {
+            // --wall K: watch K bot games at once instead of playing.
+            wall.games = std::atoi(argv[++i]);
+            wallMode   = true;
+        } else if (std::strcmp(argv[i], "--wall-tps") == 0 && i + 1 < argc) {
+            // Logic ticks per second of every board on the wall.
+            wall.ticksPerSecond = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            // Seed of the first board on the wall.
+            wall.firstSeed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+    }
+
+    if (!server.address.empty()) {
+        GameServer gameServer(server);
+        std::string error;
+        if (!gameServer.run(error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        return 0;
+    }
+
+    if (spectateAddress) {
+        SpectatorClient spectator(spectateAddress);
+        std::string error;
+        if (!spectator.run(error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        return 0;
+    }
+
+    if (wallMode) {
+        SpectatorWall spectatorWall(wall);
+        return spectatorWall.run() ? 0 : 1;
+    }
+
     game.run();
     return 0;
 }
@@ -0,0 +1,1083 @@
+// Microbenchmarks of the core hot paths on board fixtures from recorded
+// games, with JSON output and a threshold-based regression report.
+//
+//   ./bench
+//   ./bench --format json --output before.json
+//   ./bench --compare before.json --threshold 10
+//   ./bench --compare before.json --current after.json
+//   ./bench --record-fixtures tools/bench_fixtures.txt
+//   ./bench --alloc-check     fail if a steady-state frame path allocates
+//   ./bench --search-tt       beam search with and without last-ply caching
+//   ./bench --batch-check     fail if BoardBatch differs from computeFeatures()
+//
+// Every benchmark also counts its heap allocations per operation, and a
+// comparison fails when one that did not allocate in the baseline does.
+
+#include "Animation.h"
+#include "AutoPlayer.h"
+#include "BeamSearch.h"
+#include "BitBoard.h"
+#include "Board.h"
+#include "Broadcast.h"
+#include "FramePacer.h"
+#include "FrameProfiler.h"
+#include "GameCore.h"
+#include "GameState.h"
+#include "MoveGenerator.h"
+#include "Policy.h"
+#include "Randomizer.h"
+#include "Replay.h"
+#include "TileRenderer.h"
+#include "Versus.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+long long heapAllocations() {
+    return static_cast<long long>(HeapStats::total().allocations);
+}
+
+// Keep a value alive so the optimiser cannot drop the work producing it.
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// A board and the piece that had just spawned on it.
+struct Fixture {
+    std::string name;
+    Board       board;
+    Piece       piece;
+};
+
+// Swallows everything written to it, like /dev/null without the syscalls.
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+struct BenchResult {
+    std::string name;
+    double      nsPerOp{0.0};     // Median over the samples.
+    double      minNsPerOp{0.0};
+    long long   iterations{0};    // Operations in one sample.
+    double      allocsPerOp{0.0}; // Heap allocations; -1 when unknown.
+};
+
+// One benchmark body runs `ops` operations.
+struct Benchmark {
+    const char*                      name;
+    std::function<void(long long)>   body;
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+// Grow the operation count until one sample takes a fair share of
+// minSeconds, then time `samples` runs of that size.
+BenchResult measure(const Benchmark& bench, double minSeconds, int samples) {
+    long long ops = 1;
+    for (;;) {
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        bench.body(ops);
+        double seconds = secondsSince(start);
+        if (seconds >= minSeconds / samples || ops >= (1LL << 40)) break;
+        ops = seconds < 1e-4 ? ops * 10
+                             : static_cast<long long>(ops * (minSeconds / samples) /
+                                                      seconds * 1.1) + 1;
+    }
+
+    std::vector<double> perOp;
+    perOp.reserve(samples);
+    long long allocations = heapAllocations();
+    for (int i = 0; i < samples; ++i) {
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        bench.body(ops);
+        perOp.push_back(secondsSince(start) * 1e9 / ops);
+    }
+    allocations = heapAllocations() - allocations;
+    std::sort(perOp.begin(), perOp.end());
+
+    BenchResult result;
+    result.name       = bench.name;
+    result.nsPerOp    = perOp[perOp.size() / 2];
+    result.minNsPerOp = perOp.front();
+    result.iterations = ops;
+    result.allocsPerOp = static_cast<double>(allocations) / (static_cast<double>(ops) * samples);
+    return result;
+}
+
+// --- Fixtures -------------------------------------------------------------
+
+// "fixture <name> <type> <rotation> <x> <y>" followed by BOARD_HEIGHT rows
+// of BOARD_WIDTH cells, '.' for empty; '#' starts a comment line.
+bool loadFixtures(const std::string& path, std::vector<Fixture>& out) {
+    std::ifstream in(path.c_str());
+    if (!in) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream header(line);
+        std::string keyword;
+        Fixture     fixture;
+        header >> keyword >> fixture.name >> fixture.piece.type >>
+            fixture.piece.rotation >> fixture.piece.pos.x >> fixture.piece.pos.y;
+        if (keyword != "fixture" || !header) return false;
+
+        fixture.board.init();
+        for (int y = 0; y < BOARD_HEIGHT; ++y) {
+            if (!std::getline(in, line) ||
+                static_cast<int>(line.size()) < BOARD_WIDTH) {
+                return false;
+            }
+            for (int x = 0; x < BOARD_WIDTH; ++x) {
+                fixture.board.setCell(x, y, line[x] == '.' ? ' ' : line[x]);
+            }
+        }
+        out.push_back(fixture);
+    }
+    return !out.empty();
+}
+
+// Snapshot boards from seeded games: tidy ones from the greedy bot and
+// ragged ones from random key presses.
+bool recordFixtures(const std::string& path) {
+    struct Snapshot {
+        const char* policy;
+        uint32_t    seed;
+        long        pieces;
+    };
+    const Snapshot SNAPSHOTS[] = {
+        {"greedy", 1, 20},  {"greedy", 1, 250}, {"greedy", 2, 700},
+        {"greedy", 3, 1500}, {"random", 1, 6},  {"random", 2, 7},
+        {"random", 3, 8},   {"random", 4, 9},
+    };
+
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    std::fprintf(out,
+        "# Board snapshots from seeded games, written by\n"
+        "#   ./bench --record-fixtures %s\n"
+        "# fixture <name> <type> <rotation> <x> <y> of the piece that just\n"
+        "# spawned, then %d rows of %d cells ('.' = empty).\n",
+        path.c_str(), BOARD_HEIGHT, BOARD_WIDTH);
+
+    int written = 0;
+    for (const Snapshot& snap : SNAPSHOTS) {
+        GameCore core(snap.seed);
+        std::unique_ptr<Policy> policy = createPolicy(snap.policy, snap.seed);
+        while (!core.isGameOver() && core.getPiecesPlaced() < snap.pieces) {
+            core.step(policy->nextAction(core));
+            core.tick();
+        }
+        if (core.isGameOver()) continue;
+
+        const Piece& p = core.getCurrentPiece();
+        std::fprintf(out, "fixture %s-s%u-p%ld %d %d %d %d\n", snap.policy,
+                     snap.seed, snap.pieces, p.type, p.rotation, p.pos.x, p.pos.y);
+        for (int y = 0; y < BOARD_HEIGHT; ++y) {
+            for (int x = 0; x < BOARD_WIDTH; ++x) {
+                char cell = core.getBoard().grid[y][x];
+                std::fputc(cell == ' ' ? '.' : cell, out);
+            }
+            std::fputc('\n', out);
+        }
+        ++written;
+    }
+    std::fclose(out);
+    std::printf("%d fixtures written to %s\n", written, path.c_str());
+    return written > 0;
+}
+
+// --- Benchmarks -----------------------------------------------------------
+
+// Line clears and plain game steps on another board size. The board comes
+// from 30 pieces dropped over the width, with its bottom rows filled.
+template <class Core>
+void addBoardSizeBenches(std::vector<Benchmark>& benches,
+                         const char* clearName, const char* stepName) {
+    using BoardType = typename Core::BoardType;
+
+    Core core(1);
+    for (int i = 0; i < 30 && !core.isGameOver(); ++i) {
+        for (int r = 0; r < i % 4; ++r) core.step(GameAction::Rotate);
+        GameAction shift = (i & 1) ? GameAction::MoveLeft : GameAction::MoveRight;
+        for (int k = 0; k < (i * 7) % (BoardType::WIDTH / 2); ++k) core.step(shift);
+        core.step(GameAction::HardDrop);
+    }
+    std::shared_ptr<BoardType> full = std::make_shared<BoardType>(core.getBoard());
+    for (int y = BoardType::HEIGHT - 4; y < BoardType::HEIGHT; ++y) {
+        for (int x = 0; x < BoardType::WIDTH; ++x) {
+            if (full->grid[y][x] == ' ') full->setCell(x, y, 'I');
+        }
+    }
+
+    benches.push_back({clearName, [full](long long ops) {
+        int lines = 0;
+        for (long long i = 0; i < ops; ++i) {
+            BoardType board = *full;
+            lines += board.clearLines();
+            keep(board);
+        }
+        keep(lines);
+    }});
+
+    benches.push_back({stepName, [](long long ops) {
+        static const GameAction ACTIONS[] = {
+            GameAction::MoveLeft, GameAction::MoveRight, GameAction::Rotate,
+            GameAction::SoftDrop, GameAction::None, GameAction::None,
+            GameAction::None, GameAction::HardDrop
+        };
+        Core     game(1);
+        uint32_t seed = 1;
+        for (long long i = 0; i < ops; ++i) {
+            if (game.isGameOver()) game.reset(++seed);
+            game.step(ACTIONS[(i * 5 + (i >> 3)) & 7]);
+            game.tick();
+        }
+        keep(game.getScore());
+    }});
+}
+
+// Greedy bot games on a W x H board: one bot action and one gravity tick
+// per operation, as playGame() runs them.
+template <int W, int H>
+void addBotBench(std::vector<Benchmark>& benches, const char* name) {
+    benches.push_back({name, [](long long ops) {
+        BasicGameCore<W, H>   game(1);
+        BasicAutoPlayer<W, H> bot;
+        uint32_t              seed = 1;
+        for (long long i = 0; i < ops; ++i) {
+            if (game.isGameOver()) game.reset(++seed);
+            game.step(bot.nextAction(game));
+            game.tick();
+        }
+        keep(game.getScore());
+    }});
+}
+
+std::vector<Benchmark> makeBenchmarks(const std::vector<Fixture>& fixtures) {
+    // Shared state lives as long as the benchmarks that capture it.
+    struct State {
+        std::vector<GameCore> cores;       // One per fixture.
+        std::vector<Board>    fullRows;    // Fixtures with 4 rows completed.
+        std::vector<BitBoard> bitBoards;
+        GameState             gameState;
+        std::string           preview[4];
+        std::string           frame;
+        Board                 display;
+        Animator              animator;
+        std::string           changed;
+        uint64_t              lineHash[FRAME_LINES]{};
+        MoveGenerator         generator;
+        std::vector<Placement> placements;
+        std::vector<BitBoard> batchBoards;  // Placements of fixture pieces.
+        BoardBatch            batch;
+        double                scores[BATCH_CAPACITY];
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+
+    for (const Fixture& f : fixtures) {
+        GameCore core(1);
+        core.setPosition(f.board, f.piece);
+        state->cores.push_back(core);
+
+        Board full = f.board;
+        for (int y = BOARD_HEIGHT - 4; y < BOARD_HEIGHT; ++y) {
+            for (int x = 0; x < BOARD_WIDTH; ++x) {
+                if (full.grid[y][x] == ' ') full.setCell(x, y, 'I');
+            }
+        }
+        state->fullRows.push_back(full);
+        state->bitBoards.push_back(BitBoard::fromBoard(f.board));
+    }
+    // One batch worth of boards: every placement of each fixture's piece.
+    for (size_t i = 0; i < fixtures.size(); ++i) {
+        const BitBoard& board = state->bitBoards[i];
+        AutoPlayer::enumeratePlacements(board, fixtures[i].piece.type, SPAWN_Y,
+                                        state->placements);
+        for (const Placement& p : state->placements) {
+            if (state->batchBoards.size() == BATCH_CAPACITY) break;
+            BitBoard after = board;
+            after.place(fixtures[i].piece.type, p.rotation, p.x, p.y);
+            state->batchBoards.push_back(after);
+        }
+    }
+    state->gameState.score        = 123450;
+    state->gameState.level        = 7;
+    state->gameState.linesCleared = 64;
+    renderPiecePreview(2, state->preview);
+
+    const size_t count = fixtures.size();
+    std::vector<Benchmark> benches;
+
+    benches.push_back({"BlockTemplate::getCell", [state](long long ops) {
+        unsigned sum = 0;
+        for (long long i = 0; i < ops; ++i) {
+            unsigned bits = static_cast<unsigned>(i);
+            sum += BlockTemplate::getCell((bits >> 4) % 7, (bits >> 7) & 3,
+                                          (bits >> 2) & 3, bits & 3);
+        }
+        keep(sum);
+    }});
+
+    benches.push_back({"GameCore::canMove", [state, count](long long ops) {
+        // Every input the game tries: shifts, soft drop and a rotation.
+        static const int MOVES[][3] = {
+            {-1, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}
+        };
+        int hits = 0;
+        for (long long i = 0; i < ops; ++i) {
+            const GameCore& core = state->cores[(i >> 2) % count];
+            const int*      m    = MOVES[i & 3];
+            int rotation = (core.getCurrentPiece().rotation + m[2]) % 4;
+            hits += core.canMove(m[0], m[1], rotation);
+        }
+        keep(hits);
+    }});
+
+    benches.push_back({"GameCore::calculateGhostPiece", [state, count](long long ops) {
+        int rows = 0;
+        for (long long i = 0; i < ops; ++i) {
+            rows += state->cores[i % count].calculateGhostPiece().pos.y;
+        }
+        keep(rows);
+    }});
+
+    benches.push_back({"Board::clearLines (copy, no full rows)",
+                       [fixtures, count](long long ops) {
+        int lines = 0;
+        for (long long i = 0; i < ops; ++i) {
+            Board board = fixtures[i % count].board;
+            lines += board.clearLines();
+            keep(board);
+        }
+        keep(lines);
+    }});
+
+    benches.push_back({"Board::clearLines (copy, 4 full rows)",
+                       [state, count](long long ops) {
+        int lines = 0;
+        for (long long i = 0; i < ops; ++i) {
+            Board board = state->fullRows[i % count];
+            lines += board.clearLines();
+            keep(board);
+        }
+        keep(lines);
+    }});
+
+    benches.push_back({"Board::render (string)", [fixtures, state, count](long long ops) {
+        for (long long i = 0; i < ops; ++i) {
+            fixtures[i % count].board.render(state->gameState, state->preview,
+                                             state->frame);
+            keep(state->frame);
+        }
+    }});
+
+    // The frame the game sends: effects over the display board, the full
+    // render, then only the lines that changed since the last fixture.
+    benches.push_back({"renderFrame+appendChangedLines", [fixtures, state, count](long long ops) {
+        for (long long i = 0; i < ops; ++i) {
+            state->display = fixtures[i % count].board;
+            state->gameState.panelLines.clear();
+            renderFrame(state->display, state->gameState, state->animator,
+                        state->preview, i * 16000, state->frame);
+            state->changed.clear();
+            appendChangedLines(state->frame, state->lineHash, false, state->changed);
+            keep(state->changed);
+        }
+    }});
+
+    benches.push_back({"renderPiecePreview", [state](long long ops) {
+        for (long long i = 0; i < ops; ++i) {
+            renderPiecePreview(static_cast<int>(i % 7), state->preview);
+            keep(state->preview[0]);
+        }
+    }});
+
+    // Bot-side counterparts of the collision and placement code.
+    benches.push_back({"BitBoard::collides", [state, fixtures, count](long long ops) {
+        int hits = 0;
+        for (long long i = 0; i < ops; ++i) {
+            const Piece& p = fixtures[(i >> 2) % count].piece;
+            hits += state->bitBoards[(i >> 2) % count].collides(
+                p.type, (p.rotation + (i & 1)) % 4,
+                p.pos.x + static_cast<int>(i & 2) - 1, p.pos.y);
+        }
+        keep(hits);
+    }});
+
+    benches.push_back({"MoveGenerator::generate", [state, fixtures, count](long long ops) {
+        for (long long i = 0; i < ops; ++i) {
+            state->generator.generate(state->bitBoards[i % count],
+                                      fixtures[i % count].piece,
+                                      state->placements);
+            keep(state->placements.size());
+        }
+    }});
+
+    // One piece's placements scored as a batch and board by board, per
+    // board scored.
+    benches.push_back({"BoardBatch::evaluate (per board)", [state](long long ops) {
+        HeuristicWeights weights;
+        double sum = 0.0;
+        for (long long done = 0; done < ops; done += state->batchBoards.size()) {
+            state->batch.clear();
+            for (const BitBoard& board : state->batchBoards) {
+                state->batch.add(board, 0);
+            }
+            state->batch.evaluate(weights, state->scores);
+            sum += state->scores[0];
+        }
+        keep(sum);
+    }});
+
+    benches.push_back({"computeFeatures+evaluateFeatures (scalar)",
+                       [state](long long ops) {
+        HeuristicWeights weights;
+        double sum = 0.0;
+        size_t boards = state->batchBoards.size();
+        for (long long i = 0; i < ops; ++i) {
+            sum += evaluateFeatures(computeFeatures(state->batchBoards[i % boards], 0),
+                                    weights);
+        }
+        keep(sum);
+    }});
+
+    // The other board sizes compiled into every binary.
+    addBoardSizeBenches<GameCore10x20>(benches, "clearLines 10x20 (copy, 4 full rows)",
+                                       "step+tick 10x20 (key pattern)");
+    addBoardSizeBenches<GameCore10x40>(benches, "clearLines 10x40 (copy, 4 full rows)",
+                                       "step+tick 10x40 (key pattern)");
+    addBoardSizeBenches<StressGameCore>(benches, "clearLines 64x128 (copy, 4 full rows)",
+                                        "step+tick 64x128 (key pattern)");
+
+    // The bots on the sizes they are compiled for.
+    addBotBench<BOARD_WIDTH, BOARD_HEIGHT>(benches, "greedy step+tick 15x20");
+    addBotBench<10, 20>(benches, "greedy step+tick 10x20");
+    addBotBench<10, 40>(benches, "greedy step+tick 10x40");
+
+    return benches;
+}
+
+// --- Allocation checks ----------------------------------------------------
+
+// A steady-state path of the game that must not allocate; `frame` runs one
+// frame of it.
+struct AllocCheck {
+    const char*           name;
+    std::function<void()> frame;
+};
+
+// One key every few frames in a fixed pattern, like a player.
+GameAction keyFor(long frame) {
+    static const GameAction ACTIONS[] = {
+        GameAction::MoveLeft, GameAction::MoveRight, GameAction::Rotate,
+        GameAction::SoftDrop, GameAction::None, GameAction::None,
+        GameAction::None, GameAction::HardDrop
+    };
+    return ACTIONS[(frame * 5 + (frame >> 3)) & 7];
+}
+
+std::vector<AllocCheck> makeAllocChecks() {
+    struct State {
+        long        frame{0};
+        uint32_t    seed{1};
+        GameCore    core{1};
+        Board       display;
+        GameState   gameState;
+        std::string preview[4];
+        int         previewType{-1};
+        std::string frameText;
+        Replay      replay;
+
+        FramePacer  pacer;
+        Animator    animator;
+        int         nullFd{-1};
+
+        std::vector<std::string> tileLines;
+        std::string tileLabel;
+        std::string tileOut;
+        TileCompositor compositor;
+
+        std::unique_ptr<VersusMatch> match;
+        GameCore    versusCores[2];
+
+        std::unique_ptr<BroadcastServer> broadcast;
+        std::string broadcastPath;
+        int         spectatorFd{-1};
+
+        ~State() {
+            if (spectatorFd >= 0) close(spectatorFd);
+            if (nullFd >= 0) close(nullFd);
+        }
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+    state->replay.begin(1, RandomizerMode::Uniform);
+    state->compositor.setLayout(1, 1, 1, 48);
+    state->match.reset(new VersusMatch(2, 1));
+
+    std::vector<AllocCheck> checks;
+
+    // What TetrisGame::run() does per frame: a key, gravity, then the
+    // game's own composeFrame() and presentFrame() code (composeBoard(),
+    // the cached preview and renderFrame()).
+    checks.push_back({"game frame (input, gravity, compose, draw)", [state]() {
+        State& s = *state;
+        if (s.core.isGameOver()) s.core.reset(++s.seed);
+        s.core.step(keyFor(s.frame));
+        s.core.tick();
+        ++s.frame;
+
+        s.gameState.score        = s.core.getScore();
+        s.gameState.level        = s.core.getLevel();
+        s.gameState.linesCleared = s.core.getLinesCleared();
+
+        composeBoard(s.core, s.display, true);
+        if (s.previewType != s.core.getNextPieceType()) {
+            s.previewType = s.core.getNextPieceType();
+            renderPiecePreview(s.previewType, s.preview);
+        }
+        s.gameState.panelLines.clear();
+        renderFrame(s.display, s.gameState, s.animator, s.preview,
+                    static_cast<long long>(s.frame) * 16000, s.frameText);
+    }});
+
+    // The same frame with effects running, reduced to the changed lines
+    // and written, here to /dev/null, as presentFrame() submits it.
+    checks.push_back({"paced frame (effects, line diff, write)", [state]() {
+        State& s = *state;
+        if (s.nullFd < 0) {
+            s.nullFd = open("/dev/null", O_WRONLY);
+            s.pacer.open(s.nullFd);
+        }
+        if (s.core.isGameOver()) s.core.reset(++s.seed);
+        s.core.step(keyFor(s.frame));
+        LockResult lock = s.core.tick().lock;
+        s.animator.lineClear(lock.clearedTop, lock.clearedRows);
+        if (s.frame % 100 == 0) s.animator.levelUp(s.core.getLevel());
+        ++s.frame;
+
+        long long now = static_cast<long long>(s.frame) * 16000;
+        composeBoard(s.core, s.display, true);
+        s.gameState.panelLines.clear();
+        renderFrame(s.display, s.gameState, s.animator, s.preview, now, s.frameText);
+        if (s.pacer.ready(now)) s.pacer.submit(s.frameText, now);
+    }});
+
+    checks.push_back({"replay recording", [state]() {
+        State& s = *state;
+        s.replay.recordAction(keyFor(s.frame++));
+        s.replay.recordTick();
+        if (s.replay.events.size() > 60000) s.replay.events.clear();
+    }});
+
+    // The versus opponent: tile rendering and the per-line diff.
+    checks.push_back({"opponent tile (render, diff)", [state]() {
+        State& s = *state;
+        if (s.core.isGameOver()) s.core.reset(++s.seed);
+        s.core.step(keyFor(s.frame));
+        s.core.tick();
+        ++s.frame;
+
+        s.tileLabel = "BOT ";
+        appendInt(s.tileLabel, s.core.getScore());
+        renderBoardTile(s.core, s.tileLabel, s.tileLines);
+        s.tileOut.clear();
+        s.compositor.update(0, s.tileLines, s.tileOut);
+    }});
+
+    // Both boards of a versus match on one thread: sync, keys, gravity,
+    // garbage sent through the mailboxes.
+    checks.push_back({"versus frame (sync, send, 2 boards)", [state]() {
+        State& s = *state;
+        for (int b = 0; b < 2; ++b) {
+            GameCore& core = s.versusCores[b];
+            if (!s.match->sync(b, core) || core.isGameOver()) {
+                s.match->reset(++s.seed);
+                for (GameCore& c : s.versusCores) c.reset(s.seed);
+                return;
+            }
+            s.match->send(b, core, core.step(keyFor(s.frame + b * 3)).lock);
+            s.match->send(b, core, core.tick().lock);
+        }
+        ++s.frame;
+    }});
+
+    // Publishing to one spectator: the game thread's copy and wakeup, and
+    // the broadcaster thread's encoding and fan-out (the counter sees every
+    // thread).
+    checks.push_back({"broadcast publish (1 spectator)", [state]() {
+        State& s = *state;
+        if (!s.broadcast) {
+            s.broadcastPath = "/tmp/tetris-bench-" + std::to_string(getpid()) + ".sock";
+            std::string error;
+            s.broadcast.reset(new BroadcastServer());
+            if (!s.broadcast->start(s.broadcastPath, error) ||
+                (s.spectatorFd = connectTo(s.broadcastPath, error)) < 0) {
+                std::fprintf(stderr, "%s\n", error.c_str());
+                std::exit(1);
+            }
+            while (s.broadcast->clientCount() < 1) usleep(1000);
+        }
+        if (s.core.isGameOver()) s.core.reset(++s.seed);
+        s.core.step(keyFor(s.frame));
+        s.core.tick();
+        ++s.frame;
+        s.broadcast->publish(s.core, s.gameState);
+
+        char chunk[4096];
+        while (recv(s.spectatorFd, chunk, sizeof(chunk), MSG_DONTWAIT) > 0) {
+        }
+    }});
+
+    return checks;
+}
+
+// Run each check for `warmup` frames so its buffers reach their working
+// size, then count the allocations of `frames` more. Returns the number
+// of checks that allocated.
+int runAllocChecks(const std::string& filter, int warmup, int frames) {
+    NullBuffer      sink;
+    std::streambuf* saved = std::cout.rdbuf(&sink);
+
+    struct Outcome {
+        const char* name;
+        long long   allocations;
+    };
+    std::vector<Outcome> outcomes;
+    for (const AllocCheck& check : makeAllocChecks()) {
+        if (std::string(check.name).find(filter) == std::string::npos) continue;
+
+        for (int i = 0; i < warmup; ++i) check.frame();
+        long long before = heapAllocations();
+        for (int i = 0; i < frames; ++i) check.frame();
+        outcomes.push_back({check.name, heapAllocations() - before});
+    }
+    std::cout.rdbuf(saved);
+
+    int failed = 0;
+    std::printf("%-42s %12s\n", "allocation check", "allocations");
+    for (const Outcome& o : outcomes) {
+        std::printf("%-42s %12lld%s\n", o.name, o.allocations,
+                    o.allocations ? "  FAIL" : "");
+        if (o.allocations) ++failed;
+    }
+    std::printf("%d frames each after %d warm-up frames: %s\n", frames, warmup,
+                failed ? "allocations found" : "no allocations");
+    return failed;
+}
+
+// --- Batch evaluator check ------------------------------------------------
+
+// A random W x H board: stacked columns with holes, noise rows, or a mix of
+// full and empty rows, each under a random top.
+template <int W, int H>
+BasicBitBoard<W, H> randomBoard(Xoshiro256& rng) {
+    using BoardType = BasicBitBoard<W, H>;
+    using RowMask   = typename BoardType::RowMask;
+
+    BoardType board;
+    int style = static_cast<int>(rng.below(3));
+    int top   = static_cast<int>(rng.below(H + 1));
+    if (style == 0) {
+        for (int x = 0; x < W; ++x) {
+            int height = static_cast<int>(rng.below(H - top + 1));
+            for (int y = H - height; y < H; ++y) {
+                if (rng.below(8) == 0) continue;   // Hole.
+                board.setRow(y, static_cast<RowMask>(board.rows[y] | (RowMask(1) << x)));
+            }
+        }
+    } else {
+        for (int y = top; y < H; ++y) {
+            RowMask mask = style == 1 ? static_cast<RowMask>(rng.next())
+                                      : (rng.below(2) ? BoardType::FULL_ROW : 0);
+            board.setRow(y, static_cast<RowMask>(mask & BoardType::FULL_ROW));
+        }
+    }
+    return board;
+}
+
+bool sameFeatures(const BoardFeatures& a, const BoardFeatures& b) {
+    return a.aggregateHeight == b.aggregateHeight &&
+           a.completeLines   == b.completeLines &&
+           a.holes           == b.holes &&
+           a.bumpiness       == b.bumpiness &&
+           a.wellDepth       == b.wellDepth &&
+           a.rowTransitions  == b.rowTransitions &&
+           a.maxHeight       == b.maxHeight;
+}
+
+// Batches of 1..BATCH_CAPACITY random boards (partial lane groups
+// included) against computeFeatures() and evaluateFeatures() per board.
+// Returns the number of boards that differ.
+template <int W, int H>
+long checkBatch(const char* name, uint64_t seed, int batches) {
+    Xoshiro256 rng(seed);
+    HeuristicWeights weights;
+    for (int i = 0; i < HEURISTIC_WEIGHT_COUNT; ++i) {
+        weightAt(weights, i) = static_cast<double>(rng.below(2001)) / 1000.0 - 1.0;
+    }
+
+    std::unique_ptr<BasicBoardBatch<W, H>> batch(new BasicBoardBatch<W, H>());
+    BasicBitBoard<W, H> boards[BATCH_CAPACITY];
+    int                 lines[BATCH_CAPACITY];
+    BoardFeatures       features[BATCH_CAPACITY];
+    double              scores[BATCH_CAPACITY];
+
+    long checked = 0, failed = 0;
+    for (int b = 0; b < batches; ++b) {
+        int size = 1 + static_cast<int>(rng.below(BATCH_CAPACITY));
+        batch->clear();
+        for (int i = 0; i < size; ++i) {
+            boards[i] = randomBoard<W, H>(rng);
+            lines[i]  = static_cast<int>(rng.below(5));
+            batch->add(boards[i], lines[i]);
+        }
+        batch->computeFeatures(features);
+        batch->evaluate(weights, scores);
+
+        for (int i = 0; i < size; ++i) {
+            BoardFeatures expected = computeFeatures(boards[i], lines[i]);
+            ++checked;
+            if (sameFeatures(features[i], expected) &&
+                scores[i] == evaluateFeatures(expected, weights)) {
+                continue;
+            }
+            if (failed++ == 0) {
+                std::printf("%s: batch %d board %d differs from computeFeatures()\n",
+                            name, b, i);
+            }
+        }
+    }
+    std::printf("%-8s %8ld boards %8ld differ%s\n", name, checked, failed,
+                failed ? "  FAIL" : "");
+    return failed;
+}
+
+int runBatchChecks(int batches) {
+    long failed = checkBatch<10, 20>("10x20", 1, batches) +
+                  checkBatch<10, 40>("10x40", 2, batches) +
+                  checkBatch<BOARD_WIDTH, BOARD_HEIGHT>("15x20", 3, batches);
+    std::printf("BoardBatch against the scalar features: %s\n",
+                failed ? "mismatches found" : "identical");
+    return failed ? 1 : 0;
+}
+
+// --- Search table report --------------------------------------------------
+
+// Play the same seeded beam search games with the transposition table
+// holding root moves only and with last-ply scores cached as well, and
+// report the time per piece and how often a cached last-ply score is found.
+void runSearchTableReport(int games, long pieces) {
+    struct Variant {
+        const char* name;
+        int         depth;
+        int         beamWidth;
+    };
+    // The configurations of createPolicy()'s beam and beam-deep.
+    static const Variant VARIANTS[] = {
+        {"beam (depth 2)",      2, 16},
+        {"beam-deep (depth 4)", 4, 8}
+    };
+
+    std::printf("%-22s %-7s %10s %12s %12s %8s %12s\n", "search", "leaves",
+                "us/piece", "probes", "hits", "hit %", "score sum");
+    for (const Variant& variant : VARIANTS) {
+        for (int leaves = 0; leaves < 2; ++leaves) {
+            SearchConfig config;
+            config.depth        = variant.depth;
+            config.beamWidth    = variant.beamWidth;
+            config.timeBudgetUs = 0;
+            config.cacheLeaves  = leaves != 0;
+
+            long long probes = 0, hits = 0, placed = 0, scores = 0;
+            std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+            for (int game = 1; game <= games; ++game) {
+                GameCore         core(static_cast<uint32_t>(game));
+                BeamSearchPlayer bot(config);
+                while (!core.isGameOver() && core.getPiecesPlaced() < pieces) {
+                    core.step(bot.nextAction(core));
+                    core.tick();
+                }
+                probes += bot.getSearcher().leafProbes();
+                hits   += bot.getSearcher().leafHits();
+                placed += core.getPiecesPlaced();
+                scores += core.getScore();
+            }
+            double seconds = secondsSince(start);
+
+            std::printf("%-22s %-7s %10.1f %12lld %12lld %8.2f %12lld\n",
+                        variant.name, leaves ? "cached" : "off",
+                        placed ? seconds * 1e6 / placed : 0.0, probes, hits,
+                        probes ? 100.0 * hits / probes : 0.0, scores);
+        }
+    }
+    std::printf("%d games of up to %ld pieces per row\n", games, pieces);
+}
+
+// --- Reports --------------------------------------------------------------
+
+void writeText(FILE* out, const std::vector<BenchResult>& results) {
+    std::fprintf(out, "%-42s %12s %12s %12s %10s\n", "benchmark", "ns/op", "min ns/op",
+                 "ops/sample", "allocs/op");
+    for (const BenchResult& r : results) {
+        std::fprintf(out, "%-42s %12.2f %12.2f %12lld %10.3g\n", r.name.c_str(),
+                     r.nsPerOp, r.minNsPerOp, r.iterations, r.allocsPerOp);
+    }
+}
+
+// One benchmark per line so loadJson() can read it back without a parser.
+void writeJson(FILE* out, const std::vector<BenchResult>& results) {
+    std::fprintf(out, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::fprintf(out,
+            "    {\"name\": \"%s\", \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f, "
+            "\"iterations\": %lld, \"allocs_per_op\": %.6g}%s\n",
+            r.name.c_str(), r.nsPerOp, r.minNsPerOp, r.iterations, r.allocsPerOp,
+            i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+bool loadJson(const std::string& path, std::vector<BenchResult>& out) {
+    std::ifstream in(path.c_str());
+    if (!in) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t name = line.find("\"name\": \"");
+        size_t ns   = line.find("\"ns_per_op\": ");
+        if (name == std::string::npos || ns == std::string::npos) continue;
+
+        name += 9;
+        BenchResult r;
+        r.name    = line.substr(name, line.find('"', name) - name);
+        r.nsPerOp = std::atof(line.c_str() + ns + 13);
+
+        // Baselines written before allocations were counted have none.
+        size_t allocs = line.find("\"allocs_per_op\": ");
+        r.allocsPerOp = allocs == std::string::npos
+                            ? -1.0 : std::atof(line.c_str() + allocs + 17);
+        out.push_back(r);
+    }
+    return true;
+}
+
+// Benchmarks slower than the baseline by more than thresholdPercent are
+// regressions, and so are those that allocate where the baseline did not;
+// returns how many there are.
+int compareResults(const std::vector<BenchResult>& baseline,
+                   const std::vector<BenchResult>& current,
+                   double thresholdPercent) {
+    int regressions = 0;
+    std::printf("%-42s %12s %12s %9s\n", "benchmark", "base ns/op", "now ns/op",
+                "change");
+    for (const BenchResult& now : current) {
+        const BenchResult* base = nullptr;
+        for (const BenchResult& b : baseline) {
+            if (b.name == now.name) base = &b;
+        }
+        if (!base || base->nsPerOp <= 0.0) {
+            std::printf("%-42s %12s %12.2f %9s\n", now.name.c_str(), "-",
+                        now.nsPerOp, "new");
+            continue;
+        }
+
+        double change = (now.nsPerOp / base->nsPerOp - 1.0) * 100.0;
+        bool   slower = change > thresholdPercent;
+        bool   allocates = base->allocsPerOp == 0.0 && now.allocsPerOp > 0.0;
+        if (slower || allocates) ++regressions;
+        std::printf("%-42s %12.2f %12.2f %+8.1f%%%s%s\n", now.name.c_str(),
+                    base->nsPerOp, now.nsPerOp, change,
+                    slower ? "  REGRESSION" : "",
+                    allocates ? "  ALLOCATES" : "");
+    }
+    std::printf("%d regression(s): over %.1f%% slower or newly allocating\n",
+                regressions, thresholdPercent);
+    return regressions;
+}
+
+void printUsage(const char* program) {
+    std::printf(
+        "Usage: %s [options]\n"
+        "  --fixtures FILE        board fixtures (default tools/bench_fixtures.txt)\n"
+        "  --filter TEXT          only benchmarks whose name contains TEXT\n"
+        "  --min-time S           seconds per benchmark (default 0.5)\n"
+        "  --samples N            timed samples, median reported (default 5)\n"
+        "  --format F             text or json (default text)\n"
+        "  --output FILE          write the results to FILE instead of stdout\n"
+        "  --compare FILE         report changes against a JSON baseline\n"
+        "  --current FILE         compare this JSON instead of running\n"
+        "  --threshold P          slowdown in percent that fails (default 10)\n"
+        "  --record-fixtures FILE snapshot boards from seeded games\n"
+        "  --alloc-check          count heap allocations of the frame paths\n"
+        "                         instead, failing if there are any\n"
+        "  --batch-check          compare BoardBatch with computeFeatures() on\n"
+        "                         random boards instead, failing on a mismatch\n"
+        "  --search-tt            time beam search with last-ply scores cached\n"
+        "                         in the transposition table and without\n",
+        program);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string fixturePath = "tools/bench_fixtures.txt";
+    std::string filter;
+    std::string format = "text";
+    const char* outputPath  = nullptr;
+    const char* comparePath = nullptr;
+    const char* currentPath = nullptr;
+    const char* recordPath  = nullptr;
+    double      minSeconds  = 0.5;
+    double      threshold   = 10.0;
+    int         samples     = 5;
+    bool        allocCheck  = false;
+    bool        searchTable = false;
+    bool        batchCheck  = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg  = argv[i];
+        const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (std::strcmp(arg, "--alloc-check") == 0) {
+            allocCheck = true;
+            continue;
+        }
+        if (std::strcmp(arg, "--batch-check") == 0) {
+            batchCheck = true;
+            continue;
+        }
+        if (std::strcmp(arg, "--search-tt") == 0) {
+            searchTable = true;
+            continue;
+        }
+        if (!next) {
+            std::fprintf(stderr, "Missing value for %s\n", arg);
+            return 1;
+        }
+
+        if (std::strcmp(arg, "--fixtures") == 0) {
+            fixturePath = next;
+        } else if (std::strcmp(arg, "--filter") == 0) {
+            filter = next;
+        } else if (std::strcmp(arg, "--min-time") == 0) {
+            minSeconds = std::atof(next);
+        } else if (std::strcmp(arg, "--samples") == 0) {
+            samples = std::max(1, std::atoi(next));
+        } else if (std::strcmp(arg, "--format") == 0) {
+            format = next;
+        } else if (std::strcmp(arg, "--output") == 0) {
+            outputPath = next;
+        } else if (std::strcmp(arg, "--compare") == 0) {
+            comparePath = next;
+        } else if (std::strcmp(arg, "--current") == 0) {
+            currentPath = next;
+        } else if (std::strcmp(arg, "--threshold") == 0) {
+            threshold = std::atof(next);
+        } else if (std::strcmp(arg, "--record-fixtures") == 0) {
+            recordPath = next;
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+        ++i;
+    }
+
+    BlockTemplate::initializeTemplates();
+
+    if (recordPath) return recordFixtures(recordPath) ? 0 : 1;
+    if (allocCheck) return runAllocChecks(filter, 2000, 20000) > 0 ? 1 : 0;
+    if (batchCheck) return runBatchChecks(2000);
+    if (searchTable) {
+        runSearchTableReport(8, 150);
+        return 0;
+    }
+
+    if (format != "text" && format != "json") {
+        std::fprintf(stderr, "Unknown format '%s'\n", format.c_str());
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    if (currentPath) {
+        if (!loadJson(currentPath, results)) {
+            std::fprintf(stderr, "Cannot read %s\n", currentPath);
+            return 1;
+        }
+    } else {
+        std::vector<Fixture> fixtures;
+        if (!loadFixtures(fixturePath, fixtures)) {
+            std::fprintf(stderr, "Cannot load fixtures from %s\n",
+                         fixturePath.c_str());
+            return 1;
+        }
+
+        for (const Benchmark& bench : makeBenchmarks(fixtures)) {
+            if (std::string(bench.name).find(filter) == std::string::npos) {
+                continue;
+            }
+            results.push_back(measure(bench, minSeconds, samples));
+            // Progress goes to stderr so redirected output stays clean.
+            std::fprintf(stderr, "%-42s %10.2f ns/op\n", bench.name,
+                         results.back().nsPerOp);
+        }
+
+        FILE* out = stdout;
+        if (outputPath) {
+            out = std::fopen(outputPath, "w");
+            if (!out) {
+                std::fprintf(stderr, "Cannot open %s\n", outputPath);
+                return 1;
+            }
+        }
+        if (format == "json") {
+            writeJson(out, results);
+        } else if (!comparePath || outputPath) {
+            writeText(out, results);
+        }
+        if (out != stdout) std::fclose(out);
+    }
+
+    if (comparePath) {
+        std::vector<BenchResult> baseline;
+        if (!loadJson(comparePath, baseline)) {
+            std::fprintf(stderr, "Cannot read %s\n", comparePath);
+            return 1;
+        }
+        return compareResults(baseline, results, threshold) > 0 ? 1 : 0;
+    }
+    return 0;
+}
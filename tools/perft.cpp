@@ -0,0 +1,451 @@
+// Move generation perft: counts every placement reachable over the piece
+// sequence a seed deals, the way chess engines count move trees. Tracks
+// move generation speed and catches collision bugs in the fast path.
+//
+//   ./perft --seed 1 --depth 4
+//   ./perft --seed 1 --depth 3 --reference --divide
+//   ./perft --board 10x20 --depth 3 --reference
+//   ./perft --check tools/perft.expected
+
+#include "BitBoard.h"
+#include "GameCore.h"
+#include "MoveGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int KICKS[] = {0, -1, 1, -2, 2, -3, 3};
+
+// Placements counted at each ply; perft(d) is plies[d - 1].
+struct PerftResult {
+    std::vector<long long> plies;
+    long long              nodes{0};   // Placements generated, every ply.
+    double                 seconds{0.0};
+};
+
+// Root placement and the leaves of its subtree, for --divide.
+struct DivideLine {
+    int       rotation;
+    int       x;
+    int       y;
+    long long leaves;
+};
+
+// Where GameCore spawns a piece on a board `width` wide.
+Piece spawnPiece(int type, int width) {
+    Piece spawn;
+    spawn.type = type;
+    spawn.pos  = Position(width / 2 - BlockTemplate::BLOCK_SIZE / 2, SPAWN_Y);
+    return spawn;
+}
+
+// A piece locked with a cell above the top edge ends the game.
+bool abovePlayfield(int type, int rotation, int y) {
+    return y + pieceShape(type, rotation).minRow < 0;
+}
+
+// Fast path: BitBoard and MoveGenerator.
+template <int W, int H>
+class FastPerft {
+public:
+    FastPerft(const std::vector<int>& pieces, int depth)
+        : pieces(pieces), lists(depth) {}
+
+    void run(const BasicBitBoard<W, H>& board, int ply, PerftResult& result,
+             std::vector<DivideLine>* divide) {
+        std::vector<Placement>& moves = lists[ply];
+        int type = pieces[ply];
+        generator.generate(board, spawnPiece(type, W), moves);
+
+        result.plies[ply] += static_cast<long long>(moves.size());
+        result.nodes      += static_cast<long long>(moves.size());
+        bool last = ply + 1 == static_cast<int>(lists.size());
+        if (last && !divide) return;
+
+        for (const Placement& p : moves) {
+            long long before = result.plies.back();
+            if (!last && !abovePlayfield(type, p.rotation, p.y)) {
+                BasicBitBoard<W, H> child = board;
+                child.place(type, p.rotation, p.x, p.y);
+                run(child, ply + 1, result, nullptr);
+            }
+            if (divide) {
+                DivideLine line = {p.rotation, p.x, p.y,
+                                   last ? 1 : result.plies.back() - before};
+                divide->push_back(line);
+            }
+        }
+    }
+
+private:
+    const std::vector<int>&             pieces;
+    std::vector<std::vector<Placement>> lists;   // One list per ply.
+    BasicMoveGenerator<W, H>            generator;
+};
+
+// Reference path: the game's own character board and GameCore::canPlace,
+// one piece state at a time.
+template <int W, int H>
+class ReferencePerft {
+public:
+    using Board = BasicBoard<W, H>;
+    using Core  = BasicGameCore<W, H>;
+
+    ReferencePerft(const std::vector<int>& pieces, int depth)
+        : pieces(pieces), depth(depth) {}
+
+    void run(const Board& board, int ply, PerftResult& result,
+             std::vector<DivideLine>* divide) {
+        std::vector<Piece> moves;
+        generate(board, spawnPiece(pieces[ply], W), moves);
+
+        result.plies[ply] += static_cast<long long>(moves.size());
+        result.nodes      += static_cast<long long>(moves.size());
+        bool last = ply + 1 == depth;
+        if (last && !divide) return;
+
+        for (const Piece& p : moves) {
+            long long before = result.plies.back();
+            if (!last && !abovePlayfield(p.type, p.rotation, p.pos.y)) {
+                Board child = board;
+                lock(child, p);
+                run(child, ply + 1, result, nullptr);
+            }
+            if (divide) {
+                DivideLine line = {p.rotation, p.pos.x, p.pos.y,
+                                   last ? 1 : result.plies.back() - before};
+                divide->push_back(line);
+            }
+        }
+    }
+
+private:
+    static const int X_SLOTS = W + BlockTemplate::BLOCK_SIZE;
+    static const int Y_SLOTS = H + BlockTemplate::BLOCK_SIZE;
+
+    const std::vector<int>& pieces;
+    int                     depth;
+
+    static int stateIndex(const Piece& p) {
+        return (p.rotation * X_SLOTS + p.pos.x + BlockTemplate::BLOCK_SIZE) *
+               Y_SLOTS + p.pos.y + BlockTemplate::BLOCK_SIZE;
+    }
+
+    // Occupied cells of a piece as one number, equal for equal cell sets.
+    static uint64_t cellKey(const Piece& p) {
+        uint64_t key = 0;
+        for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
+            for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
+                if (BlockTemplate::getCell(p.type, p.rotation, row, col) == ' ') {
+                    continue;
+                }
+                int cell = (p.pos.y + row + BlockTemplate::BLOCK_SIZE) * W +
+                           p.pos.x + col;
+                key = key << 10 | static_cast<uint64_t>(cell);
+            }
+        }
+        return key;
+    }
+
+    // Every distinct lock position, found with one breadth-first search
+    // over the inputs GameCore accepts.
+    static void generate(const Board& board, const Piece& start,
+                         std::vector<Piece>& out) {
+        out.clear();
+        if (!Core::canPlace(board, start)) return;
+
+        std::vector<char>     visited(4 * X_SLOTS * Y_SLOTS, 0);
+        std::vector<uint64_t> locked;
+        std::vector<Piece>    queue(1, start);
+        visited[stateIndex(start)] = 1;
+
+        for (size_t head = 0; head < queue.size(); ++head) {
+            Piece p = queue[head];
+
+            Piece next[4] = {p, p, p, p};
+            --next[0].pos.x;
+            ++next[1].pos.x;
+            ++next[2].pos.y;
+
+            // Clockwise with the first kick that fits, like rotate().
+            bool rotated = false;
+            next[3].rotation = (p.rotation + 1) % 4;
+            for (int dx : KICKS) {
+                next[3].pos.x = p.pos.x + dx;
+                if (Core::canPlace(board, next[3])) {
+                    rotated = true;
+                    break;
+                }
+            }
+
+            for (int i = 0; i < 4; ++i) {
+                if (i == 3 ? !rotated : !Core::canPlace(board, next[i])) {
+                    continue;
+                }
+                char& seen = visited[stateIndex(next[i])];
+                if (!seen) {
+                    seen = 1;
+                    queue.push_back(next[i]);
+                }
+            }
+
+            // Hard drop from here.
+            Piece landed = p;
+            Piece below  = p;
+            ++below.pos.y;
+            while (Core::canPlace(board, below)) {
+                landed = below;
+                ++below.pos.y;
+            }
+
+            uint64_t key = cellKey(landed);
+            if (std::find(locked.begin(), locked.end(), key) == locked.end()) {
+                locked.push_back(key);
+                out.push_back(landed);
+            }
+        }
+    }
+
+    static void lock(Board& board, const Piece& p) {
+        for (int row = 0; row < BlockTemplate::BLOCK_SIZE; ++row) {
+            for (int col = 0; col < BlockTemplate::BLOCK_SIZE; ++col) {
+                char cell = BlockTemplate::getCell(p.type, p.rotation, row, col);
+                if (cell != ' ') board.setCell(p.pos.x + col, p.pos.y + row, cell);
+            }
+        }
+        board.clearLines();
+    }
+};
+
+template <int W, int H>
+PerftResult runPerft(uint32_t seed, int depth, bool reference,
+                     std::vector<DivideLine>* divide) {
+    std::vector<int> pieces = BasicGameCore<W, H>::pieceSequence(seed, depth);
+
+    PerftResult result;
+    result.plies.assign(depth, 0);
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    if (reference) {
+        BasicBoard<W, H> board;
+        board.init();
+        ReferencePerft<W, H>(pieces, depth).run(board, 0, result, divide);
+    } else {
+        FastPerft<W, H>(pieces, depth).run(BasicBitBoard<W, H>(), 0, result,
+                                           divide);
+    }
+    result.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void printResult(const char* name, const PerftResult& result) {
+    for (size_t d = 0; d < result.plies.size(); ++d) {
+        std::printf("%s perft(%zu) = %lld\n", name, d + 1, result.plies[d]);
+    }
+    std::printf("%s %lld nodes in %.3f s (%.0f nodes/s)\n", name,
+                result.nodes, result.seconds,
+                result.nodes / std::max(result.seconds, 1e-9));
+}
+
+struct ExpectedCount {
+    uint32_t  seed;
+    int       depth;
+    long long count;
+};
+
+// "seed depth count" lines; '#' starts a comment.
+bool loadExpected(const std::string& path, std::vector<ExpectedCount>& out) {
+    std::ifstream in(path.c_str());
+    if (!in) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        ExpectedCount e;
+        if (fields >> e.seed >> e.depth >> e.count) out.push_back(e);
+    }
+    return true;
+}
+
+// Compare every stored count with the fast path, and with the reference
+// path too when asked. The counts are for the game's board. Returns the
+// number of mismatches.
+int checkExpected(const std::vector<ExpectedCount>& expected, bool reference) {
+    int failures = 0;
+    for (const ExpectedCount& e : expected) {
+        PerftResult fast = runPerft<BOARD_WIDTH, BOARD_HEIGHT>(e.seed, e.depth,
+                                                               false, nullptr);
+        long long   got  = fast.plies.back();
+        bool        ok   = got == e.count;
+        std::printf("seed %u depth %d: fast %lld (%.0f nodes/s)",
+                    e.seed, e.depth, got,
+                    fast.nodes / std::max(fast.seconds, 1e-9));
+
+        if (reference) {
+            long long slow = runPerft<BOARD_WIDTH, BOARD_HEIGHT>(
+                e.seed, e.depth, true, nullptr).plies.back();
+            ok = ok && slow == e.count;
+            std::printf(", reference %lld", slow);
+        }
+        std::printf(", expected %lld %s\n", e.count, ok ? "ok" : "MISMATCH");
+        if (!ok) ++failures;
+    }
+    return failures;
+}
+
+void printUsage(const char* program) {
+    std::printf(
+        "Usage: %s [options]\n"
+        "  --seed S         seed of the piece sequence (default 1)\n"
+        "  --depth D        pieces to place (default 3)\n"
+        "  --reference      also run the slow reference path and compare\n"
+        "  --divide         leaves under each first placement\n"
+        "  --board WxH      15x20 (default), 10x20 or 10x40\n"
+        "  --check FILE     compare with stored \"seed depth count\" lines\n"
+        "                   (on the game's 15x20 board)\n",
+        program);
+}
+
+// One perft run on a W x H board; the exit status of main().
+template <int W, int H>
+int perft(uint32_t seed, int depth, bool reference, bool divide) {
+    std::vector<DivideLine> fastDivide, slowDivide;
+    PerftResult fast = runPerft<W, H>(seed, depth, false,
+                                      divide ? &fastDivide : nullptr);
+    printResult("fast", fast);
+    if (!reference) {
+        for (const DivideLine& line : fastDivide) {
+            std::printf("  rot %d x %d y %d: %lld\n",
+                        line.rotation, line.x, line.y, line.leaves);
+        }
+        return 0;
+    }
+
+    PerftResult slow = runPerft<W, H>(seed, depth, true,
+                                      divide ? &slowDivide : nullptr);
+    printResult("reference", slow);
+
+    // Roots are listed in a different order by each path; match them by
+    // the cells they cover.
+    if (divide) {
+        std::vector<int> pieces = BasicGameCore<W, H>::pieceSequence(seed, 1);
+        std::printf("first placements (fast / reference):\n");
+        for (const DivideLine& line : fastDivide) {
+            BasicBitBoard<W, H> cells;
+            cells.place(pieces[0], line.rotation, line.x, line.y);
+
+            long long other = -1;
+            for (const DivideLine& ref : slowDivide) {
+                BasicBitBoard<W, H> refCells;
+                refCells.place(pieces[0], ref.rotation, ref.x, ref.y);
+                if (refCells == cells) other = ref.leaves;
+            }
+            std::printf("  rot %d x %d y %d: %lld / %lld%s\n",
+                        line.rotation, line.x, line.y, line.leaves, other,
+                        line.leaves == other ? "" : "  <-- differs");
+        }
+    }
+
+    if (fast.plies != slow.plies) {
+        std::printf("MISMATCH between fast and reference counts\n");
+        return 1;
+    }
+    std::printf("fast path is %.1fx faster\n",
+                (slow.seconds / std::max(slow.nodes, 1LL)) /
+                std::max(fast.seconds / std::max(fast.nodes, 1LL), 1e-12));
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t    seed      = 1;
+    int         depth     = 3;
+    bool        reference = false;
+    bool        divide    = false;
+    const char* checkPath = nullptr;
+    int         width     = BOARD_WIDTH;
+    int         height    = BOARD_HEIGHT;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg  = argv[i];
+        const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (std::strcmp(arg, "--reference") == 0) {
+            reference = true;
+            continue;
+        }
+        if (std::strcmp(arg, "--divide") == 0) {
+            divide = true;
+            continue;
+        }
+        if (!next) {
+            std::fprintf(stderr, "Missing value for %s\n", arg);
+            return 1;
+        }
+
+        if (std::strcmp(arg, "--seed") == 0) {
+            seed = static_cast<uint32_t>(std::strtoul(next, nullptr, 10));
+        } else if (std::strcmp(arg, "--depth") == 0) {
+            depth = std::atoi(next);
+        } else if (std::strcmp(arg, "--check") == 0) {
+            checkPath = next;
+        } else if (std::strcmp(arg, "--board") == 0) {
+            if (!parseBoardSize(next, width, height)) {
+                std::fprintf(stderr, "Unknown board size '%s'\n", next);
+                return 1;
+            }
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+        ++i;
+    }
+
+    BlockTemplate::initializeTemplates();
+
+    if (checkPath) {
+        std::vector<ExpectedCount> expected;
+        if (!loadExpected(checkPath, expected) || expected.empty()) {
+            std::fprintf(stderr, "Cannot load counts from %s\n", checkPath);
+            return 1;
+        }
+        int failures = checkExpected(expected, reference);
+        if (failures > 0) {
+            std::printf("%d of %zu counts differ\n", failures, expected.size());
+            return 1;
+        }
+        return 0;
+    }
+
+    if (depth < 1) {
+        std::fprintf(stderr, "Depth must be at least 1\n");
+        return 1;
+    }
+
+    if (width == 10 && height == 20) {
+        return perft<10, 20>(seed, depth, reference, divide);
+    }
+    if (width == 10 && height == 40) {
+        return perft<10, 40>(seed, depth, reference, divide);
+    }
+    return perft<BOARD_WIDTH, BOARD_HEIGHT>(seed, depth, reference, divide);
+}
+
@@ -0,0 +1,308 @@
+// Headless replay: plays recorded games back at full speed, drawing every
+// frame into a null sink the way the game does (effects, changed lines
+// only), and checks each game ends where the recording did. Also the
+// training run of the PGO build (make pgo), and the exporter of replays
+// to asciinema recordings.
+//
+//   ./replay tools/replays/*.replay
+//   ./replay --repeat 20 tools/replays/*.replay
+//   ./replay --cast casts/ tools/replays/*.replay
+//   ./replay --record game.replay --policy beam --seed 7 --randomizer bag
+
+#include "Animation.h"
+#include "Asciicast.h"
+#include "Board.h"
+#include "FramePacer.h"
+#include "GameCore.h"
+#include "GameState.h"
+#include "Policy.h"
+#include "Replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Swallows everything written to it, like /dev/null without the syscalls.
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+void printUsage(const char* program) {
+    std::printf(
+        "Usage: %s [options] FILE...\n"
+        "  --repeat N       play the replays N times (default 1)\n"
+        "  --no-render      skip frame composition and drawing\n"
+        "  --quiet          only print the summary\n"
+        "  --cast DIR       write each replay as DIR/NAME.cast (asciinema v2)\n"
+        "Recording a bot game instead:\n"
+        "  --record FILE    write a replay of one headless game\n"
+        "  --policy NAME    player policy:",
+        program);
+    for (const std::string& name : policyNames()) {
+        std::printf(" %s", name.c_str());
+    }
+    std::printf(
+        " (default greedy)\n"
+        "  --seed S         game seed (default 1)\n"
+        "  --randomizer R   piece types: uniform, bag or history (default uniform)\n"
+        "  --max-pieces M   stop after M pieces (default no cap)\n"
+        "  --weights FILE   heuristic weights for the bot policies\n");
+}
+
+// Buffers of the game's frame path, kept across frames like TetrisGame
+// keeps them, so drawing does not allocate once they have grown.
+struct FrameView {
+    Board       board;
+    GameState   state;
+    Animator    animator;
+    std::string preview[4];
+    int         previewType{-1};
+    std::string frame;
+    std::string out;
+    uint64_t    lineHash[FRAME_LINES]{};
+    long long   now{0};           // Microseconds of game time.
+
+    // A new game starts on a cleared screen.
+    void restart() {
+        animator.clear();
+        std::fill(lineHash, lineHash + FRAME_LINES, 0);
+    }
+};
+
+// One frame as TetrisGame::presentFrame() sends it: the board composed with
+// the ghost on, the effects of the last lock drawn over it, then only the
+// lines that changed.
+void drawFrame(const GameCore& core, const LockResult& lock, FrameView& view) {
+    if (lock.locked) {
+        view.animator.lineClear(lock.clearedTop, lock.clearedRows);
+        if (lock.leveledUp) view.animator.levelUp(core.getLevel());
+    }
+    composeBoard(core, view.board, true);
+
+    view.state.score        = core.getScore();
+    view.state.level        = core.getLevel();
+    view.state.linesCleared = core.getLinesCleared();
+    view.state.panelLines.clear();
+
+    if (view.previewType != core.getNextPieceType()) {
+        view.previewType = core.getNextPieceType();
+        renderPiecePreview(view.previewType, view.preview);
+    }
+    renderFrame(view.board, view.state, view.animator, view.preview, view.now,
+                view.frame);
+    view.out.clear();
+    appendChangedLines(view.frame, view.lineHash, false, view.out);
+    std::cout.write(view.out.data(), static_cast<std::streamsize>(view.out.size()));
+
+    // The game loop sleeps a tick of the current level after drawing.
+    view.now += GameCore::computeDropSpeedUs(core.getLevel()) / DROP_INTERVAL_TICKS;
+}
+
+int recordGame(const char* path, const std::string& policyName, uint32_t seed,
+               RandomizerMode mode, long maxPieces,
+               const HeuristicWeights& weights) {
+    std::unique_ptr<Policy> policy = createPolicy(policyName, seed, weights);
+    if (!policy) {
+        std::fprintf(stderr, "Unknown policy '%s'\n", policyName.c_str());
+        return 1;
+    }
+
+    GameCore core(seed, mode);
+    Replay   replay;
+    replay.begin(seed, mode);
+
+    // One player action, then one gravity tick, like a frame of run().
+    while (!core.isGameOver()) {
+        if (maxPieces > 0 && core.getPiecesPlaced() >= maxPieces) break;
+
+        GameAction action = policy->nextAction(core);
+        replay.recordAction(action);
+        core.step(action);
+        if (core.isGameOver()) break;
+
+        replay.recordTick();
+        core.tick();
+    }
+    replay.finish(core);
+
+    if (!saveReplay(path, replay)) {
+        std::fprintf(stderr, "Cannot write %s\n", path);
+        return 1;
+    }
+    std::printf("%s: seed %u, %ld pieces, score %d, lines %d, %zu events\n",
+                path, seed, replay.pieces, replay.score, replay.lines,
+                replay.events.size());
+    return 0;
+}
+
+// Each replay as DIR/NAME.cast, NAME being the file name without its
+// directory and extension.
+int exportCasts(const std::vector<std::string>& files,
+                const std::vector<Replay>& replays, const std::string& dir) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::string name = files[i].substr(files[i].find_last_of('/') + 1);
+        name = name.substr(0, name.rfind('.'));
+        std::string path = dir + (dir.back() == '/' ? "" : "/") + name + ".cast";
+
+        std::string title = name + " (seed " + std::to_string(replays[i].seed) +
+                            ", " + randomizerModeName(replays[i].mode) + ")";
+        CastSummary summary;
+        if (!exportCast(replays[i], path, title, summary)) {
+            std::fprintf(stderr, "Cannot write %s\n", path.c_str());
+            return 1;
+        }
+        std::printf("%s: %ld frames, %d:%02d, %zu KB\n", path.c_str(),
+                    summary.frames, static_cast<int>(summary.seconds) / 60,
+                    static_cast<int>(summary.seconds) % 60,
+                    (summary.bytes + 1023) / 1024);
+    }
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "%zu recordings in %.3f s\n", files.size(), seconds);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long        repeat     = 1;
+    bool        render     = true;
+    bool        quiet      = false;
+    const char* recordPath = nullptr;
+    std::string castDir;
+    std::string policyName = "greedy";
+    uint32_t    seed       = 1;
+    RandomizerMode mode    = RandomizerMode::Uniform;
+    long        maxPieces  = 0;
+    HeuristicWeights weights;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg  = argv[i];
+        const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (std::strcmp(arg, "--no-render") == 0) {
+            render = false;
+            continue;
+        }
+        if (std::strcmp(arg, "--quiet") == 0) {
+            quiet = true;
+            continue;
+        }
+        if (std::strncmp(arg, "--", 2) != 0) {
+            files.push_back(arg);
+            continue;
+        }
+        if (!next) {
+            std::fprintf(stderr, "Missing value for %s\n", arg);
+            return 1;
+        }
+
+        if (std::strcmp(arg, "--repeat") == 0) {
+            repeat = std::atol(next);
+        } else if (std::strcmp(arg, "--cast") == 0) {
+            castDir = next;
+        } else if (std::strcmp(arg, "--record") == 0) {
+            recordPath = next;
+        } else if (std::strcmp(arg, "--policy") == 0) {
+            policyName = next;
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            seed = static_cast<uint32_t>(std::strtoul(next, nullptr, 10));
+        } else if (std::strcmp(arg, "--randomizer") == 0) {
+            if (!parseRandomizerMode(next, mode)) {
+                std::fprintf(stderr, "Unknown randomizer '%s'\n", next);
+                return 1;
+            }
+        } else if (std::strcmp(arg, "--max-pieces") == 0) {
+            maxPieces = std::atol(next);
+        } else if (std::strcmp(arg, "--weights") == 0) {
+            if (!loadWeights(next, weights)) {
+                std::fprintf(stderr, "Cannot load weights '%s'\n", next);
+                return 1;
+            }
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+        ++i;
+    }
+
+    BlockTemplate::initializeTemplates();
+
+    if (recordPath) {
+        return recordGame(recordPath, policyName, seed, mode, maxPieces, weights);
+    }
+    if (files.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Replay> replays(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!loadReplay(files[i], replays[i])) {
+            std::fprintf(stderr, "Cannot load replay '%s'\n", files[i].c_str());
+            return 1;
+        }
+    }
+
+    if (!castDir.empty()) return exportCasts(files, replays, castDir);
+
+    // Frames are drawn to a null sink so the run measures the game, not
+    // the terminal.
+    NullBuffer      sink;
+    std::streambuf* saved = std::cout.rdbuf(&sink);
+
+    GameCore    core;
+    FrameView   view;
+    LockResult  lock;
+    long long   frames      = 0;
+    int         mismatches  = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (long pass = 0; pass < repeat; ++pass) {
+        for (size_t i = 0; i < replays.size(); ++i) {
+            ReplayPlayer player(replays[i]);
+            player.start(core);
+            view.restart();
+            while (player.nextFrame(core, &lock)) {
+                if (render) drawFrame(core, lock, view);
+                ++frames;
+            }
+
+            if (pass > 0) continue;
+            bool ok = replays[i].matches(core);
+            if (!ok) ++mismatches;
+            if (!quiet || !ok) {
+                std::fprintf(stdout, "%s: %ld pieces, score %d, lines %d %s\n",
+                             files[i].c_str(), core.getPiecesPlaced(),
+                             core.getScore(), core.getLinesCleared(),
+                             ok ? "ok" : "MISMATCH");
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::cout.rdbuf(saved);
+
+    std::fprintf(stderr, "%lld frames in %.3f s (%.0f frames/s)\n",
+                 frames, seconds, seconds > 0 ? frames / seconds : 0.0);
+    return mismatches == 0 ? 0 : 1;
+}
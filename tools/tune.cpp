@@ -0,0 +1,392 @@
+// Heuristic weight tuner: a genetic algorithm over HeuristicWeights.
+// Every candidate of a generation plays the same seeded games (common
+// random numbers), games run in parallel on a work-stealing pool, and the
+// population is checkpointed after each generation.
+//
+//   ./tune --generations 50 --games 64 --output weights.txt
+//   ./tune --generations 50 --games 64 --resume # continue an interrupted run
+//   ./tetris --auto --weights weights.txt       # watch the result
+
+#include "SelfPlay.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct TuneConfig {
+    std::string policyName{"greedy"};
+    int         population{32};
+    int         generations{50};
+    int         games{32};          // Games per candidate per generation.
+    long        maxPieces{500};     // Cap per game so generations stay short.
+    int         elite{4};           // Best candidates copied unchanged.
+    double      mutation{0.2};      // Std dev of per-weight mutation.
+    uint32_t    seed{1};
+    int         threads{0};
+    bool        scoreFitness{true}; // Mean score, or mean lines cleared.
+    bool        resume{false};
+    std::string checkpointPath{"tune.ckpt"};
+    std::string outputPath{"weights.txt"};
+};
+
+struct Candidate {
+    HeuristicWeights weights;
+    double           fitness{0.0};
+};
+
+// Scaling all weights by a positive factor does not change which
+// placement wins, so candidates are kept on the unit sphere.
+void normalize(HeuristicWeights& w) {
+    double norm = 0.0;
+    for (int i = 0; i < HEURISTIC_WEIGHT_COUNT; ++i) {
+        norm += weightAt(w, i) * weightAt(w, i);
+    }
+    norm = std::sqrt(norm);
+    if (norm == 0.0) return;
+    for (int i = 0; i < HEURISTIC_WEIGHT_COUNT; ++i) weightAt(w, i) /= norm;
+}
+
+HeuristicWeights randomWeights(std::mt19937_64& rng) {
+    std::normal_distribution<double> gauss(0.0, 1.0);
+    HeuristicWeights w;
+    for (int i = 0; i < HEURISTIC_WEIGHT_COUNT; ++i) weightAt(w, i) = gauss(rng);
+    normalize(w);
+    return w;
+}
+
+// Random generator of one generation; resuming replays the same numbers.
+std::mt19937_64 generationRng(const TuneConfig& config, int generation) {
+    std::seed_seq seq{config.seed, static_cast<uint32_t>(generation), 0x7E7215u};
+    return std::mt19937_64(seq);
+}
+
+// First game seed of a generation. All candidates share these games.
+uint32_t firstGameSeed(const TuneConfig& config, int generation) {
+    return config.seed * 1000003u +
+           static_cast<uint32_t>(generation) * static_cast<uint32_t>(config.games);
+}
+
+void evaluate(const TuneConfig& config, int generation, ThreadPool& pool,
+              std::vector<Candidate>& population) {
+    size_t games = static_cast<size_t>(config.games);
+    std::vector<double> results(population.size() * games, 0.0);
+    uint32_t firstSeed = firstGameSeed(config, generation);
+
+    for (size_t c = 0; c < population.size(); ++c) {
+        for (size_t g = 0; g < games; ++g) {
+            pool.submit([&, c, g](int) {
+                uint32_t seed = firstSeed + static_cast<uint32_t>(g);
+                // No time limit: every candidate must play the same games
+                // on every run, and a resumed run must repeat the numbers.
+                std::unique_ptr<Policy> policy =
+                    createPolicy(batchPolicyName(config.policyName),
+                                 seed ^ 0x9E3779B9u,
+                                 population[c].weights,
+                                 SearchBudget::Unlimited);
+                GameResult r = playGame(seed, *policy, config.maxPieces);
+                results[c * games + g] = config.scoreFitness ? r.score : r.lines;
+            });
+        }
+    }
+    pool.wait();
+
+    // Summed in a fixed order so the outcome does not depend on scheduling.
+    for (size_t c = 0; c < population.size(); ++c) {
+        double sum = 0.0;
+        for (size_t g = 0; g < games; ++g) sum += results[c * games + g];
+        population[c].fitness = sum / config.games;
+    }
+}
+
+// Best of three random candidates (population sorted best first).
+const Candidate& tournament(const std::vector<Candidate>& population,
+                            std::mt19937_64& rng) {
+    std::uniform_int_distribution<size_t> pick(0, population.size() - 1);
+    size_t best = pick(rng);
+    for (int i = 0; i < 2; ++i) best = std::min(best, pick(rng));
+    return population[best];
+}
+
+std::vector<Candidate> breed(const TuneConfig& config,
+                             const std::vector<Candidate>& sorted,
+                             std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<double>       gauss(0.0, config.mutation);
+
+    std::vector<Candidate> next;
+    int elite = std::min(config.elite, static_cast<int>(sorted.size()));
+    for (int i = 0; i < elite; ++i) next.push_back(sorted[i]);
+
+    while (static_cast<int>(next.size()) < config.population) {
+        const Candidate& a = tournament(sorted, rng);
+        const Candidate& b = tournament(sorted, rng);
+
+        // Blend crossover, then Gaussian mutation of some weights.
+        Candidate child;
+        for (int i = 0; i < HEURISTIC_WEIGHT_COUNT; ++i) {
+            double t = unit(rng);
+            double v = t * weightAt(a.weights, i) + (1.0 - t) * weightAt(b.weights, i);
+            if (unit(rng) < 0.3) v += gauss(rng);
+            weightAt(child.weights, i) = v;
+        }
+        normalize(child.weights);
+        next.push_back(child);
+    }
+    return next;
+}
+
+// Checkpoint: the settings every generation's games depend on, the next
+// generation to evaluate and its population.
+bool saveCheckpoint(const TuneConfig& config, int generation,
+                    const std::vector<Candidate>& population) {
+    // Write a temporary file and rename it so a crash never leaves a
+    // half-written checkpoint behind.
+    std::string tmp = config.checkpointPath + ".tmp";
+    {
+        std::ofstream file(tmp);
+        if (!file.is_open()) return false;
+        file.precision(17);
+        file << "# tune checkpoint\n";
+        file << "policy " << config.policyName << '\n';
+        file << "seed " << config.seed << '\n';
+        file << "games " << config.games << '\n';
+        file << "max-pieces " << config.maxPieces << '\n';
+        file << "fitness " << (config.scoreFitness ? "score" : "lines") << '\n';
+        file << "generation " << generation << '\n';
+        for (const Candidate& c : population) {
+            file << "candidate";
+            for (int i = 0; i < HEURISTIC_WEIGHT_COUNT; ++i) {
+                file << ' ' << weightAt(c.weights, i);
+            }
+            file << '\n';
+        }
+        if (!file) return false;
+    }
+    return std::rename(tmp.c_str(), config.checkpointPath.c_str()) == 0;
+}
+
+// `saved` receives the settings the checkpoint was written with.
+bool loadCheckpoint(const TuneConfig& config, TuneConfig& saved,
+                    int& generation, std::vector<Candidate>& population) {
+    std::ifstream file(config.checkpointPath);
+    if (!file.is_open()) return false;
+
+    population.clear();
+    generation = -1;
+    int settings = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string tag;
+        if (!(fields >> tag) || tag[0] == '#') continue;
+
+        if (tag == "policy") {
+            if (!(fields >> saved.policyName)) return false;
+            ++settings;
+        } else if (tag == "seed") {
+            if (!(fields >> saved.seed)) return false;
+            ++settings;
+        } else if (tag == "games") {
+            if (!(fields >> saved.games)) return false;
+            ++settings;
+        } else if (tag == "max-pieces") {
+            if (!(fields >> saved.maxPieces)) return false;
+            ++settings;
+        } else if (tag == "fitness") {
+            std::string fitness;
+            if (!(fields >> fitness)) return false;
+            saved.scoreFitness = fitness == "score";
+            ++settings;
+        } else if (tag == "generation") {
+            if (!(fields >> generation)) return false;
+        } else if (tag == "candidate") {
+            Candidate c;
+            for (int i = 0; i < HEURISTIC_WEIGHT_COUNT; ++i) {
+                if (!(fields >> weightAt(c.weights, i))) return false;
+            }
+            population.push_back(c);
+        } else {
+            return false;
+        }
+    }
+    return settings == 5 && generation >= 0 && !population.empty();
+}
+
+// The first setting that differs between the checkpoint and this run, or
+// nullptr. Every generation plays the same seeded games for all of its
+// candidates; resuming with other games would compare them on different
+// terms from one generation to the next.
+const char* changedSetting(const TuneConfig& saved, const TuneConfig& config) {
+    if (saved.policyName != config.policyName)     return "--policy";
+    if (saved.seed != config.seed)                 return "--seed";
+    if (saved.games != config.games)               return "--games";
+    if (saved.maxPieces != config.maxPieces)       return "--max-pieces";
+    if (saved.scoreFitness != config.scoreFitness) return "--fitness";
+    return nullptr;
+}
+
+void printUsage(const char* program) {
+    std::printf(
+        "Usage: %s [options]\n"
+        "  --policy NAME       bot to tune: greedy, beam, beam-mt, beam-deep\n"
+        "                      (default greedy; beam-mt runs as beam)\n"
+        "  --population P      candidates per generation (default 32)\n"
+        "  --generations G     generations to run in total (default 50)\n"
+        "  --games N           games per candidate per generation (default 32)\n"
+        "  --max-pieces M      stop each game after M pieces (default 500)\n"
+        "  --elite E           best candidates kept unchanged (default 4)\n"
+        "  --mutation S        mutation std dev (default 0.2)\n"
+        "  --fitness F         score or lines (default score)\n"
+        "  --seed S            seed of the run (default 1)\n"
+        "  --threads T         worker threads, 0 = all cores (default 0)\n"
+        "  --checkpoint FILE   checkpoint path (default tune.ckpt)\n"
+        "  --resume            continue from the checkpoint (same options)\n"
+        "  --output FILE       best weights (default weights.txt)\n",
+        program);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    TuneConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg  = argv[i];
+        const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (std::strcmp(arg, "--resume") == 0) {
+            config.resume = true;
+            continue;
+        }
+        if (!next) {
+            std::fprintf(stderr, "Missing value for %s\n", arg);
+            return 1;
+        }
+
+        if (std::strcmp(arg, "--policy") == 0) {
+            config.policyName = next;
+        } else if (std::strcmp(arg, "--population") == 0) {
+            config.population = std::atoi(next);
+        } else if (std::strcmp(arg, "--generations") == 0) {
+            config.generations = std::atoi(next);
+        } else if (std::strcmp(arg, "--games") == 0) {
+            config.games = std::atoi(next);
+        } else if (std::strcmp(arg, "--max-pieces") == 0) {
+            config.maxPieces = std::atol(next);
+        } else if (std::strcmp(arg, "--elite") == 0) {
+            config.elite = std::atoi(next);
+        } else if (std::strcmp(arg, "--mutation") == 0) {
+            config.mutation = std::atof(next);
+        } else if (std::strcmp(arg, "--fitness") == 0) {
+            if (std::strcmp(next, "score") != 0 && std::strcmp(next, "lines") != 0) {
+                std::fprintf(stderr, "Unknown fitness '%s'\n", next);
+                return 1;
+            }
+            config.scoreFitness = std::strcmp(next, "score") == 0;
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            config.seed = static_cast<uint32_t>(std::strtoul(next, nullptr, 10));
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            config.threads = std::atoi(next);
+        } else if (std::strcmp(arg, "--checkpoint") == 0) {
+            config.checkpointPath = next;
+        } else if (std::strcmp(arg, "--output") == 0) {
+            config.outputPath = next;
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+        ++i;
+    }
+
+    if (config.policyName == "random" || !isPolicyName(config.policyName)) {
+        std::fprintf(stderr, "Cannot tune policy '%s'\n", config.policyName.c_str());
+        return 1;
+    }
+    if (config.population < 2 || config.games < 1) {
+        std::fprintf(stderr, "Need --population >= 2 and --games >= 1\n");
+        return 1;
+    }
+
+    std::vector<Candidate> population;
+    int generation = 0;
+
+    if (config.resume) {
+        TuneConfig saved;
+        if (!loadCheckpoint(config, saved, generation, population)) {
+            std::fprintf(stderr, "Cannot resume from %s\n",
+                         config.checkpointPath.c_str());
+            return 1;
+        }
+        if (const char* option = changedSetting(saved, config)) {
+            std::fprintf(stderr, "%s was written with a different %s; resume "
+                         "with the options of the original run\n",
+                         config.checkpointPath.c_str(), option);
+            return 1;
+        }
+        std::fprintf(stderr, "Resuming at generation %d\n", generation);
+    } else {
+        // The hand-picked defaults seed the search; the rest is random.
+        std::mt19937_64 rng = generationRng(config, -1);
+        Candidate start;
+        normalize(start.weights);
+        population.push_back(start);
+        while (static_cast<int>(population.size()) < config.population) {
+            Candidate c;
+            c.weights = randomWeights(rng);
+            population.push_back(c);
+        }
+    }
+
+    ThreadPool pool(config.threads);
+
+    for (; generation < config.generations; ++generation) {
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+
+        evaluate(config, generation, pool, population);
+        std::stable_sort(population.begin(), population.end(),
+                         [](const Candidate& a, const Candidate& b) {
+                             return a.fitness > b.fitness;
+                         });
+
+        double mean = 0.0;
+        for (const Candidate& c : population) mean += c.fitness;
+        mean /= population.size();
+
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        std::printf("gen %3d  best %10.1f  mean %10.1f  %.1f s\n",
+                    generation, population[0].fitness, mean, seconds);
+        std::fflush(stdout);
+
+        if (!saveWeights(config.outputPath, population[0].weights)) {
+            std::fprintf(stderr, "Cannot write %s\n", config.outputPath.c_str());
+            return 1;
+        }
+
+        std::mt19937_64 rng = generationRng(config, generation);
+        population = breed(config, population, rng);
+        if (!saveCheckpoint(config, generation + 1, population)) {
+            std::fprintf(stderr, "Cannot write %s\n",
+                         config.checkpointPath.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,287 @@
+// Bot-vs-bot versus matches at full speed: every board runs on its own
+// thread and line clears send garbage to the opponents (VersusMatch).
+// Prints each result and the wins per policy; --check plays every match
+// again on one thread and fails unless both runs end identically.
+//
+//   ./versus --policies greedy,beam --matches 20
+//   ./versus --check --matches 4 --randomizer bag
+//   ./versus --record match --matches 1    writes match-1-0.replay, ...
+
+#include "GameCore.h"
+#include "Policy.h"
+#include "Replay.h"
+#include "Versus.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::printf(
+        "Usage: %s [options]\n"
+        "  --policies A,B   one policy per board, 2 to %d boards (default greedy,greedy)\n"
+        "                   policies:",
+        program, MAX_VERSUS_BOARDS);
+    for (const std::string& name : policyNames()) {
+        std::printf(" %s", name.c_str());
+    }
+    std::printf(
+        "\n"
+        "  --matches N      matches to play (default 10)\n"
+        "  --seed S         seed of the first match, then S+1, ... (default 1)\n"
+        "  --randomizer R   piece types: uniform, bag or history (default uniform)\n"
+        "  --max-ticks T    end a match as a draw at tick T (default 100000)\n"
+        "  --weights FILE   heuristic weights for the bot policies\n"
+        "  --record PREFIX  write PREFIX-<match>-<board>.replay for every board\n"
+        "  --check          replay every match on one thread and compare\n"
+        "  --quiet          only print the summary\n");
+}
+
+struct BoardResult {
+    long     ticks{0};
+    int      score{0};
+    int      lines{0};
+    long     sent{0};
+    uint64_t hash{0};
+
+    bool operator==(const BoardResult& other) const {
+        return ticks == other.ticks && score == other.score &&
+               lines == other.lines && sent == other.sent && hash == other.hash;
+    }
+};
+
+struct MatchResult {
+    int winner{-1};
+    std::vector<BoardResult> boards;
+
+    bool operator==(const MatchResult& other) const {
+        return winner == other.winner && boards == other.boards;
+    }
+};
+
+// Every board starts from the same seed, so all players get the same
+// pieces; the bots get their own policy seeds.
+MatchResult playMatch(const std::vector<std::string>& policies, uint32_t seed,
+                      RandomizerMode mode, long maxTicks,
+                      const HeuristicWeights& weights, bool threaded,
+                      std::vector<Replay>* recordings) {
+    int count = static_cast<int>(policies.size());
+    VersusMatch match(count, seed, maxTicks);
+
+    std::vector<GameCore> cores(count, GameCore(seed, mode));
+    std::vector<std::unique_ptr<Policy>> bots;
+    for (int i = 0; i < count; ++i) {
+        bots.push_back(createPolicy(policies[i], seed + static_cast<uint32_t>(i), weights));
+        if (recordings) (*recordings)[i].begin(seed, mode);
+    }
+
+    auto recording = [&](int board) -> Replay* {
+        return recordings ? &(*recordings)[board] : nullptr;
+    };
+
+    if (threaded) {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < count; ++i) {
+            threads.emplace_back([&, i]() {
+                while (playBotFrame(match, i, cores[i], *bots[i], recording(i))) {}
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+    } else {
+        // One frame of every board in turn; no board ever has to wait.
+        std::vector<bool> running(count, true);
+        for (int left = count; left > 0;) {
+            for (int i = 0; i < count; ++i) {
+                if (running[i] && !playBotFrame(match, i, cores[i], *bots[i], recording(i))) {
+                    running[i] = false;
+                    --left;
+                }
+            }
+        }
+    }
+
+    MatchResult result;
+    result.winner = match.winner();
+    for (int i = 0; i < count; ++i) {
+        BoardResult board;
+        board.ticks = cores[i].getTickCount();
+        board.score = cores[i].getScore();
+        board.lines = cores[i].getLinesCleared();
+        board.sent  = match.garbageSent(i);
+        board.hash  = cores[i].hash();
+        result.boards.push_back(board);
+        if (recordings) (*recordings)[i].finish(cores[i]);
+    }
+    return result;
+}
+
+bool splitPolicies(const char* list, std::vector<std::string>& policies) {
+    policies.clear();
+    std::string current;
+    for (const char* c = list;; ++c) {
+        if (*c == ',' || *c == '\0') {
+            if (!isPolicyName(current)) {
+                std::fprintf(stderr, "Unknown policy '%s'\n", current.c_str());
+                return false;
+            }
+            policies.push_back(current);
+            current.clear();
+            if (*c == '\0') break;
+        } else {
+            current += *c;
+        }
+    }
+    if (policies.size() < 2 || policies.size() > static_cast<size_t>(MAX_VERSUS_BOARDS)) {
+        std::fprintf(stderr, "A match needs 2 to %d policies\n", MAX_VERSUS_BOARDS);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> policies{"greedy", "greedy"};
+    long        matches    = 10;
+    uint32_t    firstSeed  = 1;
+    RandomizerMode mode    = RandomizerMode::Uniform;
+    long        maxTicks   = 100000;
+    HeuristicWeights weights;
+    const char* recordPrefix = nullptr;
+    bool        check      = false;
+    bool        quiet      = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg  = argv[i];
+        const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (std::strcmp(arg, "--check") == 0) {
+            check = true;
+            continue;
+        }
+        if (std::strcmp(arg, "--quiet") == 0) {
+            quiet = true;
+            continue;
+        }
+        if (!next) {
+            std::fprintf(stderr, "Missing value for %s\n", arg);
+            return 1;
+        }
+
+        if (std::strcmp(arg, "--policies") == 0) {
+            if (!splitPolicies(next, policies)) return 1;
+        } else if (std::strcmp(arg, "--matches") == 0) {
+            matches = std::atol(next);
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            firstSeed = static_cast<uint32_t>(std::strtoul(next, nullptr, 10));
+        } else if (std::strcmp(arg, "--randomizer") == 0) {
+            if (!parseRandomizerMode(next, mode)) {
+                std::fprintf(stderr, "Unknown randomizer '%s'\n", next);
+                return 1;
+            }
+        } else if (std::strcmp(arg, "--max-ticks") == 0) {
+            maxTicks = std::atol(next);
+        } else if (std::strcmp(arg, "--weights") == 0) {
+            if (!loadWeights(next, weights)) {
+                std::fprintf(stderr, "Cannot load weights '%s'\n", next);
+                return 1;
+            }
+        } else if (std::strcmp(arg, "--record") == 0) {
+            recordPrefix = next;
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+        ++i;
+    }
+
+    BlockTemplate::initializeTemplates();
+
+    int count = static_cast<int>(policies.size());
+    std::vector<long> wins(count, 0);
+    long draws      = 0;
+    long mismatches = 0;
+    long totalTicks = 0;
+    double seconds  = 0.0;
+
+    for (long m = 0; m < matches; ++m) {
+        uint32_t seed = firstSeed + static_cast<uint32_t>(m);
+
+        std::vector<Replay> recordings(count);
+        auto start = std::chrono::steady_clock::now();
+        MatchResult result = playMatch(policies, seed, mode, maxTicks, weights, true,
+                                       recordPrefix ? &recordings : nullptr);
+        seconds += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        if (result.winner >= 0) {
+            ++wins[result.winner];
+        } else {
+            ++draws;
+        }
+        for (const BoardResult& board : result.boards) totalTicks += board.ticks;
+
+        if (!quiet) {
+            std::printf("match %ld (seed %u): ", m + 1, seed);
+            if (result.winner >= 0) {
+                std::printf("board %d (%s) wins\n", result.winner,
+                            policies[result.winner].c_str());
+            } else {
+                std::printf("draw\n");
+            }
+            for (int i = 0; i < count; ++i) {
+                const BoardResult& board = result.boards[i];
+                std::printf("  %d %-10s %7ld ticks %7d points %5d lines %5ld garbage sent\n",
+                            i, policies[i].c_str(), board.ticks, board.score,
+                            board.lines, board.sent);
+            }
+        }
+
+        if (check) {
+            MatchResult again = playMatch(policies, seed, mode, maxTicks, weights,
+                                          false, nullptr);
+            if (!(again == result)) {
+                std::printf("match %ld (seed %u): MISMATCH between threaded and "
+                            "single-threaded play\n", m + 1, seed);
+                ++mismatches;
+            }
+        }
+
+        if (recordPrefix) {
+            for (int i = 0; i < count; ++i) {
+                std::string path = std::string(recordPrefix) + "-" +
+                                   std::to_string(m + 1) + "-" + std::to_string(i) +
+                                   ".replay";
+                if (!saveReplay(path, recordings[i])) {
+                    std::fprintf(stderr, "Cannot write %s\n", path.c_str());
+                    return 1;
+                }
+            }
+        }
+    }
+
+    std::printf("%ld matches:", matches);
+    for (int i = 0; i < count; ++i) {
+        std::printf(" %s %ld,", policies[i].c_str(), wins[i]);
+    }
+    std::printf(" draws %ld\n", draws);
+    if (check) {
+        std::printf("determinism: %ld of %ld matches identical on one thread\n",
+                    matches - mismatches, matches);
+    }
+    std::fprintf(stderr, "%ld board ticks in %.3f s (%.0f ticks/s)\n", totalTicks,
+                 seconds, seconds > 0 ? totalTicks / seconds : 0.0);
+    return mismatches == 0 ? 0 : 1;
+}